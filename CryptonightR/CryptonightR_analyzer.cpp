@@ -0,0 +1,1238 @@
+#include "CryptonightR_analyzer.h"
+#include "CryptonightR_encoder.h"
+#include "CryptonightR_template.h"
+#include "CryptonightR_prefetch.h"
+#include "CryptonightR_benchmark.h"
+#include "CryptonightR_jit_buffer.h"
+#include "CryptonightR_hash.h"
+#include "CryptonightR_numa.h"
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <thread>
+
+extern int compile_code(const V4_Instruction* code, std::vector<uint8_t>& machine_code);
+
+enum
+{
+	// Heights taken by a worker at once
+	ANALYZER_CHUNK_SIZE = 1024,
+
+	// Heights printed for every kind of problem
+	ANALYZER_MAX_REPORTED = 10,
+
+	// Programs are run on this many sets of random registers to compare with emitted code
+	ANALYZER_CHECK_ROUNDS = 4,
+
+	ANALYZER_DEFAULT_DURATION_MS = 200,
+	ANALYZER_DEFAULT_MIN_SAMPLES = 5,
+	ANALYZER_DEFAULT_WARMUP_MS = 20,
+
+	// Synthetic loop code and main loop code go to separate pages
+	ANALYZER_CODE_BUF_SIZE = 65536 * 2,
+};
+
+// Expected cycles are kept in histograms with this resolution
+static const double ANALYZER_CYCLE_STEP = 0.25;
+
+// MUL 3 cycles, 3-way ADD and everything else 1 cycle
+static const uint8_t asic_latency[V4_INSTRUCTION_COUNT] = { 3, 1, 1, 1, 1, 1 };
+
+// Longest chain into every register and number of multiplications in it (the chain with more of them on a tie)
+static void get_chains(const V4_Instruction* code, const uint8_t* latency, uint32_t* ready, uint32_t* muls)
+{
+	for (int i = 0; i < 8; ++i)
+	{
+		ready[i] = 0;
+		muls[i] = 0;
+	}
+
+	for (; code->opcode != RET; ++code)
+	{
+		const uint32_t a = code->dst_index;
+		const uint32_t b = code->src_index;
+
+		const uint32_t m = (ready[a] > ready[b]) ? muls[a] : ((ready[b] > ready[a]) ? muls[b] : std::max(muls[a], muls[b]));
+		ready[a] = std::max(ready[a], ready[b]) + latency[code->opcode];
+		muls[a] = m + ((code->opcode == MUL) ? 1 : 0);
+	}
+}
+
+// Maximum cycle mean of the R0-R3 dependency graph between iterations
+static double get_loop_latency(const V4_Instruction* code, const uint8_t* latency)
+{
+	// Longest path from R<i> at the start to R<j> at the end, -1 if R<j> doesn't depend on R<i>
+	int paths[4][4];
+	for (int i = 0; i < 4; ++i)
+	{
+		int ready[8] = { -1, -1, -1, -1, -1, -1, -1, -1 };
+		ready[i] = 0;
+
+		for (const V4_Instruction* p = code; p->opcode != RET; ++p)
+		{
+			const int t = std::max(ready[p->dst_index], ready[p->src_index]);
+			ready[p->dst_index] = (t >= 0) ? (t + latency[p->opcode]) : -1;
+		}
+
+		for (int j = 0; j < 4; ++j)
+		{
+			paths[i][j] = ready[j];
+		}
+	}
+
+	// Every simple cycle has at most 4 edges, so closed walks up to 4 edges long are enough
+	int walks[4][4];
+	memcpy(walks, paths, sizeof(walks));
+
+	double result = 0.0;
+	for (int k = 1; k <= 4; ++k)
+	{
+		for (int i = 0; i < 4; ++i)
+		{
+			if (walks[i][i] >= 0)
+			{
+				result = std::max(result, static_cast<double>(walks[i][i]) / k);
+			}
+		}
+
+		int next[4][4];
+		for (int i = 0; i < 4; ++i)
+		{
+			for (int j = 0; j < 4; ++j)
+			{
+				next[i][j] = -1;
+				for (int m = 0; m < 4; ++m)
+				{
+					if ((walks[i][m] >= 0) && (paths[m][j] >= 0))
+					{
+						next[i][j] = std::max(next[i][j], walks[i][m] + paths[m][j]);
+					}
+				}
+			}
+		}
+		memcpy(walks, next, sizeof(walks));
+	}
+
+	return result;
+}
+
+static uint32_t popcount(uint32_t x)
+{
+	uint32_t n = 0;
+	for (; x; x &= x - 1)
+	{
+		++n;
+	}
+	return n;
+}
+
+static void get_port_pressure(const uint32_t* op_count, const v4_uarch_info& info, v4_uarch_analysis& result)
+{
+	uint32_t total_uops = 0;
+	for (int op = 0; op < V4_INSTRUCTION_COUNT; ++op)
+	{
+		total_uops += op_count[op] * info.uops[op];
+	}
+	result.issue_bound = static_cast<double>(total_uops) / info.issue_width;
+
+	// Uops which can only go to ports in the set have to be executed there, the worst set is the bound
+	result.port_bound = 0.0;
+	for (uint32_t set = 1; set < (1U << V4_ANALYZER_MAX_PORTS); ++set)
+	{
+		uint32_t uops = 0;
+		for (int op = 0; op < V4_INSTRUCTION_COUNT; ++op)
+		{
+			if ((info.ports[op] & ~set) == 0)
+			{
+				uops += op_count[op] * info.uops[op];
+			}
+		}
+		result.port_bound = std::max(result.port_bound, static_cast<double>(uops) / popcount(set));
+	}
+
+	// Uops with fewer ports to choose from go first, every uop takes the least loaded port
+	int order[V4_INSTRUCTION_COUNT];
+	for (int op = 0; op < V4_INSTRUCTION_COUNT; ++op)
+	{
+		order[op] = op;
+	}
+	std::stable_sort(order, order + V4_INSTRUCTION_COUNT, [&info](int a, int b) { return popcount(info.ports[a]) < popcount(info.ports[b]); });
+
+	for (int i = 0; i < V4_ANALYZER_MAX_PORTS; ++i)
+	{
+		result.port_pressure[i] = 0.0;
+	}
+	for (int op : order)
+	{
+		for (uint32_t k = 0, n = op_count[op] * info.uops[op]; k < n; ++k)
+		{
+			int best = -1;
+			for (int i = 0; i < V4_ANALYZER_MAX_PORTS; ++i)
+			{
+				if ((info.ports[op] & (1U << i)) && ((best < 0) || (result.port_pressure[i] < result.port_pressure[best])))
+				{
+					best = i;
+				}
+			}
+			result.port_pressure[best] += 1.0;
+		}
+	}
+}
+
+// Longest of R0-R3, the one with more multiplications on a tie
+static void get_critical_path(const uint32_t* ready, const uint32_t* muls, uint32_t& latency, uint32_t& num_muls)
+{
+	latency = 0;
+	num_muls = 0;
+	for (int i = 0; i < 4; ++i)
+	{
+		if ((ready[i] > latency) || ((ready[i] == latency) && (muls[i] > num_muls)))
+		{
+			latency = ready[i];
+			num_muls = muls[i];
+		}
+	}
+}
+
+void v4_analyze(const V4_Instruction* code, v4_program_analysis& result)
+{
+	memset(&result, 0, sizeof(result));
+
+	for (const V4_Instruction* p = code; p->opcode != RET; ++p)
+	{
+		++result.num_insts;
+		++result.op_count[p->opcode];
+	}
+
+	uint32_t ready[8];
+	uint32_t muls[8];
+	uint32_t asic_muls;
+	get_chains(code, asic_latency, ready, muls);
+	get_critical_path(ready, muls, result.asic_latency, asic_muls);
+
+	for (int u = 0; u < V4_UARCH_COUNT; ++u)
+	{
+		const v4_uarch_info& info = *v4_get_uarch_info(static_cast<v4_uarch>(u));
+		v4_uarch_analysis& r = result.uarch[u];
+
+		get_chains(code, info.latency, ready, muls);
+		get_critical_path(ready, muls, r.critical_path, r.critical_path_muls);
+		for (int i = 0; i < 4; ++i)
+		{
+			r.register_latency[i] = ready[i];
+		}
+
+		r.loop_latency = get_loop_latency(code, info.latency);
+		get_port_pressure(result.op_count, info, r);
+		r.expected_cycles = std::max(r.loop_latency, std::max(r.port_bound, r.issue_bound));
+	}
+}
+
+// x86 instructions random math encoder emits
+enum x86_kind
+{
+	X86_IMUL,
+	X86_ADD,
+	X86_ADD_IMM,
+	X86_SUB,
+	X86_XOR,
+	X86_MOV,
+	X86_MOV_ECX_IMM,
+	X86_ROL,
+	X86_ROR,
+};
+
+struct x86_inst
+{
+	x86_kind kind;
+	uint8_t dst;
+	uint8_t src;
+	bool w;
+	uint32_t imm;
+};
+
+static bool decode_error(std::string* error, const char* what, size_t offset)
+{
+	if (error)
+	{
+		*error = std::string(what) + " at offset " + std::to_string(offset);
+	}
+	return false;
+}
+
+static bool decode_x86(const uint8_t* code, size_t size, std::vector<x86_inst>& insts, std::string* error)
+{
+	// V4 register of every x86 register, -1 if it doesn't hold one
+	int v4_index[16];
+	for (int i = 0; i < 16; ++i)
+	{
+		v4_index[i] = -1;
+	}
+	for (int i = 0; i < 8; ++i)
+	{
+		v4_index[v4_template_regs.r[i]] = i;
+	}
+
+	insts.clear();
+	for (size_t pos = 0; pos < size;)
+	{
+		const size_t start = pos;
+
+		uint8_t rex = 0;
+		if ((code[pos] & 0xF0) == 0x40)
+		{
+			rex = code[pos++];
+		}
+		if (pos >= size)
+		{
+			return decode_error(error, "truncated instruction", start);
+		}
+
+		x86_inst inst = {};
+		inst.w = (rex & 8) != 0;
+
+		const uint8_t opcode = code[pos++];
+		if (opcode == 0xB9)
+		{
+			if (rex || (pos + 4 > size))
+			{
+				return decode_error(error, "invalid mov ecx, imm32", start);
+			}
+			inst.kind = X86_MOV_ECX_IMM;
+			inst.dst = X86_RCX;
+			memcpy(&inst.imm, code + pos, sizeof(uint32_t));
+			pos += 4;
+			insts.push_back(inst);
+			continue;
+		}
+
+		if (opcode == 0x0F)
+		{
+			if ((pos >= size) || (code[pos] != 0xAF))
+			{
+				return decode_error(error, "unknown opcode", start);
+			}
+			++pos;
+		}
+
+		if (pos >= size)
+		{
+			return decode_error(error, "truncated instruction", start);
+		}
+
+		const uint8_t modrm = code[pos++];
+		if ((modrm >> 6) != 3)
+		{
+			return decode_error(error, "memory operand", start);
+		}
+		const uint8_t reg = ((modrm >> 3) & 7) | ((rex & 4) ? 8 : 0);
+		const uint8_t rm = (modrm & 7) | ((rex & 1) ? 8 : 0);
+
+		switch (opcode)
+		{
+		case 0x0F:
+			inst.kind = X86_IMUL;
+			inst.dst = reg;
+			inst.src = rm;
+			break;
+
+		// "op r64, r/m64" forms from the encoder
+		case 0x03:
+		case 0x2B:
+		case 0x33:
+		case 0x8B:
+			inst.kind = (opcode == 0x03) ? X86_ADD : ((opcode == 0x2B) ? X86_SUB : ((opcode == 0x33) ? X86_XOR : X86_MOV));
+			inst.dst = reg;
+			inst.src = rm;
+			break;
+
+		// "op r/m64, r64" forms, same instructions from other assemblers
+		case 0x01:
+		case 0x29:
+		case 0x31:
+		case 0x89:
+			inst.kind = (opcode == 0x01) ? X86_ADD : ((opcode == 0x29) ? X86_SUB : ((opcode == 0x31) ? X86_XOR : X86_MOV));
+			inst.dst = rm;
+			inst.src = reg;
+			break;
+
+		case 0x81:
+			if (((modrm >> 3) & 7) != 0)
+			{
+				return decode_error(error, "unexpected group 1 instruction", start);
+			}
+			if (pos + 4 > size)
+			{
+				return decode_error(error, "truncated instruction", start);
+			}
+			inst.kind = X86_ADD_IMM;
+			inst.dst = rm;
+			memcpy(&inst.imm, code + pos, sizeof(uint32_t));
+			pos += 4;
+			break;
+
+		case 0xD3:
+			if (((modrm >> 3) & 7) > 1)
+			{
+				return decode_error(error, "unexpected shift instruction", start);
+			}
+			if (inst.w != (RANDOM_MATH_64_BIT == 1))
+			{
+				return decode_error(error, "rotation of the wrong operand size", start);
+			}
+			inst.kind = ((modrm >> 3) & 7) ? X86_ROR : X86_ROL;
+			inst.dst = rm;
+			inst.src = X86_RCX;
+			break;
+
+		default:
+			return decode_error(error, "unknown opcode", start);
+		}
+
+		if (!inst.w && (inst.kind != X86_ROL) && (inst.kind != X86_ROR))
+		{
+			return decode_error(error, "32-bit operand size", start);
+		}
+
+		// Only R0-R3 are written, rcx is the only scratch register
+		if (inst.kind == X86_MOV)
+		{
+			if ((inst.dst != X86_RCX) || (v4_index[inst.src] < 0))
+			{
+				return decode_error(error, "unexpected mov", start);
+			}
+		}
+		else
+		{
+			if ((v4_index[inst.dst] < 0) || (v4_index[inst.dst] >= 4))
+			{
+				return decode_error(error, "write to a register which is not R0-R3", start);
+			}
+			if ((inst.kind != X86_ADD_IMM) && (inst.src != X86_RCX) && (v4_index[inst.src] < 0))
+			{
+				return decode_error(error, "read from a register which is not R0-R7", start);
+			}
+		}
+
+		insts.push_back(inst);
+	}
+
+	return true;
+}
+
+static bool analyze_x86(const std::vector<x86_inst>& insts, const v4_uarch_info& info, v4_code_analysis& result, std::string* error)
+{
+	memset(&result, 0, sizeof(result));
+	result.num_x86_insts = static_cast<uint32_t>(insts.size());
+
+	// 3-way ADD is two x86 additions
+	const uint32_t add_latency = info.latency[ADD] / 2;
+
+	uint32_t ready[16] = {};
+	uint32_t muls[16] = {};
+	bool rcx_valid = false;
+
+	for (size_t i = 0; i < insts.size(); ++i)
+	{
+		const x86_inst& inst = insts[i];
+		const uint8_t a = inst.dst;
+		const uint8_t b = inst.src;
+
+		uint32_t latency = 0;
+		switch (inst.kind)
+		{
+		case X86_MOV:
+			ready[a] = ready[b];
+			muls[a] = muls[b];
+			rcx_valid = true;
+			continue;
+
+		case X86_MOV_ECX_IMM:
+			ready[a] = 0;
+			muls[a] = 0;
+			rcx_valid = true;
+			continue;
+
+		case X86_ADD_IMM:
+			ready[a] += add_latency;
+			continue;
+
+		case X86_IMUL: latency = info.latency[MUL]; ++result.op_count[MUL]; break;
+		case X86_SUB:  latency = info.latency[SUB]; ++result.op_count[SUB]; break;
+		case X86_XOR:  latency = info.latency[XOR]; ++result.op_count[XOR]; break;
+		case X86_ROL:  latency = info.latency[ROL]; ++result.op_count[ROL]; break;
+		case X86_ROR:  latency = info.latency[ROR]; ++result.op_count[ROR]; break;
+
+		case X86_ADD:
+			latency = add_latency;
+			// Second addition of 64-bit ADD adds the constant from rcx
+			if ((RANDOM_MATH_64_BIT != 1) || (b != X86_RCX))
+			{
+				++result.op_count[ADD];
+			}
+			break;
+		}
+
+		if ((b == X86_RCX) && !rcx_valid)
+		{
+			if (error)
+			{
+				*error = "rcx is read before it's written, instruction " + std::to_string(i);
+			}
+			return false;
+		}
+
+		const uint32_t m = (ready[a] > ready[b]) ? muls[a] : ((ready[b] > ready[a]) ? muls[b] : std::max(muls[a], muls[b]));
+		ready[a] = std::max(ready[a], ready[b]) + latency;
+		muls[a] = m + ((inst.kind == X86_IMUL) ? 1 : 0);
+	}
+
+	uint32_t v4_ready[4];
+	uint32_t v4_muls[4];
+	for (int i = 0; i < 4; ++i)
+	{
+		v4_ready[i] = ready[v4_template_regs.r[i]];
+		v4_muls[i] = muls[v4_template_regs.r[i]];
+		result.register_latency[i] = v4_ready[i];
+	}
+	get_critical_path(v4_ready, v4_muls, result.critical_path, result.critical_path_muls);
+
+	return true;
+}
+
+bool v4_analyze_x86(const uint8_t* code, size_t size, v4_uarch uarch, v4_code_analysis& result, std::string* error)
+{
+	std::vector<x86_inst> insts;
+	return decode_x86(code, size, insts, error) && analyze_x86(insts, *v4_get_uarch_info(uarch), result, error);
+}
+
+void v4_find_random_math(const std::vector<uint8_t>& machine_code, size_t& offset, size_t& size)
+{
+	// Prefetch code from compile_code goes before and after random math
+	const v4_prefetch prefetch = v4_get_prefetch();
+	const size_t prefetch_line = v4_prefetch_code_size(prefetch, V4_PREFETCH_LINE);
+	const size_t prefetch_next = v4_prefetch_code_size(prefetch, V4_PREFETCH_NEXT);
+
+	offset = ((const uint8_t*)CryptonightR_template_part2) - ((const uint8_t*)CryptonightR_template_part1) + prefetch_line;
+	size = machine_code.size() - (((const uint8_t*)CryptonightR_template_end) - ((const uint8_t*)CryptonightR_template_part1)) - prefetch_line - prefetch_next;
+}
+
+static void run_x86(const std::vector<x86_inst>& insts, uint64_t* regs)
+{
+	for (const x86_inst& inst : insts)
+	{
+		uint64_t& a = regs[inst.dst];
+		const uint64_t b = regs[inst.src];
+
+		switch (inst.kind)
+		{
+		case X86_IMUL:        a *= b; break;
+		case X86_ADD:         a += b; break;
+		case X86_ADD_IMM:     a += static_cast<uint64_t>(static_cast<int64_t>(static_cast<int32_t>(inst.imm))); break;
+		case X86_SUB:         a -= b; break;
+		case X86_XOR:         a ^= b; break;
+		case X86_MOV:         a = b; break;
+		case X86_MOV_ECX_IMM: a = inst.imm; break;
+
+		case X86_ROL:
+		case X86_ROR:
+			{
+				// 32-bit rotation zero-extends the result
+				const uint32_t bits = inst.w ? 64 : 32;
+				const uint64_t mask = inst.w ? ~0ULL : 0xFFFFFFFFULL;
+				const uint32_t s = static_cast<uint32_t>(regs[X86_RCX] & (bits - 1));
+				const uint32_t l = (inst.kind == X86_ROL) ? s : ((bits - s) % bits);
+				const uint64_t x = a & mask;
+				a = ((x << l) | (l ? (x >> (bits - l)) : 0)) & mask;
+			}
+			break;
+		}
+	}
+}
+
+bool v4_check_compiled_code(const V4_Instruction* code, const v4_program_analysis& analysis, std::string* error)
+{
+	std::vector<uint8_t> machine_code;
+	compile_code(code, machine_code);
+
+	size_t offset, size;
+	v4_find_random_math(machine_code, offset, size);
+
+	std::vector<x86_inst> insts;
+	if (!decode_x86(machine_code.data() + offset, size, insts, error))
+	{
+		return false;
+	}
+
+	uint64_t seed = 0x9E3779B97F4A7C15ULL;
+	for (int round = 0; round < ANALYZER_CHECK_ROUNDS; ++round)
+	{
+		uint64_t regs[16] = {};
+		v4_reg r[8];
+		for (int i = 0; i < 8; ++i)
+		{
+			// splitmix64
+			seed += 0x9E3779B97F4A7C15ULL;
+			uint64_t z = seed;
+			z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+			z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+			z ^= z >> 31;
+
+			regs[v4_template_regs.r[i]] = z;
+			r[i] = static_cast<v4_reg>(z);
+		}
+
+		v4_random_math(code, r);
+		run_x86(insts, regs);
+
+		for (int i = 0; i < 8; ++i)
+		{
+			if (static_cast<v4_reg>(regs[v4_template_regs.r[i]]) != r[i])
+			{
+				if (error)
+				{
+					*error = "R" + std::to_string(i) + " in emitted code doesn't match the program";
+				}
+				return false;
+			}
+		}
+	}
+
+	for (int u = 0; u < V4_UARCH_COUNT; ++u)
+	{
+		const v4_uarch_info& info = *v4_get_uarch_info(static_cast<v4_uarch>(u));
+		const v4_uarch_analysis& expected = analysis.uarch[u];
+
+		v4_code_analysis result;
+		if (!analyze_x86(insts, info, result, error))
+		{
+			return false;
+		}
+
+		if (memcmp(result.op_count, analysis.op_count, sizeof(result.op_count)) != 0)
+		{
+			if (error)
+			{
+				*error = "instruction mix of emitted code doesn't match the program";
+			}
+			return false;
+		}
+
+		if ((result.critical_path != expected.critical_path) || (result.critical_path_muls != expected.critical_path_muls) ||
+			(memcmp(result.register_latency, expected.register_latency, sizeof(result.register_latency)) != 0))
+		{
+			if (error)
+			{
+				*error = std::string(info.name) + ": emitted code has critical path of " + std::to_string(result.critical_path) + " cycles with " +
+					std::to_string(result.critical_path_muls) + " IMULs, program has " + std::to_string(expected.critical_path) + " cycles with " +
+					std::to_string(expected.critical_path_muls);
+			}
+			return false;
+		}
+	}
+
+	return true;
+}
+
+// Values are counts of every value, the last one counts everything above
+static void histogram_add(std::vector<uint64_t>& h, uint32_t value)
+{
+	if (h.empty())
+	{
+		h.resize(1024);
+	}
+	++h[std::min<size_t>(value, h.size() - 1)];
+}
+
+static void histogram_merge(std::vector<uint64_t>& h, const std::vector<uint64_t>& other)
+{
+	if (h.size() < other.size())
+	{
+		h.resize(other.size());
+	}
+	for (size_t i = 0; i < other.size(); ++i)
+	{
+		h[i] += other[i];
+	}
+}
+
+static uint32_t histogram_quantile(const std::vector<uint64_t>& h, double q)
+{
+	uint64_t total = 0;
+	for (uint64_t n : h)
+	{
+		total += n;
+	}
+
+	const uint64_t target = std::min(static_cast<uint64_t>(q * (total - 1) + 0.5), total - 1);
+	uint64_t sum = 0;
+	for (size_t i = 0; i < h.size(); ++i)
+	{
+		sum += h[i];
+		if (sum > target)
+		{
+			return static_cast<uint32_t>(i);
+		}
+	}
+	return 0;
+}
+
+struct analyzer_height
+{
+	uint64_t height;
+	uint32_t value;
+};
+
+struct analyzer_stats
+{
+	uint64_t heights;
+	uint64_t op_count[V4_INSTRUCTION_COUNT];
+	std::vector<uint64_t> num_insts;
+	std::vector<uint64_t> asic_latency;
+
+	std::vector<uint64_t> critical_path[V4_UARCH_COUNT];
+	std::vector<uint64_t> critical_path_muls[V4_UARCH_COUNT];
+	std::vector<uint64_t> shortest_register[V4_UARCH_COUNT];
+	std::vector<uint64_t> expected_cycles[V4_UARCH_COUNT];
+	double port_pressure[V4_UARCH_COUNT][V4_ANALYZER_MAX_PORTS];
+	uint64_t latency_bound[V4_UARCH_COUNT];
+
+	// Lowest heights with ASIC latency below V4_ANALYZER_MIN_MULS multiplications
+	uint64_t below_target;
+	std::vector<analyzer_height> below_target_heights;
+
+	// Heights with the longest critical path on the target microarchitecture
+	std::vector<analyzer_height> slowest;
+
+	uint64_t mismatches;
+	std::vector<std::pair<uint64_t, std::string>> mismatch_errors;
+};
+
+static void keep_slowest(std::vector<analyzer_height>& slowest, const analyzer_height& h)
+{
+	auto slower = [](const analyzer_height& a, const analyzer_height& b) { return (a.value > b.value) || ((a.value == b.value) && (a.height < b.height)); };
+
+	if ((slowest.size() >= ANALYZER_MAX_REPORTED) && !slower(h, slowest.back()))
+	{
+		return;
+	}
+	slowest.insert(std::upper_bound(slowest.begin(), slowest.end(), h, slower), h);
+	if (slowest.size() > ANALYZER_MAX_REPORTED)
+	{
+		slowest.pop_back();
+	}
+}
+
+static void analyze_height(uint64_t height, v4_uarch target, analyzer_stats& stats)
+{
+	V4_Instruction code[NUM_INSTRUCTIONS * 2];
+	v4_random_math_init(code, height);
+
+	v4_program_analysis analysis;
+	v4_analyze(code, analysis);
+
+	++stats.heights;
+	for (int op = 0; op < V4_INSTRUCTION_COUNT; ++op)
+	{
+		stats.op_count[op] += analysis.op_count[op];
+	}
+	histogram_add(stats.num_insts, analysis.num_insts);
+	histogram_add(stats.asic_latency, analysis.asic_latency);
+
+	for (int u = 0; u < V4_UARCH_COUNT; ++u)
+	{
+		const v4_uarch_analysis& r = analysis.uarch[u];
+
+		histogram_add(stats.critical_path[u], r.critical_path);
+		histogram_add(stats.critical_path_muls[u], r.critical_path_muls);
+		histogram_add(stats.shortest_register[u], *std::min_element(r.register_latency, r.register_latency + 4));
+		histogram_add(stats.expected_cycles[u], static_cast<uint32_t>(ceil(r.expected_cycles / ANALYZER_CYCLE_STEP)));
+		for (int i = 0; i < V4_ANALYZER_MAX_PORTS; ++i)
+		{
+			stats.port_pressure[u][i] += r.port_pressure[i];
+		}
+		if (r.loop_latency >= std::max(r.port_bound, r.issue_bound))
+		{
+			++stats.latency_bound[u];
+		}
+	}
+
+	if (analysis.asic_latency < V4_ANALYZER_MIN_MULS * asic_latency[MUL])
+	{
+		if (stats.below_target_heights.size() < ANALYZER_MAX_REPORTED)
+		{
+			stats.below_target_heights.push_back({ height, analysis.asic_latency });
+		}
+		++stats.below_target;
+	}
+
+	keep_slowest(stats.slowest, { height, analysis.uarch[target].critical_path });
+
+	std::string error;
+	if (!v4_check_compiled_code(code, analysis, &error))
+	{
+		if (stats.mismatch_errors.size() < ANALYZER_MAX_REPORTED)
+		{
+			stats.mismatch_errors.emplace_back(height, error);
+		}
+		++stats.mismatches;
+	}
+}
+
+static void merge_stats(analyzer_stats& stats, const analyzer_stats& other)
+{
+	stats.heights += other.heights;
+	for (int op = 0; op < V4_INSTRUCTION_COUNT; ++op)
+	{
+		stats.op_count[op] += other.op_count[op];
+	}
+	histogram_merge(stats.num_insts, other.num_insts);
+	histogram_merge(stats.asic_latency, other.asic_latency);
+
+	for (int u = 0; u < V4_UARCH_COUNT; ++u)
+	{
+		histogram_merge(stats.critical_path[u], other.critical_path[u]);
+		histogram_merge(stats.critical_path_muls[u], other.critical_path_muls[u]);
+		histogram_merge(stats.shortest_register[u], other.shortest_register[u]);
+		histogram_merge(stats.expected_cycles[u], other.expected_cycles[u]);
+		for (int i = 0; i < V4_ANALYZER_MAX_PORTS; ++i)
+		{
+			stats.port_pressure[u][i] += other.port_pressure[u][i];
+		}
+		stats.latency_bound[u] += other.latency_bound[u];
+	}
+
+	// Every worker goes through its heights in increasing order, so the lowest heights are in their first ones
+	stats.below_target += other.below_target;
+	stats.below_target_heights.insert(stats.below_target_heights.end(), other.below_target_heights.begin(), other.below_target_heights.end());
+	std::sort(stats.below_target_heights.begin(), stats.below_target_heights.end(), [](const analyzer_height& a, const analyzer_height& b) { return a.height < b.height; });
+	if (stats.below_target_heights.size() > ANALYZER_MAX_REPORTED)
+	{
+		stats.below_target_heights.resize(ANALYZER_MAX_REPORTED);
+	}
+
+	for (const analyzer_height& h : other.slowest)
+	{
+		keep_slowest(stats.slowest, h);
+	}
+
+	stats.mismatches += other.mismatches;
+	stats.mismatch_errors.insert(stats.mismatch_errors.end(), other.mismatch_errors.begin(), other.mismatch_errors.end());
+	std::sort(stats.mismatch_errors.begin(), stats.mismatch_errors.end());
+	if (stats.mismatch_errors.size() > ANALYZER_MAX_REPORTED)
+	{
+		stats.mismatch_errors.resize(ANALYZER_MAX_REPORTED);
+	}
+}
+
+static void print_distribution(const char* name, const std::vector<uint64_t>& h, double scale = 1.0)
+{
+	std::cout << name << ": min " << histogram_quantile(h, 0.0) * scale << ", p1 " << histogram_quantile(h, 0.01) * scale <<
+		", median " << histogram_quantile(h, 0.5) * scale << ", p99 " << histogram_quantile(h, 0.99) * scale <<
+		", max " << histogram_quantile(h, 1.0) * scale << std::endl;
+}
+
+static void print_stats(const analyzer_stats& stats, v4_uarch target)
+{
+	uint64_t total_insts = 0;
+	for (int op = 0; op < V4_INSTRUCTION_COUNT; ++op)
+	{
+		total_insts += stats.op_count[op];
+	}
+
+	static const char* op_names[V4_INSTRUCTION_COUNT] = { "MUL", "ADD", "SUB", "ROR", "ROL", "XOR" };
+	std::cout << "Instruction mix:";
+	for (int op = 0; op < V4_INSTRUCTION_COUNT; ++op)
+	{
+		std::cout << " " << op_names[op] << " " << stats.op_count[op] * 100.0 / total_insts << "%";
+	}
+	std::cout << std::endl;
+	std::cout << "Average program length: " << static_cast<double>(total_insts) / stats.heights << std::endl;
+	print_distribution("Program length", stats.num_insts);
+
+	print_distribution("ASIC latency (multiplications)", stats.asic_latency, 1.0 / asic_latency[MUL]);
+	std::cout << "Heights with ASIC latency below " << V4_ANALYZER_MIN_MULS << " multiplications: " << stats.below_target;
+	for (const analyzer_height& h : stats.below_target_heights)
+	{
+		std::cout << " " << h.height << " (" << static_cast<double>(h.value) / asic_latency[MUL] << ")";
+	}
+	std::cout << std::endl;
+
+	for (int u = 0; u < V4_UARCH_COUNT; ++u)
+	{
+		const v4_uarch_info& info = *v4_get_uarch_info(static_cast<v4_uarch>(u));
+
+		std::cout << info.name << ((u == target) ? " (this CPU)" : "") << ":" << std::endl;
+		print_distribution("  Critical path (cycles)", stats.critical_path[u]);
+		print_distribution("  Critical path (multiplications)", stats.critical_path[u], 1.0 / info.latency[MUL]);
+		print_distribution("  IMULs on critical path", stats.critical_path_muls[u]);
+		print_distribution("  Shortest chain into R0-R3 (cycles)", stats.shortest_register[u]);
+		print_distribution("  Synthetic loop (cycles per iteration)", stats.expected_cycles[u], ANALYZER_CYCLE_STEP);
+
+		std::cout << "  Latency bound in " << stats.latency_bound[u] * 100.0 / stats.heights << "% of heights, average uops per port:";
+		for (int i = 0; i < V4_ANALYZER_MAX_PORTS; ++i)
+		{
+			if (stats.port_pressure[u][i] > 0.0)
+			{
+				std::cout << " " << i << ": " << stats.port_pressure[u][i] / stats.heights;
+			}
+		}
+		std::cout << std::endl;
+	}
+
+	std::cout << "Longest critical paths on " << v4_get_uarch_info(target)->name << ":";
+	for (const analyzer_height& h : stats.slowest)
+	{
+		std::cout << " " << h.height << " (" << h.value << ")";
+	}
+	std::cout << std::endl;
+
+	std::cout << "Heights where emitted code doesn't match the program: " << stats.mismatches << std::endl;
+	for (const auto& e : stats.mismatch_errors)
+	{
+		std::cout << "  height " << e.first << ": " << e.second << std::endl;
+	}
+}
+
+// Synthetic loop: BENCHMARK_ITERATIONS times random math from the emitted kernel, R0-R3 are carried between iterations
+// Register values don't change instruction latencies, so they are not initialized
+static void make_random_math_loop(const std::vector<uint8_t>& machine_code, std::vector<uint8_t>& loop)
+{
+	size_t offset, size;
+	v4_find_random_math(machine_code, offset, size);
+
+	// push rbx, push rbp, push rsi, push rdi, mov r8d, BENCHMARK_ITERATIONS
+	const uint8_t prologue[] = { 0x53, 0x55, 0x56, 0x57, 0x41, 0xB8 };
+	// dec r8, jnz loop
+	const uint8_t loop_end[] = { 0x49, 0xFF, 0xC8, 0x0F, 0x85 };
+	// pop rdi, pop rsi, pop rbp, pop rbx, ret
+	const uint8_t epilogue[] = { 0x5F, 0x5E, 0x5D, 0x5B, 0xC3 };
+
+	const uint32_t iterations = BENCHMARK_ITERATIONS;
+
+	loop.clear();
+	loop.insert(loop.end(), prologue, prologue + sizeof(prologue));
+	loop.insert(loop.end(), (const uint8_t*) &iterations, (const uint8_t*) &iterations + sizeof(iterations));
+
+	const size_t loop_start = loop.size();
+	loop.insert(loop.end(), machine_code.data() + offset, machine_code.data() + offset + size);
+	loop.insert(loop.end(), loop_end, loop_end + sizeof(loop_end));
+
+	const int32_t rel = static_cast<int32_t>(loop_start - (loop.size() + 4));
+	loop.insert(loop.end(), (const uint8_t*) &rel, (const uint8_t*) &rel + sizeof(rel));
+	loop.insert(loop.end(), epilogue, epilogue + sizeof(epilogue));
+}
+
+typedef void(ASM_ABI *random_math_loop_func)();
+
+struct calibration_point
+{
+	uint64_t height;
+	double expected_cycles;
+	double critical_path;
+
+	// Per synthetic loop iteration, cycles are -1 without hardware counters
+	double synthetic_cycles;
+	double synthetic_ns;
+
+	// Nanoseconds per main loop iteration
+	double main_loop_ns;
+};
+
+static double get_cycles(const benchmark_result* r)
+{
+	for (const benchmark_counter& c : r->counters)
+	{
+		if (c.name == "cycles")
+		{
+			return c.per_iteration;
+		}
+	}
+	return -1.0;
+}
+
+static double correlation(const std::vector<double>& x, const std::vector<double>& y)
+{
+	const size_t n = x.size();
+	double mx = 0.0, my = 0.0;
+	for (size_t i = 0; i < n; ++i)
+	{
+		mx += x[i] / n;
+		my += y[i] / n;
+	}
+
+	double sxy = 0.0, sxx = 0.0, syy = 0.0;
+	for (size_t i = 0; i < n; ++i)
+	{
+		sxy += (x[i] - mx) * (y[i] - my);
+		sxx += (x[i] - mx) * (x[i] - mx);
+		syy += (y[i] - my) * (y[i] - my);
+	}
+	return ((sxx > 0.0) && (syy > 0.0)) ? sxy / sqrt(sxx * syy) : 0.0;
+}
+
+static double median_relative_error(const std::vector<double>& predicted, const std::vector<double>& measured)
+{
+	std::vector<double> errors(predicted.size());
+	for (size_t i = 0; i < predicted.size(); ++i)
+	{
+		errors[i] = fabs(predicted[i] / measured[i] - 1.0);
+	}
+	std::nth_element(errors.begin(), errors.begin() + errors.size() / 2, errors.end());
+	return errors[errors.size() / 2];
+}
+
+static bool calibrate(uint64_t first_height, uint64_t count, uint32_t num_points, v4_uarch target, const benchmark_options& options, const analyzer_stats& stats)
+{
+	const int node = numa_get_current_node();
+	cryptonight_ctx* ctx = numa_alloc_ctx(node);
+	benchmark_registry* bench = benchmark_registry_create(options);
+	jit_buffer code_buf;
+	const bool code_buf_allocated = jit_buffer_alloc(&code_buf, ANALYZER_CODE_BUF_SIZE);
+
+	if (!ctx || !bench || !code_buf_allocated)
+	{
+		std::cerr << "Failed to allocate calibration buffers" << std::endl;
+		numa_free_ctx(ctx);
+		benchmark_registry_destroy(bench);
+		if (code_buf_allocated)
+		{
+			jit_buffer_free(&code_buf);
+		}
+		return false;
+	}
+
+	const uint8_t input[76] = {};
+	cn_r_prepare(ctx, input, sizeof(input));
+
+	bool cycles_measured = true;
+	std::vector<calibration_point> points;
+	for (uint32_t k = 0; k < num_points; ++k)
+	{
+		const uint64_t height = first_height + (count * k) / num_points;
+		std::cerr << "Calibration height " << height << " (" << k + 1 << "/" << num_points << ")\r" << std::flush;
+
+		V4_Instruction code[NUM_INSTRUCTIONS * 2];
+		v4_random_math_init(code, height);
+
+		v4_program_analysis analysis;
+		v4_analyze(code, analysis);
+
+		std::vector<uint8_t> machine_code, loop;
+		compile_code(code, machine_code);
+		make_random_math_loop(machine_code, loop);
+
+		random_math_loop_func loop_func = (random_math_loop_func) jit_buffer_write(&code_buf, 0, loop.data(), loop.size());
+		mainloop_func generated = (mainloop_func) jit_buffer_write(&code_buf, ANALYZER_CODE_BUF_SIZE / 2, machine_code.data(), machine_code.size());
+		if (!loop_func || !generated)
+		{
+			std::cerr << "Failed to make generated code executable" << std::endl;
+			break;
+		}
+
+		const std::string suffix = "(height " + std::to_string(height) + ")";
+		const benchmark_result* r1 = benchmark_run(bench, ("Random math loop " + suffix).c_str(), 1, [&]() { loop_func(); }, true);
+		const benchmark_result* r2 = benchmark_run(bench, ("CryptonightR " + suffix).c_str(), 1, [&]() { generated(ctx); }, true);
+		if (!r1 || !r2)
+		{
+			continue;
+		}
+
+		const double cycles = get_cycles(r1);
+		cycles_measured = cycles_measured && (cycles > 0.0);
+		points.push_back({ height, analysis.uarch[target].expected_cycles, static_cast<double>(analysis.uarch[target].critical_path), cycles, r1->median_ns, r2->median_ns });
+	}
+	std::cerr << std::string(48, ' ') << '\r' << std::flush;
+
+	const bool ok = points.size() >= 3;
+	if (!ok)
+	{
+		std::cerr << "Not enough calibration heights were measured" << std::endl;
+	}
+	else
+	{
+		std::vector<double> expected, synthetic, critical_path, main_loop_ns;
+		for (const calibration_point& p : points)
+		{
+			expected.push_back(p.expected_cycles);
+			synthetic.push_back(cycles_measured ? p.synthetic_cycles : p.synthetic_ns);
+			critical_path.push_back(p.critical_path);
+			main_loop_ns.push_back(p.main_loop_ns);
+		}
+
+		// Synthetic loop: measured = scale * predicted, scale is 1 if cycles are measured, 1 / frequency otherwise
+		double sxy = 0.0, sxx = 0.0;
+		for (size_t i = 0; i < points.size(); ++i)
+		{
+			sxy += expected[i] * synthetic[i];
+			sxx += expected[i] * expected[i];
+		}
+		const double scale = sxy / sxx;
+
+		std::vector<double> scaled(points.size());
+		for (size_t i = 0; i < points.size(); ++i)
+		{
+			scaled[i] = expected[i] * scale;
+		}
+
+		std::cout << "Synthetic random math loop, " << points.size() << " heights on " << v4_get_uarch_info(target)->name << ":" << std::endl;
+		std::cout << "  Correlation of predicted and measured " << (cycles_measured ? "cycles" : "time") << ": " << correlation(expected, synthetic) << std::endl;
+		if (cycles_measured)
+		{
+			std::cout << "  Measured/predicted cycles: " << scale << ", median error " << median_relative_error(expected, synthetic) * 100.0 << "%" << std::endl;
+		}
+		else
+		{
+			std::cout << "  No cycle counter, fitted clock " << 1.0 / scale << " GHz, median error " << median_relative_error(scaled, synthetic) * 100.0 << "%" << std::endl;
+		}
+
+		// Main loop: ns per iteration = a + b * critical path (random math outputs go into the next address)
+		const size_t n = points.size();
+		double mx = 0.0, my = 0.0;
+		for (size_t i = 0; i < n; ++i)
+		{
+			mx += critical_path[i] / n;
+			my += main_loop_ns[i] / n;
+		}
+		double sxy_c = 0.0, sxx_c = 0.0;
+		for (size_t i = 0; i < n; ++i)
+		{
+			sxy_c += (critical_path[i] - mx) * (main_loop_ns[i] - my);
+			sxx_c += (critical_path[i] - mx) * (critical_path[i] - mx);
+		}
+		// Negative slope is noise: main loop is limited by memory, not by random math
+		const double b = (sxx_c > 0.0) ? std::max(sxy_c / sxx_c, 0.0) : 0.0;
+		const double a = my - b * mx;
+		if (b == 0.0)
+		{
+			std::cout << "Main loop time doesn't grow with critical path on this CPU, predicted hashrate is the same for all heights" << std::endl;
+		}
+		auto predict_hashrate = [a, b](double cycles) { return 1e9 / ((a + b * cycles) * BENCHMARK_ITERATIONS); };
+
+		std::vector<double> predicted_hashrate(n), measured_hashrate(n);
+		for (size_t i = 0; i < n; ++i)
+		{
+			predicted_hashrate[i] = predict_hashrate(critical_path[i]);
+			measured_hashrate[i] = 1e9 / (main_loop_ns[i] * BENCHMARK_ITERATIONS);
+		}
+
+		std::cout << "Main loop: " << a << " ns + " << b << " ns per critical path cycle per iteration, correlation " <<
+			correlation(critical_path, main_loop_ns) << ", median hashrate error " << median_relative_error(predicted_hashrate, measured_hashrate) * 100.0 << "%" << std::endl;
+
+		// Longer critical path is lower hashrate, so quantiles swap
+		const std::vector<uint64_t>& h = stats.critical_path[target];
+		std::cout << "Predicted H/s for " << stats.heights << " heights: min " << predict_hashrate(histogram_quantile(h, 1.0)) << ", p1 " <<
+			predict_hashrate(histogram_quantile(h, 0.99)) << ", median " << predict_hashrate(histogram_quantile(h, 0.5)) << ", p99 " <<
+			predict_hashrate(histogram_quantile(h, 0.01)) << ", max " << predict_hashrate(histogram_quantile(h, 0.0)) << std::endl;
+		std::cout << "Slowest predicted heights:";
+		for (const analyzer_height& s : stats.slowest)
+		{
+			std::cout << " " << s.height << " (" << predict_hashrate(s.value) << " H/s)";
+		}
+		std::cout << std::endl;
+
+		benchmark_set_info(bench, "analyzer_uarch", v4_get_uarch_info(target)->name);
+		benchmark_set_info(bench, "main_loop_fit", std::to_string(a) + " + " + std::to_string(b) + " * critical_path ns");
+	}
+
+	const bool json_written = benchmark_write_json(bench);
+
+	jit_buffer_free(&code_buf);
+	benchmark_registry_destroy(bench);
+	numa_free_ctx(ctx);
+
+	return ok && json_written;
+}
+
+int analyzer_main(int argc, char** argv)
+{
+	if (argc < 4)
+	{
+		std::cerr << "Usage: " << argv[0] << " --analyze <first height> <count> [threads] [calibration heights] [--benchmark-* options]" << std::endl;
+		return 1;
+	}
+
+	const uint64_t first_height = strtoull(argv[2], nullptr, 10);
+	const uint64_t count = strtoull(argv[3], nullptr, 10);
+	uint32_t num_threads = std::max(std::thread::hardware_concurrency(), 1U);
+	uint32_t num_calibration = 0;
+	if ((argc > 4) && (argv[4][0] != '-'))
+	{
+		num_threads = strtoul(argv[4], nullptr, 10);
+		if ((argc > 5) && (argv[5][0] != '-'))
+		{
+			num_calibration = strtoul(argv[5], nullptr, 10);
+		}
+	}
+
+	if ((count == 0) || (num_threads == 0) || ((num_calibration > 0) && ((num_calibration < 3) || (num_calibration > count))))
+	{
+		std::cerr << "Height count and threads must be positive, calibration needs from 3 to count heights" << std::endl;
+		return 1;
+	}
+
+	benchmark_options options = benchmark_default_options();
+	options.duration_ms = ANALYZER_DEFAULT_DURATION_MS;
+	options.min_samples = ANALYZER_DEFAULT_MIN_SAMPLES;
+	options.warmup_ms = ANALYZER_DEFAULT_WARMUP_MS;
+	if (!benchmark_parse_args(argc, argv, options))
+	{
+		std::cerr << "Invalid benchmark options" << std::endl;
+		return 1;
+	}
+	options.quiet = true;
+	options.filter = nullptr;
+
+	const v4_uarch target = v4_detect_uarch();
+
+	std::vector<analyzer_stats> stats(num_threads);
+	std::vector<std::thread> threads;
+	std::atomic<uint64_t> next(0);
+
+	const auto t1 = std::chrono::steady_clock::now();
+	for (uint32_t i = 0; i < num_threads; ++i)
+	{
+		threads.emplace_back([&, i]()
+		{
+			for (;;)
+			{
+				const uint64_t start = next.fetch_add(ANALYZER_CHUNK_SIZE);
+				if (start >= count)
+				{
+					break;
+				}
+				const uint64_t end = std::min<uint64_t>(start + ANALYZER_CHUNK_SIZE, count);
+				for (uint64_t k = start; k < end; ++k)
+				{
+					analyze_height(first_height + k, target, stats[i]);
+				}
+			}
+		});
+	}
+	for (std::thread& t : threads)
+	{
+		t.join();
+	}
+	const double dt = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - t1).count() / 1e9;
+
+	for (uint32_t i = 1; i < num_threads; ++i)
+	{
+		merge_stats(stats[0], stats[i]);
+	}
+
+	std::cout << "Analyzed heights " << first_height << "-" << first_height + count - 1 << " in " << dt << " s on " << num_threads << " threads (" <<
+		count / dt << " heights/s)" << std::endl;
+	print_stats(stats[0], target);
+
+	bool ok = (stats[0].mismatches == 0);
+	if (num_calibration > 0)
+	{
+		ok = calibrate(first_height, count, num_calibration, target, options, stats[0]) && ok;
+	}
+
+	return ok ? 0 : 1;
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+#include "definitions.h"
+#include "CryptonightR_scheduler.h"
+#include <string>
+#include <vector>
+
+// Static analyzer for random math programs
+//
+// Computes dependency chain latency, IMUL count on the longest chain and execution port pressure of every
+// program with latencies and ports from CryptonightR_scheduler.h, so per-height performance can be predicted
+// without running hashes. The same numbers are computed again from x86 code emitted by compile_code: random math
+// bytes are decoded back into instructions, checked against the program by running both on random registers,
+// and their dependency graph must give the same latencies.
+//
+// Inputs are R0-R7 at the start of the program, outputs are R0-R3 at the end (R4-R7 are never written).
+// In the main loop outputs go into the next scratchpad address, so the longest input-output chain is on the
+// critical path of every iteration.
+//
+// Command line mode:
+// --analyze <first height> <count> [threads] [calibration heights] [benchmark options (CryptonightR_benchmark.h)]
+// Analyzes count heights on all CPUs (or threads), reports instruction mix, latency and port pressure
+// distributions, heights below 15 multiplications of ASIC latency and every mismatch with emitted code.
+// Calibration heights (evenly spread over the range) are benchmarked as a synthetic loop with only random math
+// in it to validate predicted cycles, and as full main loops to fit hashrate = f(predicted cycles), which is
+// then used to predict hashrate of all analyzed heights.
+
+enum
+{
+	V4_ANALYZER_MAX_PORTS = 8,
+
+	// Latency target of the generator: chain of 15 multiplications
+	V4_ANALYZER_MIN_MULS = 15,
+};
+
+struct v4_uarch_analysis
+{
+	// Longest chain from R0-R7 to any of R0-R3 in cycles and multiplications in it
+	uint32_t critical_path;
+	uint32_t critical_path_muls;
+
+	// Longest chain into every output register
+	uint32_t register_latency[4];
+
+	// Cycles per iteration when the program runs in a loop with R0-R3 carried over and R4-R7 constant
+	// (maximum cycle mean of R0-R3 dependencies between iterations)
+	double loop_latency;
+
+	// Uops per iteration on every port, assigned to the least loaded port they can go to
+	double port_pressure[V4_ANALYZER_MAX_PORTS];
+
+	// Lower bound of cycles per iteration from port usage and from issue width
+	double port_bound;
+	double issue_bound;
+
+	// Predicted cycles per iteration of the synthetic loop: max(loop_latency, port_bound, issue_bound)
+	double expected_cycles;
+};
+
+struct v4_program_analysis
+{
+	uint32_t num_insts;
+	uint32_t op_count[V4_INSTRUCTION_COUNT];
+
+	// Longest chain for an ASIC with 3-cycle multiplier and all other operations (including 3-way ADD) in 1 cycle
+	uint32_t asic_latency;
+
+	v4_uarch_analysis uarch[V4_UARCH_COUNT];
+};
+
+void v4_analyze(const V4_Instruction* code, v4_program_analysis& result);
+
+// Latencies of x86 code decoded from random math bytes, mov rcx is free (eliminated at rename)
+struct v4_code_analysis
+{
+	uint32_t num_x86_insts;
+	uint32_t op_count[V4_INSTRUCTION_COUNT];
+	uint32_t critical_path;
+	uint32_t critical_path_muls;
+	uint32_t register_latency[4];
+};
+
+// Returns false (with a description in error) if code has anything random math encoder doesn't emit
+bool v4_analyze_x86(const uint8_t* code, size_t size, v4_uarch uarch, v4_code_analysis& result, std::string* error);
+
+// Random math bytes in compile_code output, with current v4_get_prefetch setting
+void v4_find_random_math(const std::vector<uint8_t>& machine_code, size_t& offset, size_t& size);
+
+// Compiles the program and checks emitted random math against it: same results on random registers,
+// same instruction mix and the same latencies for every microarchitecture
+bool v4_check_compiled_code(const V4_Instruction* code, const v4_program_analysis& analysis, std::string* error);
+
+int analyzer_main(int argc, char** argv);
@@ -0,0 +1,88 @@
+#include "CryptonightR_arena.h"
+#include <vector>
+
+enum
+{
+	CTX_SLOT_SIZE = (sizeof(cryptonight_ctx) + ARENA_COLOR_ALIGNMENT - 1) & ~(ARENA_COLOR_ALIGNMENT - 1),
+	SCRATCHPAD_STRIDE = MEMORY + ARENA_COLOR_RANGE,
+};
+
+struct scratchpad_arena
+{
+	large_page_alloc mem;
+	uint32_t color_step;
+	std::vector<cryptonight_ctx*> ctx;
+};
+
+static inline uint32_t color_offset(uint32_t color_step, uint32_t index)
+{
+	return static_cast<uint32_t>((static_cast<uint64_t>(index) * color_step) % ARENA_COLOR_RANGE);
+}
+
+scratchpad_arena* arena_create(uint32_t count, int node, uint32_t color_step)
+{
+	if ((count == 0) || (color_step % ARENA_COLOR_ALIGNMENT))
+	{
+		return nullptr;
+	}
+
+	// Before coloring, scratchpads have the same low 16 address bits, so they map to cache sets like separately allocated ones
+	const size_t ctx_size = (static_cast<size_t>(count) * CTX_SLOT_SIZE + LARGE_PAGES_2MB - 1) & ~static_cast<size_t>(LARGE_PAGES_2MB - 1);
+	const size_t size = ctx_size + static_cast<size_t>(count) * SCRATCHPAD_STRIDE;
+
+	scratchpad_arena* arena = new scratchpad_arena();
+	arena->color_step = color_step;
+
+	// Allocations are zero-filled, so contexts are already zeroed
+	if (!large_pages_alloc(&arena->mem, size, node, true))
+	{
+		delete arena;
+		return nullptr;
+	}
+
+	arena->ctx.resize(count);
+	for (uint32_t i = 0; i < count; ++i)
+	{
+		cryptonight_ctx* ctx = reinterpret_cast<cryptonight_ctx*>(arena->mem.ptr + static_cast<size_t>(i) * CTX_SLOT_SIZE);
+		ctx->long_state = arena->mem.ptr + ctx_size + static_cast<size_t>(i) * SCRATCHPAD_STRIDE + color_offset(color_step, i);
+		arena->ctx[i] = ctx;
+	}
+
+	return arena;
+}
+
+void arena_destroy(scratchpad_arena* arena)
+{
+	if (!arena)
+	{
+		return;
+	}
+
+	large_pages_free(&arena->mem);
+	delete arena;
+}
+
+uint32_t arena_get_count(const scratchpad_arena* arena)
+{
+	return static_cast<uint32_t>(arena->ctx.size());
+}
+
+cryptonight_ctx* arena_get_ctx(scratchpad_arena* arena, uint32_t index)
+{
+	return arena->ctx[index];
+}
+
+cryptonight_ctx** arena_get_ctxs(scratchpad_arena* arena)
+{
+	return arena->ctx.data();
+}
+
+uint32_t arena_get_color_offset(const scratchpad_arena* arena, uint32_t index)
+{
+	return color_offset(arena->color_step, index);
+}
+
+large_page_kind arena_get_page_kind(const scratchpad_arena* arena)
+{
+	return arena->mem.kind;
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "definitions.h"
+#include "CryptonightR_large_pages.h"
+
+// Many contexts and scratchpads carved from one large allocation (one 1 GB page if the system has them)
+//
+// Separately allocated scratchpads all start at a 2 MB boundary, so the same scratchpad offset in different lanes
+// maps to the same L1/L2 sets and has the same low 12 address bits (4K aliasing between a store in one lane and
+// a load in another). Arena shifts every scratchpad by its own color offset:
+//
+// offset(i) = (i * color_step) % ARENA_COLOR_RANGE
+//
+// Layout: contexts (one cache line aligned slot each), then scratchpads, MEMORY + ARENA_COLOR_RANGE bytes apart.
+
+enum
+{
+	// Color offsets are below this, it covers all L2 sets of 256 KB - 1 MB 16-way L2 caches
+	ARENA_COLOR_RANGE = 65536,
+
+	// color_step must be a multiple of it, so 64-byte blocks of the main loop never cross cache lines
+	ARENA_COLOR_ALIGNMENT = 64,
+
+	// No coloring: all scratchpads have the same alignment, like separate allocations
+	ARENA_COLOR_NONE = 0,
+
+	// Different L1 sets
+	ARENA_COLOR_CACHE_LINE = 64,
+
+	// Different L1 sets and different 1 KB blocks of a 4 KB page
+	ARENA_COLOR_KB = 1024 + 64,
+
+	// Next 4 KB page, different L1 and L2 sets
+	ARENA_COLOR_PAGE = 4096 + 64,
+};
+
+struct scratchpad_arena;
+
+// Contexts get long_state set, everything else in them is zeroed
+// Returns nullptr if color_step isn't a multiple of ARENA_COLOR_ALIGNMENT or memory can't be allocated
+scratchpad_arena* arena_create(uint32_t count, int node, uint32_t color_step);
+void arena_destroy(scratchpad_arena* arena);
+
+uint32_t arena_get_count(const scratchpad_arena* arena);
+cryptonight_ctx* arena_get_ctx(scratchpad_arena* arena, uint32_t index);
+
+// Contexts array, to pass consecutive contexts to multi-way kernels
+cryptonight_ctx** arena_get_ctxs(scratchpad_arena* arena);
+
+uint32_t arena_get_color_offset(const scratchpad_arena* arena, uint32_t index);
+large_page_kind arena_get_page_kind(const scratchpad_arena* arena);
@@ -0,0 +1,329 @@
+#include "CryptonightR_avx512.h"
+
+#ifdef __GNUC__
+#define TARGET_AVX512 __attribute__((target("avx512f,avx512dq,vaes,aes")))
+#define TARGET_XSAVE __attribute__((target("xsave")))
+#else
+#define TARGET_AVX512
+#define TARGET_XSAVE
+#endif
+
+TARGET_XSAVE bool CryptonightR_avx512_supported()
+{
+	int data[4];
+	__cpuidex(data, 0, 0);
+	if (data[0] < 7)
+	{
+		return false;
+	}
+
+	// OS must save AVX-512 state (XMM, YMM, opmask, ZMM_Hi256, Hi16_ZMM)
+	__cpuidex(data, 1, 0);
+	if (!(data[2] & (1 << 27)))
+	{
+		return false;
+	}
+	if ((_xgetbv(0) & 0xE6) != 0xE6)
+	{
+		return false;
+	}
+
+	__cpuidex(data, 7, 0);
+	const bool avx512f = (data[1] & (1 << 16)) != 0;
+	const bool avx512dq = (data[1] & (1 << 17)) != 0;
+	const bool vaes = (data[2] & (1 << 9)) != 0;
+	return avx512f && avx512dq && vaes;
+}
+
+// 128-bit blocks of lanes 0-3 are in z0, lanes 4-7 are in z1 (this is what VAES works with)
+struct blocks
+{
+	__m512i z0;
+	__m512i z1;
+};
+
+TARGET_AVX512 static FORCEINLINE blocks load_blocks(const uint64_t* ptr, uint64_t offset)
+{
+	blocks b;
+	b.z0 = _mm512_castsi128_si512(_mm_load_si128((const __m128i*)(ptr[0] ^ offset)));
+	b.z1 = _mm512_castsi128_si512(_mm_load_si128((const __m128i*)(ptr[4] ^ offset)));
+	b.z0 = _mm512_inserti32x4(b.z0, _mm_load_si128((const __m128i*)(ptr[1] ^ offset)), 1);
+	b.z1 = _mm512_inserti32x4(b.z1, _mm_load_si128((const __m128i*)(ptr[5] ^ offset)), 1);
+	b.z0 = _mm512_inserti32x4(b.z0, _mm_load_si128((const __m128i*)(ptr[2] ^ offset)), 2);
+	b.z1 = _mm512_inserti32x4(b.z1, _mm_load_si128((const __m128i*)(ptr[6] ^ offset)), 2);
+	b.z0 = _mm512_inserti32x4(b.z0, _mm_load_si128((const __m128i*)(ptr[3] ^ offset)), 3);
+	b.z1 = _mm512_inserti32x4(b.z1, _mm_load_si128((const __m128i*)(ptr[7] ^ offset)), 3);
+	return b;
+}
+
+TARGET_AVX512 static FORCEINLINE void store_blocks(const uint64_t* ptr, uint64_t offset, const blocks& b)
+{
+	_mm_store_si128((__m128i*)(ptr[0] ^ offset), _mm512_castsi512_si128(b.z0));
+	_mm_store_si128((__m128i*)(ptr[1] ^ offset), _mm512_extracti32x4_epi32(b.z0, 1));
+	_mm_store_si128((__m128i*)(ptr[2] ^ offset), _mm512_extracti32x4_epi32(b.z0, 2));
+	_mm_store_si128((__m128i*)(ptr[3] ^ offset), _mm512_extracti32x4_epi32(b.z0, 3));
+	_mm_store_si128((__m128i*)(ptr[4] ^ offset), _mm512_castsi512_si128(b.z1));
+	_mm_store_si128((__m128i*)(ptr[5] ^ offset), _mm512_extracti32x4_epi32(b.z1, 1));
+	_mm_store_si128((__m128i*)(ptr[6] ^ offset), _mm512_extracti32x4_epi32(b.z1, 2));
+	_mm_store_si128((__m128i*)(ptr[7] ^ offset), _mm512_extracti32x4_epi32(b.z1, 3));
+}
+
+TARGET_AVX512 static FORCEINLINE blocks add_blocks(const blocks& a, const blocks& b)
+{
+	return { _mm512_add_epi64(a.z0, b.z0), _mm512_add_epi64(a.z1, b.z1) };
+}
+
+TARGET_AVX512 static FORCEINLINE blocks xor_blocks(const blocks& a, const blocks& b)
+{
+	return { _mm512_xor_si512(a.z0, b.z0), _mm512_xor_si512(a.z1, b.z1) };
+}
+
+// Lower 64 bits of all 8 blocks
+TARGET_AVX512 static FORCEINLINE __m512i blocks_lo(const blocks& b)
+{
+	return _mm512_permutex2var_epi64(b.z0, _mm512_setr_epi64(0, 2, 4, 6, 8, 10, 12, 14), b.z1);
+}
+
+// Makes blocks from lower and upper 64-bit halves
+TARGET_AVX512 static FORCEINLINE blocks make_blocks(__m512i lo, __m512i hi)
+{
+	return { _mm512_permutex2var_epi64(lo, _mm512_setr_epi64(0, 8, 1, 9, 2, 10, 3, 11), hi), _mm512_permutex2var_epi64(lo, _mm512_setr_epi64(4, 12, 5, 13, 6, 14, 7, 15), hi) };
+}
+
+// 64x64 -> 128 bit multiplication from 32x32 -> 64 bit products
+TARGET_AVX512 static FORCEINLINE void umul128(__m512i a, __m512i b, __m512i& lo, __m512i& hi)
+{
+	const __m512i mask32 = _mm512_set1_epi64(0xFFFFFFFFULL);
+
+	const __m512i a_hi = _mm512_srli_epi64(a, 32);
+	const __m512i b_hi = _mm512_srli_epi64(b, 32);
+
+	const __m512i p0 = _mm512_mul_epu32(a, b);
+	const __m512i p1 = _mm512_mul_epu32(a, b_hi);
+	const __m512i p2 = _mm512_mul_epu32(a_hi, b);
+	const __m512i p3 = _mm512_mul_epu32(a_hi, b_hi);
+
+	const __m512i mid = _mm512_add_epi64(_mm512_add_epi64(_mm512_srli_epi64(p0, 32), _mm512_and_si512(p1, mask32)), _mm512_and_si512(p2, mask32));
+
+	lo = _mm512_or_si512(_mm512_slli_epi64(mid, 32), _mm512_and_si512(p0, mask32));
+	hi = _mm512_add_epi64(_mm512_add_epi64(p3, _mm512_srli_epi64(p1, 32)), _mm512_add_epi64(_mm512_srli_epi64(p2, 32), _mm512_srli_epi64(mid, 32)));
+}
+
+// In 32-bit mode only lower halves of the lanes are meaningful, upper halves are never used
+template<int opcode>
+TARGET_AVX512 static FORCEINLINE __m512i v4_op(__m512i dst, __m512i src, __m512i c)
+{
+	switch (opcode)
+	{
+	case MUL:
+#if RANDOM_MATH_64_BIT == 1
+		return _mm512_mullo_epi64(dst, src);
+#else
+		return _mm512_mul_epu32(dst, src);
+#endif
+
+	case ADD:
+		return _mm512_add_epi64(dst, _mm512_add_epi64(src, c));
+
+	case SUB:
+		return _mm512_sub_epi64(dst, src);
+
+	case ROR:
+#if RANDOM_MATH_64_BIT == 1
+		return _mm512_rorv_epi64(dst, src);
+#else
+		return _mm512_rorv_epi32(dst, src);
+#endif
+
+	case ROL:
+#if RANDOM_MATH_64_BIT == 1
+		return _mm512_rolv_epi64(dst, src);
+#else
+		return _mm512_rolv_epi32(dst, src);
+#endif
+
+	default:
+		return _mm512_xor_si512(dst, src);
+	}
+}
+
+// Program is decoded once per call, ADD constants are broadcast to all lanes in advance
+struct v4_program_avx512
+{
+	int num_insts;
+	V4_Instruction inst[NUM_INSTRUCTIONS * 2];
+	__m512i c[NUM_INSTRUCTIONS * 2];
+};
+
+TARGET_AVX512 static void decode_program(const V4_Instruction* code, v4_program_avx512& program)
+{
+	int i = 0;
+	for (; code[i].opcode != RET; ++i)
+	{
+		program.inst[i] = code[i];
+		program.c[i] = _mm512_set1_epi64(code[i].C);
+	}
+	program.num_insts = i;
+}
+
+// Switch over 6 opcodes predicts much better than a case for every (opcode, dst, src) combination
+TARGET_AVX512 static FORCEINLINE void random_math_avx512(const v4_program_avx512& program, __m512i (&r)[8])
+{
+	for (int i = 0; i < program.num_insts; ++i)
+	{
+		const V4_Instruction op = program.inst[i];
+		__m512i& dst = r[op.dst_index];
+		const __m512i src = r[op.src_index];
+
+		switch (op.opcode)
+		{
+		case MUL:
+			dst = v4_op<MUL>(dst, src, program.c[i]);
+			break;
+
+		case ADD:
+			dst = v4_op<ADD>(dst, src, program.c[i]);
+			break;
+
+		case SUB:
+			dst = v4_op<SUB>(dst, src, program.c[i]);
+			break;
+
+		case ROR:
+			dst = v4_op<ROR>(dst, src, program.c[i]);
+			break;
+
+		case ROL:
+			dst = v4_op<ROL>(dst, src, program.c[i]);
+			break;
+
+		case XOR:
+			dst = v4_op<XOR>(dst, src, program.c[i]);
+			break;
+		}
+	}
+}
+
+TARGET_AVX512 void CryptonightR_avx512(cryptonight_ctx** ctx, const V4_Instruction* code)
+{
+	alignas(64) uint64_t h[12][AVX512_WAYS];
+	alignas(64) uint64_t base[AVX512_WAYS];
+	alignas(64) v4_reg data[4][AVX512_WAYS];
+
+	for (int i = 0; i < AVX512_WAYS; ++i)
+	{
+		const uint64_t* h0 = (const uint64_t*) ctx[i]->hash_state;
+		for (int j = 0; j < 12; ++j)
+		{
+			h[j][i] = h0[j];
+		}
+
+		const v4_reg* d = reinterpret_cast<const v4_reg*>(h0 + 12);
+		for (int j = 0; j < 4; ++j)
+		{
+			data[j][i] = d[j];
+		}
+
+		base[i] = reinterpret_cast<uint64_t>(ctx[i]->long_state);
+	}
+
+#define LOAD_H(k) _mm512_load_si512(h[k])
+
+	__m512i a0 = _mm512_xor_si512(LOAD_H(0), LOAD_H(4));
+	__m512i a1 = _mm512_xor_si512(LOAD_H(1), LOAD_H(5));
+	__m512i bx0_lo = _mm512_xor_si512(LOAD_H(2), LOAD_H(6));
+	__m512i bx1_lo = _mm512_xor_si512(LOAD_H(8), LOAD_H(10));
+	blocks ax = make_blocks(a0, a1);
+	blocks bx0 = make_blocks(bx0_lo, _mm512_xor_si512(LOAD_H(3), LOAD_H(7)));
+	blocks bx1 = make_blocks(bx1_lo, _mm512_xor_si512(LOAD_H(9), LOAD_H(11)));
+
+#undef LOAD_H
+
+#if RANDOM_MATH_64_BIT == 1
+#define LOAD_R(k) _mm512_load_si512(data[k])
+#else
+#define LOAD_R(k) _mm512_cvtepu32_epi64(_mm256_load_si256((const __m256i*) data[k]))
+#endif
+
+	__m512i r[8] = { LOAD_R(0), LOAD_R(1), LOAD_R(2), LOAD_R(3) };
+
+#undef LOAD_R
+
+	v4_program_avx512 program;
+	decode_program(code, program);
+
+	const __m512i mask = _mm512_set1_epi64(0x1FFFF0);
+	const __m512i long_state = _mm512_load_si512(base);
+
+	// Scratchpad addresses of all lanes, scratchpads are 64-byte aligned so (ptr ^ 0x10) == long_state + (idx ^ 0x10)
+	alignas(64) uint64_t ptr[AVX512_WAYS];
+	_mm512_store_si512(ptr, _mm512_add_epi64(long_state, _mm512_and_si512(a0, mask)));
+
+	for (size_t i = 0; i < 524288; i++)
+	{
+		blocks cx = load_blocks(ptr, 0);
+		cx.z0 = _mm512_aesenc_epi128(cx.z0, ax.z0);
+		cx.z1 = _mm512_aesenc_epi128(cx.z1, ax.z1);
+
+		// SHUFFLE1 from CryptonightV2
+		{
+			const blocks chunk1 = load_blocks(ptr, 0x10);
+			const blocks chunk2 = load_blocks(ptr, 0x20);
+			const blocks chunk3 = load_blocks(ptr, 0x30);
+			store_blocks(ptr, 0x10, add_blocks(chunk3, bx1));
+			store_blocks(ptr, 0x20, add_blocks(chunk1, bx0));
+			store_blocks(ptr, 0x30, add_blocks(chunk2, ax));
+		}
+
+		store_blocks(ptr, 0, xor_blocks(bx0, cx));
+
+		const __m512i cx_lo = blocks_lo(cx);
+		_mm512_store_si512(ptr, _mm512_add_epi64(long_state, _mm512_and_si512(cx_lo, mask)));
+
+		blocks c = load_blocks(ptr, 0);
+
+		// Random math (replaces integer math from CryptonightV2)
+#if RANDOM_MATH_64_BIT == 1
+		const __m512i r_out = _mm512_xor_si512(_mm512_add_epi64(r[0], r[1]), _mm512_add_epi64(r[2], r[3]));
+#else
+		const __m512i r_out = _mm512_or_si512(_mm512_and_si512(_mm512_add_epi64(r[0], r[1]), _mm512_set1_epi64(0xFFFFFFFFULL)), _mm512_slli_epi64(_mm512_add_epi64(r[2], r[3]), 32));
+#endif
+		c = xor_blocks(c, make_blocks(r_out, _mm512_setzero_si512()));
+		const __m512i cl = blocks_lo(c);
+
+		// Random math constants are taken from main loop registers
+		r[4] = a0;
+		r[5] = a1;
+		r[6] = bx0_lo;
+		r[7] = bx1_lo;
+		random_math_avx512(program, r);
+
+		__m512i lo, hi;
+		umul128(cx_lo, cl, lo, hi);
+
+		// SHUFFLE2 from CNv2
+		blocks hl = make_blocks(hi, lo);
+		{
+			const blocks chunk1 = xor_blocks(load_blocks(ptr, 0x10), hl);
+			const blocks chunk2 = load_blocks(ptr, 0x20);
+			hl = xor_blocks(hl, chunk2);
+			const blocks chunk3 = load_blocks(ptr, 0x30);
+			store_blocks(ptr, 0x10, add_blocks(chunk3, bx1));
+			store_blocks(ptr, 0x20, add_blocks(chunk1, bx0));
+			store_blocks(ptr, 0x30, add_blocks(chunk2, ax));
+		}
+
+		ax = add_blocks(ax, hl);
+		store_blocks(ptr, 0, ax);
+		ax = xor_blocks(ax, c);
+
+		a0 = blocks_lo(ax);
+		a1 = _mm512_permutex2var_epi64(ax.z0, _mm512_setr_epi64(1, 3, 5, 7, 9, 11, 13, 15), ax.z1);
+		_mm512_store_si512(ptr, _mm512_add_epi64(long_state, _mm512_and_si512(a0, mask)));
+
+		bx1 = bx0;
+		bx1_lo = bx0_lo;
+		bx0 = cx;
+		bx0_lo = cx_lo;
+	}
+}
@@ -0,0 +1,19 @@
+#pragma once
+
+#include "definitions.h"
+
+// CryptonightR main loop for 8 hashes in AVX-512 registers
+//
+// Every hash is a 64-bit lane: AES is done with VAES and rotations use vprorv/vprolv. Scratchpad is accessed
+// with per-lane 128-bit loads and stores, because gathers/scatters were slower for 16-byte blocks.
+// Random math program is decoded at run time, so any height works.
+// This is a throughput kernel for checking many hashes with the same program (bulk share verification).
+//
+// Requires AVX-512F, AVX-512DQ and VAES. Scratchpads must be 64-byte aligned.
+
+enum { AVX512_WAYS = 8 };
+
+bool CryptonightR_avx512_supported();
+
+// ctx is an array of AVX512_WAYS pointers
+void CryptonightR_avx512(cryptonight_ctx** ctx, const V4_Instruction* code);
@@ -0,0 +1,566 @@
+#include "CryptonightR_benchmark.h"
+#include "CryptonightR_perf.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <map>
+
+#ifdef _WIN32
+#define NOMINMAX
+#define WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+#else
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+enum
+{
+	// Progress on stderr is updated this often
+	PROGRESS_INTERVAL_MS = 250,
+};
+
+struct benchmark_registry
+{
+	benchmark_options options;
+	perf_counters* counters;
+	std::map<std::string, std::string> info;
+	std::vector<benchmark_result> results;
+};
+
+benchmark_options benchmark_default_options()
+{
+	benchmark_options options;
+	options.duration_ms = BENCHMARK_DURATION * 1000;
+	options.min_samples = 10;
+	options.warmup_ms = 500;
+	options.cpu = BENCHMARK_CPU_AUTO;
+	options.counters = BENCHMARK_COUNTERS_SELECTED;
+	options.filter = nullptr;
+	options.json_path = nullptr;
+	options.quiet = false;
+	return options;
+}
+
+static bool parse_uint(const char* s, uint32_t& value)
+{
+	char* end;
+	const unsigned long x = strtoul(s, &end, 10);
+	if ((end == s) || (*end != '\0') || (x > 0xFFFFFFFFUL))
+	{
+		return false;
+	}
+	value = static_cast<uint32_t>(x);
+	return true;
+}
+
+bool benchmark_parse_args(int argc, char** argv, benchmark_options& options)
+{
+	for (int i = 1; i < argc; ++i)
+	{
+		if (strncmp(argv[i], "--benchmark-", 12) != 0)
+		{
+			continue;
+		}
+		if (i + 1 >= argc)
+		{
+			return false;
+		}
+
+		const char* key = argv[i] + 12;
+		const char* value = argv[++i];
+		uint32_t x;
+
+		if (strcmp(key, "duration") == 0)
+		{
+			const double seconds = atof(value);
+			if (seconds <= 0.0)
+			{
+				return false;
+			}
+			options.duration_ms = static_cast<uint32_t>(seconds * 1000.0);
+		}
+		else if (strcmp(key, "warmup") == 0)
+		{
+			if (!parse_uint(value, options.warmup_ms))
+			{
+				return false;
+			}
+		}
+		else if (strcmp(key, "samples") == 0)
+		{
+			if (!parse_uint(value, x) || (x == 0))
+			{
+				return false;
+			}
+			options.min_samples = x;
+		}
+		else if (strcmp(key, "cpu") == 0)
+		{
+			if (strcmp(value, "none") == 0)
+			{
+				options.cpu = BENCHMARK_CPU_NONE;
+			}
+			else if (parse_uint(value, x) && (x < 0x7FFFFFFF))
+			{
+				options.cpu = static_cast<int>(x);
+			}
+			else
+			{
+				return false;
+			}
+		}
+		else if (strcmp(key, "counters") == 0)
+		{
+			if (strcmp(value, "none") == 0)
+			{
+				options.counters = BENCHMARK_COUNTERS_NONE;
+			}
+			else if (strcmp(value, "selected") == 0)
+			{
+				options.counters = BENCHMARK_COUNTERS_SELECTED;
+			}
+			else if (strcmp(value, "all") == 0)
+			{
+				options.counters = BENCHMARK_COUNTERS_ALL;
+			}
+			else
+			{
+				return false;
+			}
+		}
+		else if (strcmp(key, "filter") == 0)
+		{
+			options.filter = value;
+		}
+		else if (strcmp(key, "json") == 0)
+		{
+			options.json_path = value;
+		}
+		else
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+benchmark_registry* benchmark_registry_create(const benchmark_options& options)
+{
+	benchmark_registry* reg = new benchmark_registry();
+	reg->options = options;
+	reg->counters = (options.counters != BENCHMARK_COUNTERS_NONE) ? perf_counters_create() : nullptr;
+	return reg;
+}
+
+void benchmark_registry_destroy(benchmark_registry* reg)
+{
+	if (!reg)
+	{
+		return;
+	}
+
+	perf_counters_destroy(reg->counters);
+	delete reg;
+}
+
+bool benchmark_counters_available(const benchmark_registry* reg)
+{
+	return reg->counters != nullptr;
+}
+
+void benchmark_set_info(benchmark_registry* reg, const char* key, const std::string& value)
+{
+	reg->info[key] = value;
+}
+
+const std::vector<benchmark_result>& benchmark_get_results(const benchmark_registry* reg)
+{
+	return reg->results;
+}
+
+// Pins the calling thread for one measurement, previous affinity is restored after it
+#ifdef _WIN32
+typedef DWORD_PTR saved_affinity;
+
+static int pin_thread(int cpu, saved_affinity& saved)
+{
+	DWORD_PTR process_mask, system_mask;
+	if (!GetProcessAffinityMask(GetCurrentProcess(), &process_mask, &system_mask) || !process_mask)
+	{
+		return BENCHMARK_CPU_NONE;
+	}
+
+	if (cpu == BENCHMARK_CPU_AUTO)
+	{
+		cpu = 0;
+		for (int i = 0; i < static_cast<int>(sizeof(DWORD_PTR) * 8); ++i)
+		{
+			if (process_mask & (static_cast<DWORD_PTR>(1) << i))
+			{
+				cpu = i;
+			}
+		}
+	}
+	if ((cpu < 0) || (cpu >= static_cast<int>(sizeof(DWORD_PTR) * 8)))
+	{
+		return BENCHMARK_CPU_NONE;
+	}
+
+	saved = SetThreadAffinityMask(GetCurrentThread(), static_cast<DWORD_PTR>(1) << cpu);
+	return saved ? cpu : BENCHMARK_CPU_NONE;
+}
+
+static void restore_affinity(const saved_affinity& saved)
+{
+	SetThreadAffinityMask(GetCurrentThread(), saved);
+}
+#else
+typedef cpu_set_t saved_affinity;
+
+static int pin_thread(int cpu, saved_affinity& saved)
+{
+	if (pthread_getaffinity_np(pthread_self(), sizeof(saved), &saved) != 0)
+	{
+		return BENCHMARK_CPU_NONE;
+	}
+
+	if (cpu == BENCHMARK_CPU_AUTO)
+	{
+		cpu = -1;
+		for (int i = 0; i < CPU_SETSIZE; ++i)
+		{
+			if (CPU_ISSET(i, &saved))
+			{
+				cpu = i;
+			}
+		}
+	}
+	if ((cpu < 0) || (cpu >= CPU_SETSIZE))
+	{
+		return BENCHMARK_CPU_NONE;
+	}
+
+	cpu_set_t set;
+	CPU_ZERO(&set);
+	CPU_SET(cpu, &set);
+	return (pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0) ? cpu : BENCHMARK_CPU_NONE;
+}
+
+static void restore_affinity(const saved_affinity& saved)
+{
+	pthread_setaffinity_np(pthread_self(), sizeof(saved), &saved);
+}
+#endif
+
+static double call_ns(std::chrono::steady_clock::duration dt)
+{
+	return std::chrono::duration<double, std::nano>(dt).count();
+}
+
+const benchmark_result* benchmark_run(benchmark_registry* reg, const char* name, uint32_t hashes_per_call, const std::function<void()>& f, bool counters)
+{
+	const benchmark_options& options = reg->options;
+	if (options.filter && !strstr(name, options.filter))
+	{
+		return nullptr;
+	}
+
+	saved_affinity saved;
+	const int cpu = (options.cpu != BENCHMARK_CPU_NONE) ? pin_thread(options.cpu, saved) : BENCHMARK_CPU_NONE;
+
+	typedef std::chrono::steady_clock clock;
+
+	// At least one call even without warm-up, the first call often pays for page faults
+	const clock::time_point warmup_end = clock::now() + std::chrono::milliseconds(options.warmup_ms);
+	do
+	{
+		f();
+	} while (clock::now() < warmup_end);
+
+	perf_counters* perf = reg->counters;
+	if ((options.counters == BENCHMARK_COUNTERS_SELECTED) && !counters)
+	{
+		perf = nullptr;
+	}
+
+	// Counters include a few clock reads per sample, it's nothing compared to 524288 iterations
+	if (perf)
+	{
+		perf_counters_start(perf);
+	}
+
+	std::vector<double> samples;
+	const clock::time_point start = clock::now();
+	clock::time_point next_progress = start + std::chrono::milliseconds(PROGRESS_INTERVAL_MS);
+	const char progress[] = "|/-\\";
+	uint32_t progress_index = 0;
+
+	for (;;)
+	{
+		const clock::time_point t1 = clock::now();
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+
+		f();
+
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		const clock::time_point t2 = clock::now();
+
+		samples.push_back(call_ns(t2 - t1) / BENCHMARK_ITERATIONS);
+
+		if ((samples.size() >= options.min_samples) && (t2 - start >= std::chrono::milliseconds(options.duration_ms)))
+		{
+			break;
+		}
+
+		if (!options.quiet && (t2 >= next_progress))
+		{
+			std::cerr << name << ": " << samples.size() << " samples " << progress[progress_index++ % (sizeof(progress) - 1)] << '\r' << std::flush;
+			next_progress = t2 + std::chrono::milliseconds(PROGRESS_INTERVAL_MS);
+		}
+	}
+
+	double counter_values[PERF_MAX_COUNTERS];
+	if (perf)
+	{
+		perf_counters_stop(perf, counter_values);
+	}
+
+	if (cpu != BENCHMARK_CPU_NONE)
+	{
+		restore_affinity(saved);
+	}
+
+	std::sort(samples.begin(), samples.end());
+	const size_t n = samples.size();
+
+	benchmark_result result;
+	result.name = name;
+	result.hashes_per_call = hashes_per_call;
+	result.samples = static_cast<uint32_t>(n);
+	result.cpu = cpu;
+	result.min_ns = samples[0];
+	result.median_ns = (n % 2) ? samples[n / 2] : (samples[n / 2 - 1] + samples[n / 2]) * 0.5;
+	result.p99_ns = samples[std::min(static_cast<size_t>(ceil(n * 0.99)), n) - 1];
+
+	// Number of samples below the median is Binomial(n, 0.5), its normal approximation gives ranks of the bounds
+	const double half_width = 1.96 * sqrt(static_cast<double>(n)) * 0.5;
+	const double low_rank = floor(n * 0.5 - half_width);
+	const double high_rank = ceil(n * 0.5 + half_width);
+	result.ci_low_ns = samples[static_cast<size_t>(std::max(low_rank, 0.0))];
+	result.ci_high_ns = samples[std::min(static_cast<size_t>(std::max(high_rank, 0.0)), n - 1)];
+
+	auto hashrate = [hashes_per_call](double ns) { return hashes_per_call * 1e9 / (ns * BENCHMARK_ITERATIONS); };
+	result.hashrate = hashrate(result.median_ns);
+	result.hashrate_ci_low = hashrate(result.ci_high_ns);
+	result.hashrate_ci_high = hashrate(result.ci_low_ns);
+
+	double cycles = 0.0;
+	double instructions = 0.0;
+	if (perf)
+	{
+		const double iterations = static_cast<double>(n) * BENCHMARK_ITERATIONS;
+		for (uint32_t i = 0, count = perf_counters_get_count(perf); i < count; ++i)
+		{
+			if (counter_values[i] < 0.0)
+			{
+				continue;
+			}
+
+			const benchmark_counter c = { perf_counters_get_name(perf, i), counter_values[i] / iterations };
+			result.counters.emplace_back(c);
+
+			if (c.name == "cycles")
+			{
+				cycles = c.per_iteration;
+			}
+			else if (c.name == "instructions")
+			{
+				instructions = c.per_iteration;
+			}
+		}
+	}
+
+	if (!options.quiet)
+	{
+		std::cerr << std::string(strlen(name) + 24, ' ') << '\r' << std::flush;
+		std::cout << name << ": " << result.median_ns << " ns/iteration (p99 " << result.p99_ns << ", 95% CI " << result.ci_low_ns << " - " <<
+			result.ci_high_ns << "), " << result.hashrate << " H/s, " << n << " samples" << std::endl;
+
+		if (!result.counters.empty())
+		{
+			std::cout << "  per iteration:";
+			for (size_t i = 0; i < result.counters.size(); ++i)
+			{
+				std::cout << (i ? ", " : " ") << result.counters[i].name << " " << result.counters[i].per_iteration;
+			}
+			if ((cycles > 0.0) && (instructions > 0.0))
+			{
+				std::cout << ", IPC " << instructions / cycles;
+			}
+			std::cout << std::endl;
+		}
+	}
+
+	reg->results.emplace_back(result);
+	return &reg->results.back();
+}
+
+static std::string json_string(const std::string& s)
+{
+	std::string result = "\"";
+	for (char c : s)
+	{
+		switch (c)
+		{
+		case '"':
+			result += "\\\"";
+			break;
+		case '\\':
+			result += "\\\\";
+			break;
+		case '\n':
+			result += "\\n";
+			break;
+		default:
+			if (static_cast<uint8_t>(c) < 0x20)
+			{
+				char buf[8];
+				snprintf(buf, sizeof(buf), "\\u%04x", static_cast<uint8_t>(c));
+				result += buf;
+			}
+			else
+			{
+				result += c;
+			}
+			break;
+		}
+	}
+	result += '"';
+	return result;
+}
+
+static std::string get_cpu_brand()
+{
+	int data[4];
+	__cpuidex(data, 0x80000000, 0);
+	if (static_cast<uint32_t>(data[0]) < 0x80000004)
+	{
+		return std::string();
+	}
+
+	char brand[49] = {};
+	for (int i = 0; i < 3; ++i)
+	{
+		__cpuidex(data, 0x80000002 + i, 0);
+		memcpy(brand + i * 16, data, sizeof(data));
+	}
+
+	std::string s = brand;
+	s.erase(0, s.find_first_not_of(' '));
+	return s;
+}
+
+static bool has_invariant_tsc()
+{
+	int data[4];
+	__cpuidex(data, 0x80000000, 0);
+	if (static_cast<uint32_t>(data[0]) < 0x80000007)
+	{
+		return false;
+	}
+	__cpuidex(data, 0x80000007, 0);
+	return (data[3] & (1 << 8)) != 0;
+}
+
+static const char* get_compiler()
+{
+#if defined(__clang__)
+	return "clang " __clang_version__;
+#elif defined(__GNUC__)
+	return "gcc " __VERSION__;
+#elif defined(_MSC_FULL_VER)
+#define STRINGIFY2(x) #x
+#define STRINGIFY(x) STRINGIFY2(x)
+	return "msvc " STRINGIFY(_MSC_FULL_VER);
+#else
+	return "unknown";
+#endif
+}
+
+bool benchmark_write_json(const benchmark_registry* reg)
+{
+	const benchmark_options& options = reg->options;
+	if (!options.json_path)
+	{
+		return true;
+	}
+
+	FILE* f = fopen(options.json_path, "w");
+	if (!f)
+	{
+		std::cerr << "Can't write benchmark results to " << options.json_path << std::endl;
+		return false;
+	}
+
+	char timestamp[32] = {};
+	const time_t now = time(nullptr);
+	struct tm t;
+#ifdef _WIN32
+	gmtime_s(&t, &now);
+#else
+	gmtime_r(&now, &t);
+#endif
+	strftime(timestamp, sizeof(timestamp), "%Y-%m-%dT%H:%M:%SZ", &t);
+
+	fprintf(f, "{\n");
+	fprintf(f, "  \"timestamp\": \"%s\",\n", timestamp);
+	fprintf(f, "  \"build\": {\"compiler\": %s, \"date\": \"%s %s\", \"random_math_64_bit\": %d},\n", json_string(get_compiler()).c_str(), __DATE__, __TIME__, RANDOM_MATH_64_BIT);
+	fprintf(f, "  \"cpu\": {\"brand\": %s, \"invariant_tsc\": %s},\n", json_string(get_cpu_brand()).c_str(), has_invariant_tsc() ? "true" : "false");
+	static const char* counters_modes[] = { "none", "selected", "all" };
+	fprintf(f, "  \"options\": {\"duration_ms\": %u, \"min_samples\": %u, \"warmup_ms\": %u, \"cpu\": %d, \"counters\": \"%s\", \"filter\": %s},\n",
+		options.duration_ms, options.min_samples, options.warmup_ms, options.cpu, counters_modes[options.counters], options.filter ? json_string(options.filter).c_str() : "null");
+
+	fprintf(f, "  \"info\": {");
+	bool first = true;
+	for (const auto& i : reg->info)
+	{
+		fprintf(f, "%s\n    %s: %s", first ? "" : ",", json_string(i.first).c_str(), json_string(i.second).c_str());
+		first = false;
+	}
+	fprintf(f, "%s},\n", first ? "" : "\n  ");
+
+	fprintf(f, "  \"iterations_per_hash\": %d,\n", BENCHMARK_ITERATIONS);
+	fprintf(f, "  \"results\": [");
+	for (size_t i = 0; i < reg->results.size(); ++i)
+	{
+		const benchmark_result& r = reg->results[i];
+		fprintf(f, "%s\n    {\"name\": %s, \"hashes_per_call\": %u, \"samples\": %u, \"cpu\": %d, "
+			"\"ns_per_iteration\": {\"min\": %.4f, \"median\": %.4f, \"p99\": %.4f, \"ci95_low\": %.4f, \"ci95_high\": %.4f}, "
+			"\"hashes_per_second\": {\"median\": %.4f, \"ci95_low\": %.4f, \"ci95_high\": %.4f}",
+			i ? "," : "", json_string(r.name).c_str(), r.hashes_per_call, r.samples, r.cpu,
+			r.min_ns, r.median_ns, r.p99_ns, r.ci_low_ns, r.ci_high_ns,
+			r.hashrate, r.hashrate_ci_low, r.hashrate_ci_high);
+
+		if (!r.counters.empty())
+		{
+			fprintf(f, ", \"counters_per_iteration\": {");
+			for (size_t j = 0; j < r.counters.size(); ++j)
+			{
+				fprintf(f, "%s%s: %.6f", j ? ", " : "", json_string(r.counters[j].name).c_str(), r.counters[j].per_iteration);
+			}
+			fprintf(f, "}");
+		}
+		fprintf(f, "}");
+	}
+	fprintf(f, "%s]\n}\n", reg->results.empty() ? "" : "\n  ");
+
+	const bool ok = (ferror(f) == 0);
+	return (fclose(f) == 0) && ok;
+}
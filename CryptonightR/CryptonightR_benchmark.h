@@ -0,0 +1,122 @@
+#pragma once
+
+#include "definitions.h"
+#include <functional>
+#include <string>
+#include <vector>
+
+// Benchmark framework for main loop kernels
+//
+// Every call of a kernel is one sample, timed with the monotonic clock (no constant TSC assumption).
+// Results are the median, 99th percentile and a 95% confidence interval of the median, which uses
+// order statistics of the samples, so it doesn't depend on how timings are distributed.
+// Calls are measured on one pinned CPU after a warm-up, progress goes to stderr, results to stdout and
+// optionally to a JSON file which can be compared between builds.
+// Hardware counters (CryptonightR_perf.h) are collected over all samples and reported per iteration.
+
+enum
+{
+	// Main loop iterations in one hash
+	BENCHMARK_ITERATIONS = 524288,
+
+	// Last CPU the process can run on
+	BENCHMARK_CPU_AUTO = -1,
+
+	// Don't change affinity
+	BENCHMARK_CPU_NONE = -2,
+};
+
+enum benchmark_counters_mode
+{
+	BENCHMARK_COUNTERS_NONE,
+
+	// Only for benchmark_run calls which ask for them
+	BENCHMARK_COUNTERS_SELECTED,
+
+	BENCHMARK_COUNTERS_ALL,
+};
+
+struct benchmark_options
+{
+	// Samples are collected until both duration_ms and min_samples are reached
+	uint32_t duration_ms;
+	uint32_t min_samples;
+
+	// Kernel runs this long before samples are collected (caches, TLB, branch predictors, CPU frequency)
+	uint32_t warmup_ms;
+
+	int cpu;
+
+	benchmark_counters_mode counters;
+
+	// Only kernels with this substring in their names are measured, nullptr = all
+	const char* filter;
+
+	// Where benchmark_write_json writes results, nullptr = nowhere
+	const char* json_path;
+
+	// benchmark_run doesn't print anything, for modes which print their own summary
+	bool quiet;
+};
+
+// BENCHMARK_DURATION seconds, 10 samples, 500 ms warm-up, BENCHMARK_CPU_AUTO, BENCHMARK_COUNTERS_SELECTED,
+// no filter, no JSON file, not quiet
+benchmark_options benchmark_default_options();
+
+// --benchmark-duration <seconds> --benchmark-warmup <ms> --benchmark-samples <n> --benchmark-cpu <cpu|none>
+// --benchmark-counters <none|selected|all> --benchmark-filter <substring> --benchmark-json <path>
+// Other arguments are ignored, returns false if a value is missing or invalid
+bool benchmark_parse_args(int argc, char** argv, benchmark_options& options);
+
+struct benchmark_counter
+{
+	std::string name;
+	double per_iteration;
+};
+
+struct benchmark_result
+{
+	std::string name;
+	uint32_t hashes_per_call;
+	uint32_t samples;
+
+	// CPU the samples were collected on, BENCHMARK_CPU_NONE if it wasn't pinned
+	int cpu;
+
+	// Nanoseconds per main loop iteration: call time / BENCHMARK_ITERATIONS
+	double min_ns;
+	double median_ns;
+	double p99_ns;
+	double ci_low_ns;
+	double ci_high_ns;
+
+	// Hashes per second for median and confidence interval bounds
+	double hashrate;
+	double hashrate_ci_low;
+	double hashrate_ci_high;
+
+	// Empty if counters weren't collected, events which never got a hardware counter are skipped
+	std::vector<benchmark_counter> counters;
+};
+
+struct benchmark_registry;
+
+// Hardware counters are opened for the calling thread, benchmarks must run on it
+benchmark_registry* benchmark_registry_create(const benchmark_options& options);
+void benchmark_registry_destroy(benchmark_registry* reg);
+
+// False if counters are disabled or perf events can't be opened
+bool benchmark_counters_available(const benchmark_registry* reg);
+
+// Build/machine details for the JSON file, like scratchpad page size or scheduling model of generated code
+void benchmark_set_info(benchmark_registry* reg, const char* key, const std::string& value);
+
+// Measures f, prints and records the result
+// counters: collect hardware counters in BENCHMARK_COUNTERS_SELECTED mode
+// Returns nullptr if the name doesn't match the filter
+const benchmark_result* benchmark_run(benchmark_registry* reg, const char* name, uint32_t hashes_per_call, const std::function<void()>& f, bool counters = false);
+
+const std::vector<benchmark_result>& benchmark_get_results(const benchmark_registry* reg);
+
+// Writes options, info and all results to options.json_path, does nothing if it's not set
+bool benchmark_write_json(const benchmark_registry* reg);
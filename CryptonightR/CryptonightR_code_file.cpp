@@ -0,0 +1,399 @@
+#include "CryptonightR_code_file.h"
+#include "CryptonightR_kernel_cache.h"
+#include <vector>
+#include <atomic>
+#include <memory>
+#include <fstream>
+#include <string>
+#include <stdio.h>
+
+#ifdef _WIN32
+#define NOMINMAX
+#define WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+extern bool compile_kernel(const V4_Instruction* code, uint32_t ways, std::vector<uint8_t>& machine_code);
+
+static const char code_file_magic[8] = { 'C', 'N', 'R', 'C', 'O', 'D', 'E', 0 };
+
+enum entry_state : uint8_t
+{
+	ENTRY_UNCHECKED,
+	ENTRY_GOOD,
+	ENTRY_BAD,
+};
+
+struct code_file
+{
+	uint8_t* data;
+	size_t size;
+	const code_file_header* header;
+	const code_file_entry* entries;
+	uint32_t ways_per_height;
+	std::unique_ptr<std::atomic<uint8_t>[]> state;
+};
+
+static void get_hash(const void* data, size_t size, uint8_t (&result)[CODE_FILE_HASH_SIZE])
+{
+	char hash[32];
+	hash_extra_blake(data, size, hash);
+	memcpy(result, hash, CODE_FILE_HASH_SIZE);
+}
+
+// CPU vendor + family/model (without stepping)
+static void get_cpu_key(char (&key)[16])
+{
+	int data[4];
+	memset(key, 0, sizeof(key));
+
+	__cpuidex(data, 0, 0);
+	memcpy(key + 0, &data[1], 4);
+	memcpy(key + 4, &data[3], 4);
+	memcpy(key + 8, &data[2], 4);
+
+	__cpuidex(data, 1, 0);
+	const uint32_t signature = static_cast<uint32_t>(data[0]) & 0x0FFF0FF0U;
+	memcpy(key + 12, &signature, 4);
+}
+
+static void get_template_key(uint8_t (&key)[CODE_FILE_HASH_SIZE])
+{
+	V4_Instruction code[NUM_INSTRUCTIONS * 2];
+	std::vector<uint8_t> machine_code, buf;
+
+	for (uint64_t height = 0; height < 8; ++height)
+	{
+		v4_random_math_init(code, height);
+		for (uint32_t ways = 1; ways <= KERNEL_CACHE_MAX_WAYS; ++ways)
+		{
+			if (compile_kernel(code, ways, machine_code))
+			{
+				buf.insert(buf.end(), machine_code.begin(), machine_code.end());
+			}
+		}
+	}
+
+	get_hash(buf.data(), buf.size(), key);
+}
+
+static inline uint64_t align_up(uint64_t x, uint64_t alignment)
+{
+	return (x + alignment - 1) & ~(alignment - 1);
+}
+
+static uint32_t get_ways_per_height(uint32_t ways_mask)
+{
+	uint32_t result = 0;
+	for (uint32_t ways = 1; ways <= KERNEL_CACHE_MAX_WAYS; ++ways)
+	{
+		if (ways_mask & (1U << ways))
+		{
+			++result;
+		}
+	}
+	return result;
+}
+
+bool code_file_build(const char* path, uint64_t first_height, uint32_t num_heights, uint32_t ways_mask)
+{
+	code_file_header header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, code_file_magic, sizeof(header.magic));
+	header.version = CODE_FILE_VERSION;
+	header.math_bits = V4_MATH_BITS;
+	get_template_key(header.template_key);
+	get_cpu_key(header.cpu_key);
+	header.first_height = first_height;
+	header.num_heights = num_heights;
+	header.ways_mask = ways_mask;
+
+	std::vector<code_file_entry> entries;
+	std::vector<uint8_t> code_section;
+
+	V4_Instruction code[NUM_INSTRUCTIONS * 2];
+	std::vector<uint8_t> machine_code;
+
+	for (uint64_t height = first_height; height < first_height + num_heights; ++height)
+	{
+		const int num_insts = v4_random_math_init(code, height);
+		for (uint32_t ways = 1; ways <= KERNEL_CACHE_MAX_WAYS; ++ways)
+		{
+			if (!(ways_mask & (1U << ways)))
+			{
+				continue;
+			}
+
+			if (!compile_kernel(code, ways, machine_code))
+			{
+				return false;
+			}
+
+			// Keep the same alignment as in the templates
+			code_section.resize(align_up(code_section.size(), CODE_FILE_KERNEL_ALIGNMENT), 0xCC);
+
+			code_file_entry entry;
+			memset(&entry, 0, sizeof(entry));
+			entry.height = height;
+			entry.ways = ways;
+			entry.num_insts = static_cast<uint32_t>(num_insts);
+			entry.offset = code_section.size();
+			entry.size = static_cast<uint32_t>(machine_code.size());
+			get_hash(machine_code.data(), machine_code.size(), entry.hash);
+			entries.push_back(entry);
+
+			code_section.insert(code_section.end(), machine_code.begin(), machine_code.end());
+		}
+	}
+
+	header.num_entries = static_cast<uint32_t>(entries.size());
+	header.code_offset = align_up(sizeof(header) + entries.size() * sizeof(code_file_entry), CODE_FILE_CODE_ALIGNMENT);
+	header.file_size = header.code_offset + code_section.size();
+
+	for (code_file_entry& entry : entries)
+	{
+		entry.offset += header.code_offset;
+	}
+
+	// Write to a temporary file first, so a running process never sees a half-written file
+	const std::string tmp_path = std::string(path) + ".tmp";
+	{
+		std::ofstream f(tmp_path, std::ios::out | std::ios::binary | std::ios::trunc);
+		if (!f.is_open())
+		{
+			return false;
+		}
+
+		f.write((const char*)&header, sizeof(header));
+		f.write((const char*)entries.data(), entries.size() * sizeof(code_file_entry));
+
+		const std::vector<char> padding(header.code_offset - sizeof(header) - entries.size() * sizeof(code_file_entry), 0);
+		f.write(padding.data(), padding.size());
+		f.write((const char*)code_section.data(), code_section.size());
+
+		if (!f.good())
+		{
+			return false;
+		}
+	}
+
+	remove(path);
+	return rename(tmp_path.c_str(), path) == 0;
+}
+
+static bool map_file(const char* path, uint8_t** data, size_t* size)
+{
+#ifdef _WIN32
+	HANDLE h = CreateFileA(path, GENERIC_READ | GENERIC_EXECUTE, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (h == INVALID_HANDLE_VALUE)
+	{
+		return false;
+	}
+
+	LARGE_INTEGER file_size;
+	if (!GetFileSizeEx(h, &file_size) || (file_size.QuadPart < static_cast<LONGLONG>(sizeof(code_file_header))))
+	{
+		CloseHandle(h);
+		return false;
+	}
+
+	HANDLE mapping = CreateFileMappingA(h, NULL, PAGE_EXECUTE_READ, 0, 0, NULL);
+	CloseHandle(h);
+	if (!mapping)
+	{
+		return false;
+	}
+
+	void* p = MapViewOfFile(mapping, FILE_MAP_READ | FILE_MAP_EXECUTE, 0, 0, 0);
+	CloseHandle(mapping);
+	if (!p)
+	{
+		return false;
+	}
+
+	*data = (uint8_t*) p;
+	*size = static_cast<size_t>(file_size.QuadPart);
+#else
+	const int fd = open(path, O_RDONLY | O_CLOEXEC);
+	if (fd < 0)
+	{
+		return false;
+	}
+
+	struct stat st;
+	if ((fstat(fd, &st) != 0) || (st.st_size < static_cast<off_t>(sizeof(code_file_header))))
+	{
+		close(fd);
+		return false;
+	}
+
+	void* p = mmap(NULL, static_cast<size_t>(st.st_size), PROT_READ | PROT_EXEC, MAP_SHARED, fd, 0);
+	close(fd);
+	if (p == MAP_FAILED)
+	{
+		return false;
+	}
+
+	*data = (uint8_t*) p;
+	*size = static_cast<size_t>(st.st_size);
+#endif
+
+	return true;
+}
+
+static void unmap_file(uint8_t* data, size_t size)
+{
+#ifdef _WIN32
+	(void) size;
+	UnmapViewOfFile(data);
+#else
+	munmap(data, size);
+#endif
+}
+
+static bool check_file(const uint8_t* data, size_t size)
+{
+	const code_file_header* header = (const code_file_header*) data;
+
+	if ((memcmp(header->magic, code_file_magic, sizeof(header->magic)) != 0) || (header->version != CODE_FILE_VERSION) || (header->math_bits != V4_MATH_BITS))
+	{
+		return false;
+	}
+
+	if ((header->file_size != size) || (header->code_offset > size) || (header->code_offset % CODE_FILE_CODE_ALIGNMENT))
+	{
+		return false;
+	}
+
+	if (header->num_entries != static_cast<uint64_t>(header->num_heights) * get_ways_per_height(header->ways_mask))
+	{
+		return false;
+	}
+
+	if (sizeof(code_file_header) + static_cast<uint64_t>(header->num_entries) * sizeof(code_file_entry) > header->code_offset)
+	{
+		return false;
+	}
+
+	const code_file_entry* entries = (const code_file_entry*)(data + sizeof(code_file_header));
+	for (uint32_t i = 0; i < header->num_entries; ++i)
+	{
+		const code_file_entry& entry = entries[i];
+		if ((entry.offset < header->code_offset) || (entry.offset + entry.size > size) || (entry.offset % CODE_FILE_KERNEL_ALIGNMENT))
+		{
+			return false;
+		}
+	}
+
+	char cpu_key[16];
+	get_cpu_key(cpu_key);
+	if (memcmp(header->cpu_key, cpu_key, sizeof(cpu_key)) != 0)
+	{
+		return false;
+	}
+
+	uint8_t template_key[CODE_FILE_HASH_SIZE];
+	get_template_key(template_key);
+	if (memcmp(header->template_key, template_key, sizeof(template_key)) != 0)
+	{
+		return false;
+	}
+
+	return true;
+}
+
+code_file* code_file_open(const char* path)
+{
+	uint8_t* data;
+	size_t size;
+	if (!map_file(path, &data, &size))
+	{
+		return nullptr;
+	}
+
+	if (!check_file(data, size))
+	{
+		unmap_file(data, size);
+		return nullptr;
+	}
+
+	code_file* file = new code_file();
+	file->data = data;
+	file->size = size;
+	file->header = (const code_file_header*) data;
+	file->entries = (const code_file_entry*)(data + sizeof(code_file_header));
+	file->ways_per_height = get_ways_per_height(file->header->ways_mask);
+	file->state.reset(new std::atomic<uint8_t>[file->header->num_entries]);
+	for (uint32_t i = 0; i < file->header->num_entries; ++i)
+	{
+		file->state[i] = ENTRY_UNCHECKED;
+	}
+
+	return file;
+}
+
+void code_file_close(code_file* file)
+{
+	if (file)
+	{
+		unmap_file(file->data, file->size);
+		delete file;
+	}
+}
+
+const void* code_file_get(code_file* file, uint64_t height, uint32_t ways, int* num_insts)
+{
+	const code_file_header* header = file->header;
+	if ((height < header->first_height) || (height - header->first_height >= header->num_heights) || (ways > KERNEL_CACHE_MAX_WAYS) || !(header->ways_mask & (1U << ways)))
+	{
+		return nullptr;
+	}
+
+	// Entries are sorted by (height, ways), so the index can be calculated directly
+	uint32_t index = static_cast<uint32_t>(height - header->first_height) * file->ways_per_height;
+	for (uint32_t i = 1; i < ways; ++i)
+	{
+		if (header->ways_mask & (1U << i))
+		{
+			++index;
+		}
+	}
+
+	const code_file_entry& entry = file->entries[index];
+	if ((entry.height != height) || (entry.ways != ways))
+	{
+		return nullptr;
+	}
+
+	const uint8_t* p = file->data + entry.offset;
+
+	uint8_t state = file->state[index].load(std::memory_order_acquire);
+	if (state == ENTRY_UNCHECKED)
+	{
+		uint8_t hash[CODE_FILE_HASH_SIZE];
+		get_hash(p, entry.size, hash);
+		state = (memcmp(hash, entry.hash, sizeof(hash)) == 0) ? ENTRY_GOOD : ENTRY_BAD;
+		file->state[index].store(state, std::memory_order_release);
+	}
+
+	if (state != ENTRY_GOOD)
+	{
+		return nullptr;
+	}
+
+	if (num_insts)
+	{
+		*num_insts = static_cast<int>(entry.num_insts);
+	}
+	return p;
+}
+
+const code_file_header* code_file_get_header(const code_file* file)
+{
+	return file->header;
+}
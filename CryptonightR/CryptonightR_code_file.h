@@ -0,0 +1,68 @@
+#pragma once
+
+#include "definitions.h"
+
+// Precompiled machine code for a range of heights, stored in a file which is memory-mapped read+execute
+//
+// Programs are known for every future block, so code can be compiled once and shared between restarts
+// and identical machines. The file is never mapped writable, so it works under W^X policies.
+//
+// File layout (little endian):
+//   code_file_header
+//   code_file_entry[num_entries], sorted by (height, ways)
+//   machine code, starting at code_offset (page aligned), each kernel is 64-byte aligned
+//
+// The file is rejected if the format version, math width, CPU key or template key don't match.
+// Template key is a hash of code compiled for a few probe heights, so any change to templates
+// or code generator invalidates old files.
+
+enum
+{
+	CODE_FILE_VERSION = 1,
+	CODE_FILE_CODE_ALIGNMENT = 4096,
+	CODE_FILE_KERNEL_ALIGNMENT = 64,
+	CODE_FILE_HASH_SIZE = 16,
+};
+
+struct code_file_header
+{
+	char magic[8];
+	uint32_t version;
+	uint32_t math_bits;
+	uint8_t template_key[CODE_FILE_HASH_SIZE];
+	char cpu_key[16];
+	uint64_t first_height;
+	uint32_t num_heights;
+	uint32_t ways_mask;
+	uint32_t num_entries;
+	uint32_t reserved;
+	uint64_t code_offset;
+	uint64_t file_size;
+};
+
+struct code_file_entry
+{
+	uint64_t height;
+	uint32_t ways;
+	uint32_t num_insts;
+	uint64_t offset;
+	uint32_t size;
+	uint32_t reserved;
+	uint8_t hash[CODE_FILE_HASH_SIZE];
+};
+
+struct code_file;
+
+// Compiles kernels for heights [first_height, first_height + num_heights) and writes them to path
+// ways_mask uses the same bits as kernel cache (KERNEL_SINGLE, KERNEL_DOUBLE, ...)
+bool code_file_build(const char* path, uint64_t first_height, uint32_t num_heights, uint32_t ways_mask);
+
+// Returns nullptr if the file doesn't exist, is damaged or was built for different CPU/templates
+code_file* code_file_open(const char* path);
+void code_file_close(code_file* file);
+
+// Returns kernel ready to run or nullptr if it's not in the file
+// Kernel's hash is checked the first time it's requested
+const void* code_file_get(code_file* file, uint64_t height, uint32_t ways, int* num_insts);
+
+const code_file_header* code_file_get_header(const code_file* file);
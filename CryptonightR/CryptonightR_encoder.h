@@ -0,0 +1,153 @@
+#pragma once
+
+#include "definitions.h"
+
+// x86-64 encoder for random math instructions
+//
+// All possible (opcode, dst, src) combinations are encoded at compile time into a table,
+// so code generator only copies a few bytes per instruction and patches ADD constants.
+// Register allocation is a parameter, so templates with different register usage can have their own tables.
+
+enum x86_reg : uint8_t
+{
+	X86_RAX, X86_RCX, X86_RDX, X86_RBX, X86_RSP, X86_RBP, X86_RSI, X86_RDI,
+	X86_R8, X86_R9, X86_R10, X86_R11, X86_R12, X86_R13, X86_R14, X86_R15,
+};
+
+// x86 registers holding V4 registers R0-R7
+struct v4_x86_regs
+{
+	x86_reg r[8];
+};
+
+// Registers used by CryptonightR_template.inc
+// rcx is reserved for rotation count and 64-bit ADD constant
+constexpr v4_x86_regs v4_template_regs = { { X86_RBX, X86_RSI, X86_RDI, X86_RBP, X86_RSP, X86_R15, X86_RAX, X86_RDX } };
+
+enum
+{
+	V4_X86_MAX_SIZE = 11,
+	V4_X86_MOV_SIZE = 3,
+
+	// Longest instruction + "mov rcx, src"
+	V4_X86_MAX_INST_SIZE = V4_X86_MAX_SIZE + V4_X86_MOV_SIZE,
+};
+
+struct v4_x86_code
+{
+	uint8_t size;
+	uint8_t code[V4_X86_MAX_SIZE];
+
+	// Offset of ADD constant in code, 0 if there is none
+	uint8_t imm_offset;
+
+	// "mov rcx, src" for rotations, mov_size is 0 for other instructions
+	uint8_t mov_size;
+	uint8_t mov_code[V4_X86_MOV_SIZE];
+};
+
+struct v4_x86_table
+{
+	v4_x86_code code[V4_INSTRUCTION_COUNT][1 << V4_DST_INDEX_BITS][1 << V4_SRC_INDEX_BITS];
+};
+
+constexpr bool x86_need_rex(bool w, uint8_t reg, uint8_t rm)
+{
+	return w || (reg >= 8) || (rm >= 8);
+}
+
+constexpr uint8_t x86_rex(bool w, uint8_t reg, uint8_t rm)
+{
+	return static_cast<uint8_t>(0x40 | (w ? 8 : 0) | ((reg >> 3) << 2) | (rm >> 3));
+}
+
+constexpr uint8_t x86_modrm(uint8_t reg, uint8_t rm)
+{
+	return static_cast<uint8_t>(0xC0 | ((reg & 7) << 3) | (rm & 7));
+}
+
+// Register-register instruction: [REX] opcode... ModRM
+constexpr void x86_emit_rr(uint8_t* code, uint8_t& size, bool w, const uint8_t* opcode, uint8_t opcode_size, uint8_t reg, uint8_t rm)
+{
+	if (x86_need_rex(w, reg, rm))
+	{
+		code[size++] = x86_rex(w, reg, rm);
+	}
+	for (uint8_t i = 0; i < opcode_size; ++i)
+	{
+		code[size++] = opcode[i];
+	}
+	code[size++] = x86_modrm(reg, rm);
+}
+
+constexpr v4_x86_code x86_encode(uint8_t opcode, x86_reg dst, x86_reg src)
+{
+	constexpr uint8_t op_imul[2] = { 0x0F, 0xAF }; // imul r64, r/m64
+	constexpr uint8_t op_add[1] = { 0x03 };        // add r64, r/m64
+	constexpr uint8_t op_sub[1] = { 0x2B };        // sub r64, r/m64
+	constexpr uint8_t op_xor[1] = { 0x33 };        // xor r64, r/m64
+	constexpr uint8_t op_mov[1] = { 0x8B };        // mov r64, r/m64
+	constexpr uint8_t op_rot[1] = { 0xD3 };        // rol (/0), ror (/1) r/m, cl
+#if RANDOM_MATH_64_BIT == 1
+	constexpr uint8_t op_mov_ecx_imm = 0xB9;       // mov ecx, imm32
+#else
+	constexpr uint8_t op_add_imm[1] = { 0x81 };    // add r/m64, imm32 (/0)
+#endif
+
+	v4_x86_code result = {};
+
+	switch (opcode)
+	{
+	case MUL:
+		x86_emit_rr(result.code, result.size, true, op_imul, 2, dst, src);
+		break;
+
+	case ADD:
+		x86_emit_rr(result.code, result.size, true, op_add, 1, dst, src);
+#if RANDOM_MATH_64_BIT == 1
+		// 64-bit constant can't be an immediate operand, so it goes through rcx
+		result.code[result.size++] = op_mov_ecx_imm;
+		result.imm_offset = result.size;
+		result.size += 4;
+		x86_emit_rr(result.code, result.size, true, op_add, 1, dst, X86_RCX);
+#else
+		// Sign extension of the immediate doesn't matter, only lower 32 bits are used
+		x86_emit_rr(result.code, result.size, true, op_add_imm, 1, 0, dst);
+		result.imm_offset = result.size;
+		result.size += 4;
+#endif
+		break;
+
+	case SUB:
+		x86_emit_rr(result.code, result.size, true, op_sub, 1, dst, src);
+		break;
+
+	case ROR:
+	case ROL:
+		x86_emit_rr(result.mov_code, result.mov_size, true, op_mov, 1, X86_RCX, src);
+		x86_emit_rr(result.code, result.size, RANDOM_MATH_64_BIT == 1, op_rot, 1, (opcode == ROR) ? 1 : 0, dst);
+		break;
+
+	case XOR:
+		x86_emit_rr(result.code, result.size, true, op_xor, 1, dst, src);
+		break;
+	}
+
+	return result;
+}
+
+constexpr v4_x86_table make_v4_x86_table(const v4_x86_regs& regs)
+{
+	v4_x86_table table = {};
+	for (uint8_t opcode = 0; opcode < V4_INSTRUCTION_COUNT; ++opcode)
+	{
+		for (uint8_t dst = 0; dst < (1 << V4_DST_INDEX_BITS); ++dst)
+		{
+			for (uint8_t src = 0; src < (1 << V4_SRC_INDEX_BITS); ++src)
+			{
+				table.code[opcode][dst][src] = x86_encode(opcode, regs.r[dst], regs.r[src]);
+			}
+		}
+	}
+	return table;
+}
@@ -0,0 +1,644 @@
+#include "CryptonightR_explode.h"
+
+#ifdef __GNUC__
+#define TARGET_AES __attribute__((target("aes,sse4.1")))
+#define TARGET_VAES256 __attribute__((target("avx2,vaes,aes")))
+#define TARGET_VAES512 __attribute__((target("avx512f,vaes,aes")))
+#define TARGET_XSAVE __attribute__((target("xsave")))
+#else
+#define TARGET_AES
+#define TARGET_VAES256
+#define TARGET_VAES512
+#define TARGET_XSAVE
+#endif
+
+static FORCEINLINE __m128i sl_xor(__m128i x)
+{
+	__m128i t = _mm_slli_si128(x, 4);
+	x = _mm_xor_si128(x, t);
+	t = _mm_slli_si128(t, 4);
+	x = _mm_xor_si128(x, t);
+	t = _mm_slli_si128(t, 4);
+	return _mm_xor_si128(x, t);
+}
+
+template<uint8_t rcon>
+TARGET_AES static FORCEINLINE void genkey_sub(__m128i& x0, __m128i& x2)
+{
+	__m128i x1 = _mm_shuffle_epi32(_mm_aeskeygenassist_si128(x2, rcon), 0xFF);
+	x0 = _mm_xor_si128(sl_xor(x0), x1);
+
+	x1 = _mm_shuffle_epi32(_mm_aeskeygenassist_si128(x0, 0x00), 0xAA);
+	x2 = _mm_xor_si128(sl_xor(x2), x1);
+}
+
+TARGET_AES static void genkey(const uint8_t* key, __m128i (&k)[10])
+{
+	__m128i x0 = _mm_loadu_si128((const __m128i*) key);
+	__m128i x2 = _mm_loadu_si128((const __m128i*) (key + 16));
+	k[0] = x0;
+	k[1] = x2;
+	genkey_sub<0x01>(x0, x2); k[2] = x0; k[3] = x2;
+	genkey_sub<0x02>(x0, x2); k[4] = x0; k[5] = x2;
+	genkey_sub<0x04>(x0, x2); k[6] = x0; k[7] = x2;
+	genkey_sub<0x08>(x0, x2); k[8] = x0; k[9] = x2;
+}
+
+TARGET_AES static void explode_aesni(const uint8_t* hash_state, uint8_t* long_state)
+{
+	__m128i k[10];
+	genkey(hash_state, k);
+
+	const __m128i* text = (const __m128i*) (hash_state + 64);
+	__m128i x0 = _mm_loadu_si128(text + 0);
+	__m128i x1 = _mm_loadu_si128(text + 1);
+	__m128i x2 = _mm_loadu_si128(text + 2);
+	__m128i x3 = _mm_loadu_si128(text + 3);
+	__m128i x4 = _mm_loadu_si128(text + 4);
+	__m128i x5 = _mm_loadu_si128(text + 5);
+	__m128i x6 = _mm_loadu_si128(text + 6);
+	__m128i x7 = _mm_loadu_si128(text + 7);
+
+	for (__m128i* p = (__m128i*) long_state, *e = (__m128i*) (long_state + MEMORY); p < e; p += 8)
+	{
+		for (int i = 0; i < 10; ++i)
+		{
+			x0 = _mm_aesenc_si128(x0, k[i]);
+			x1 = _mm_aesenc_si128(x1, k[i]);
+			x2 = _mm_aesenc_si128(x2, k[i]);
+			x3 = _mm_aesenc_si128(x3, k[i]);
+			x4 = _mm_aesenc_si128(x4, k[i]);
+			x5 = _mm_aesenc_si128(x5, k[i]);
+			x6 = _mm_aesenc_si128(x6, k[i]);
+			x7 = _mm_aesenc_si128(x7, k[i]);
+		}
+
+		_mm_store_si128(p + 0, x0);
+		_mm_store_si128(p + 1, x1);
+		_mm_store_si128(p + 2, x2);
+		_mm_store_si128(p + 3, x3);
+		_mm_store_si128(p + 4, x4);
+		_mm_store_si128(p + 5, x5);
+		_mm_store_si128(p + 6, x6);
+		_mm_store_si128(p + 7, x7);
+	}
+}
+
+TARGET_VAES256 static void explode_vaes256(const uint8_t* hash_state, uint8_t* long_state)
+{
+	__m128i k128[10];
+	genkey(hash_state, k128);
+
+	__m256i k[10];
+	for (int i = 0; i < 10; ++i)
+	{
+		k[i] = _mm256_broadcastsi128_si256(k128[i]);
+	}
+
+	const __m256i* text = (const __m256i*) (hash_state + 64);
+	__m256i x0 = _mm256_loadu_si256(text + 0);
+	__m256i x1 = _mm256_loadu_si256(text + 1);
+	__m256i x2 = _mm256_loadu_si256(text + 2);
+	__m256i x3 = _mm256_loadu_si256(text + 3);
+
+	for (__m256i* p = (__m256i*) long_state, *e = (__m256i*) (long_state + MEMORY); p < e; p += 4)
+	{
+		for (int i = 0; i < 10; ++i)
+		{
+			x0 = _mm256_aesenc_epi128(x0, k[i]);
+			x1 = _mm256_aesenc_epi128(x1, k[i]);
+			x2 = _mm256_aesenc_epi128(x2, k[i]);
+			x3 = _mm256_aesenc_epi128(x3, k[i]);
+		}
+
+		_mm256_storeu_si256(p + 0, x0);
+		_mm256_storeu_si256(p + 1, x1);
+		_mm256_storeu_si256(p + 2, x2);
+		_mm256_storeu_si256(p + 3, x3);
+	}
+}
+
+TARGET_VAES512 static void explode_vaes512(const uint8_t* hash_state, uint8_t* long_state)
+{
+	__m128i k128[10];
+	genkey(hash_state, k128);
+
+	__m512i k[10];
+	for (int i = 0; i < 10; ++i)
+	{
+		k[i] = _mm512_broadcast_i32x4(k128[i]);
+	}
+
+	const __m512i* text = (const __m512i*) (hash_state + 64);
+	__m512i x0 = _mm512_loadu_si512(text + 0);
+	__m512i x1 = _mm512_loadu_si512(text + 1);
+
+	for (__m512i* p = (__m512i*) long_state, *e = (__m512i*) (long_state + MEMORY); p < e; p += 2)
+	{
+		for (int i = 0; i < 10; ++i)
+		{
+			x0 = _mm512_aesenc_epi128(x0, k[i]);
+			x1 = _mm512_aesenc_epi128(x1, k[i]);
+		}
+
+		_mm512_storeu_si512(p + 0, x0);
+		_mm512_storeu_si512(p + 1, x1);
+	}
+}
+
+// Scratchpad is read sequentially, prefetching a few chunks ahead keeps more cache misses in flight
+// than the hardware prefetcher does at the start of every 4 KB page
+enum { IMPLODE_PREFETCH_DISTANCE = 1024 };
+
+TARGET_AES static void implode_aesni(const uint8_t* long_state, uint8_t* hash_state)
+{
+	__m128i k[10];
+	genkey(hash_state + 32, k);
+
+	__m128i* text = (__m128i*) (hash_state + 64);
+	__m128i x0 = _mm_loadu_si128(text + 0);
+	__m128i x1 = _mm_loadu_si128(text + 1);
+	__m128i x2 = _mm_loadu_si128(text + 2);
+	__m128i x3 = _mm_loadu_si128(text + 3);
+	__m128i x4 = _mm_loadu_si128(text + 4);
+	__m128i x5 = _mm_loadu_si128(text + 5);
+	__m128i x6 = _mm_loadu_si128(text + 6);
+	__m128i x7 = _mm_loadu_si128(text + 7);
+
+	for (const __m128i* p = (const __m128i*) long_state, *e = (const __m128i*) (long_state + MEMORY); p < e; p += 8)
+	{
+		_mm_prefetch((const char*) p + IMPLODE_PREFETCH_DISTANCE, _MM_HINT_T0);
+		_mm_prefetch((const char*) p + IMPLODE_PREFETCH_DISTANCE + 64, _MM_HINT_T0);
+
+		x0 = _mm_xor_si128(x0, _mm_load_si128(p + 0));
+		x1 = _mm_xor_si128(x1, _mm_load_si128(p + 1));
+		x2 = _mm_xor_si128(x2, _mm_load_si128(p + 2));
+		x3 = _mm_xor_si128(x3, _mm_load_si128(p + 3));
+		x4 = _mm_xor_si128(x4, _mm_load_si128(p + 4));
+		x5 = _mm_xor_si128(x5, _mm_load_si128(p + 5));
+		x6 = _mm_xor_si128(x6, _mm_load_si128(p + 6));
+		x7 = _mm_xor_si128(x7, _mm_load_si128(p + 7));
+
+		for (int i = 0; i < 10; ++i)
+		{
+			x0 = _mm_aesenc_si128(x0, k[i]);
+			x1 = _mm_aesenc_si128(x1, k[i]);
+			x2 = _mm_aesenc_si128(x2, k[i]);
+			x3 = _mm_aesenc_si128(x3, k[i]);
+			x4 = _mm_aesenc_si128(x4, k[i]);
+			x5 = _mm_aesenc_si128(x5, k[i]);
+			x6 = _mm_aesenc_si128(x6, k[i]);
+			x7 = _mm_aesenc_si128(x7, k[i]);
+		}
+	}
+
+	_mm_storeu_si128(text + 0, x0);
+	_mm_storeu_si128(text + 1, x1);
+	_mm_storeu_si128(text + 2, x2);
+	_mm_storeu_si128(text + 3, x3);
+	_mm_storeu_si128(text + 4, x4);
+	_mm_storeu_si128(text + 5, x5);
+	_mm_storeu_si128(text + 6, x6);
+	_mm_storeu_si128(text + 7, x7);
+}
+
+TARGET_VAES256 static void implode_vaes256(const uint8_t* long_state, uint8_t* hash_state)
+{
+	__m128i k128[10];
+	genkey(hash_state + 32, k128);
+
+	__m256i k[10];
+	for (int i = 0; i < 10; ++i)
+	{
+		k[i] = _mm256_broadcastsi128_si256(k128[i]);
+	}
+
+	__m256i* text = (__m256i*) (hash_state + 64);
+	__m256i x0 = _mm256_loadu_si256(text + 0);
+	__m256i x1 = _mm256_loadu_si256(text + 1);
+	__m256i x2 = _mm256_loadu_si256(text + 2);
+	__m256i x3 = _mm256_loadu_si256(text + 3);
+
+	for (const __m256i* p = (const __m256i*) long_state, *e = (const __m256i*) (long_state + MEMORY); p < e; p += 4)
+	{
+		_mm_prefetch((const char*) p + IMPLODE_PREFETCH_DISTANCE, _MM_HINT_T0);
+		_mm_prefetch((const char*) p + IMPLODE_PREFETCH_DISTANCE + 64, _MM_HINT_T0);
+
+		x0 = _mm256_xor_si256(x0, _mm256_loadu_si256(p + 0));
+		x1 = _mm256_xor_si256(x1, _mm256_loadu_si256(p + 1));
+		x2 = _mm256_xor_si256(x2, _mm256_loadu_si256(p + 2));
+		x3 = _mm256_xor_si256(x3, _mm256_loadu_si256(p + 3));
+
+		for (int i = 0; i < 10; ++i)
+		{
+			x0 = _mm256_aesenc_epi128(x0, k[i]);
+			x1 = _mm256_aesenc_epi128(x1, k[i]);
+			x2 = _mm256_aesenc_epi128(x2, k[i]);
+			x3 = _mm256_aesenc_epi128(x3, k[i]);
+		}
+	}
+
+	_mm256_storeu_si256(text + 0, x0);
+	_mm256_storeu_si256(text + 1, x1);
+	_mm256_storeu_si256(text + 2, x2);
+	_mm256_storeu_si256(text + 3, x3);
+}
+
+TARGET_VAES512 static void implode_vaes512(const uint8_t* long_state, uint8_t* hash_state)
+{
+	__m128i k128[10];
+	genkey(hash_state + 32, k128);
+
+	__m512i k[10];
+	for (int i = 0; i < 10; ++i)
+	{
+		k[i] = _mm512_broadcast_i32x4(k128[i]);
+	}
+
+	__m512i* text = (__m512i*) (hash_state + 64);
+	__m512i x0 = _mm512_loadu_si512(text + 0);
+	__m512i x1 = _mm512_loadu_si512(text + 1);
+
+	for (const __m512i* p = (const __m512i*) long_state, *e = (const __m512i*) (long_state + MEMORY); p < e; p += 2)
+	{
+		_mm_prefetch((const char*) p + IMPLODE_PREFETCH_DISTANCE, _MM_HINT_T0);
+		_mm_prefetch((const char*) p + IMPLODE_PREFETCH_DISTANCE + 64, _MM_HINT_T0);
+
+		x0 = _mm512_xor_si512(x0, _mm512_loadu_si512(p + 0));
+		x1 = _mm512_xor_si512(x1, _mm512_loadu_si512(p + 1));
+
+		for (int i = 0; i < 10; ++i)
+		{
+			x0 = _mm512_aesenc_epi128(x0, k[i]);
+			x1 = _mm512_aesenc_epi128(x1, k[i]);
+		}
+	}
+
+	_mm512_storeu_si512(text + 0, x0);
+	_mm512_storeu_si512(text + 1, x1);
+}
+
+// Two hashes at once: one VAES instruction has 2-4 blocks, so a single hash has only 2-4 dependency chains
+// and waits for AES latency. Two hashes double the number of chains.
+// AES-NI already has 8 chains per hash, it just runs the hashes one after another.
+
+TARGET_VAES256 static void explode_vaes256_x2(const uint8_t* hash_state0, uint8_t* long_state0, const uint8_t* hash_state1, uint8_t* long_state1)
+{
+	__m128i k128[2][10];
+	genkey(hash_state0, k128[0]);
+	genkey(hash_state1, k128[1]);
+
+	__m256i k0[10], k1[10];
+	for (int i = 0; i < 10; ++i)
+	{
+		k0[i] = _mm256_broadcastsi128_si256(k128[0][i]);
+		k1[i] = _mm256_broadcastsi128_si256(k128[1][i]);
+	}
+
+	const __m256i* text0 = (const __m256i*) (hash_state0 + 64);
+	const __m256i* text1 = (const __m256i*) (hash_state1 + 64);
+	__m256i x0 = _mm256_loadu_si256(text0 + 0);
+	__m256i x1 = _mm256_loadu_si256(text0 + 1);
+	__m256i x2 = _mm256_loadu_si256(text0 + 2);
+	__m256i x3 = _mm256_loadu_si256(text0 + 3);
+	__m256i y0 = _mm256_loadu_si256(text1 + 0);
+	__m256i y1 = _mm256_loadu_si256(text1 + 1);
+	__m256i y2 = _mm256_loadu_si256(text1 + 2);
+	__m256i y3 = _mm256_loadu_si256(text1 + 3);
+
+	__m256i* p0 = (__m256i*) long_state0;
+	__m256i* p1 = (__m256i*) long_state1;
+	for (__m256i* e = (__m256i*) (long_state0 + MEMORY); p0 < e; p0 += 4, p1 += 4)
+	{
+		for (int i = 0; i < 10; ++i)
+		{
+			x0 = _mm256_aesenc_epi128(x0, k0[i]);
+			x1 = _mm256_aesenc_epi128(x1, k0[i]);
+			x2 = _mm256_aesenc_epi128(x2, k0[i]);
+			x3 = _mm256_aesenc_epi128(x3, k0[i]);
+			y0 = _mm256_aesenc_epi128(y0, k1[i]);
+			y1 = _mm256_aesenc_epi128(y1, k1[i]);
+			y2 = _mm256_aesenc_epi128(y2, k1[i]);
+			y3 = _mm256_aesenc_epi128(y3, k1[i]);
+		}
+
+		_mm256_storeu_si256(p0 + 0, x0);
+		_mm256_storeu_si256(p0 + 1, x1);
+		_mm256_storeu_si256(p0 + 2, x2);
+		_mm256_storeu_si256(p0 + 3, x3);
+		_mm256_storeu_si256(p1 + 0, y0);
+		_mm256_storeu_si256(p1 + 1, y1);
+		_mm256_storeu_si256(p1 + 2, y2);
+		_mm256_storeu_si256(p1 + 3, y3);
+	}
+}
+
+TARGET_VAES512 static void explode_vaes512_x2(const uint8_t* hash_state0, uint8_t* long_state0, const uint8_t* hash_state1, uint8_t* long_state1)
+{
+	__m128i k128[2][10];
+	genkey(hash_state0, k128[0]);
+	genkey(hash_state1, k128[1]);
+
+	__m512i k0[10], k1[10];
+	for (int i = 0; i < 10; ++i)
+	{
+		k0[i] = _mm512_broadcast_i32x4(k128[0][i]);
+		k1[i] = _mm512_broadcast_i32x4(k128[1][i]);
+	}
+
+	const __m512i* text0 = (const __m512i*) (hash_state0 + 64);
+	const __m512i* text1 = (const __m512i*) (hash_state1 + 64);
+	__m512i x0 = _mm512_loadu_si512(text0 + 0);
+	__m512i x1 = _mm512_loadu_si512(text0 + 1);
+	__m512i y0 = _mm512_loadu_si512(text1 + 0);
+	__m512i y1 = _mm512_loadu_si512(text1 + 1);
+
+	__m512i* p0 = (__m512i*) long_state0;
+	__m512i* p1 = (__m512i*) long_state1;
+	for (__m512i* e = (__m512i*) (long_state0 + MEMORY); p0 < e; p0 += 2, p1 += 2)
+	{
+		for (int i = 0; i < 10; ++i)
+		{
+			x0 = _mm512_aesenc_epi128(x0, k0[i]);
+			x1 = _mm512_aesenc_epi128(x1, k0[i]);
+			y0 = _mm512_aesenc_epi128(y0, k1[i]);
+			y1 = _mm512_aesenc_epi128(y1, k1[i]);
+		}
+
+		_mm512_storeu_si512(p0 + 0, x0);
+		_mm512_storeu_si512(p0 + 1, x1);
+		_mm512_storeu_si512(p1 + 0, y0);
+		_mm512_storeu_si512(p1 + 1, y1);
+	}
+}
+
+TARGET_VAES256 static void implode_vaes256_x2(const uint8_t* long_state0, uint8_t* hash_state0, const uint8_t* long_state1, uint8_t* hash_state1)
+{
+	__m128i k128[2][10];
+	genkey(hash_state0 + 32, k128[0]);
+	genkey(hash_state1 + 32, k128[1]);
+
+	__m256i k0[10], k1[10];
+	for (int i = 0; i < 10; ++i)
+	{
+		k0[i] = _mm256_broadcastsi128_si256(k128[0][i]);
+		k1[i] = _mm256_broadcastsi128_si256(k128[1][i]);
+	}
+
+	__m256i* text0 = (__m256i*) (hash_state0 + 64);
+	__m256i* text1 = (__m256i*) (hash_state1 + 64);
+	__m256i x0 = _mm256_loadu_si256(text0 + 0);
+	__m256i x1 = _mm256_loadu_si256(text0 + 1);
+	__m256i x2 = _mm256_loadu_si256(text0 + 2);
+	__m256i x3 = _mm256_loadu_si256(text0 + 3);
+	__m256i y0 = _mm256_loadu_si256(text1 + 0);
+	__m256i y1 = _mm256_loadu_si256(text1 + 1);
+	__m256i y2 = _mm256_loadu_si256(text1 + 2);
+	__m256i y3 = _mm256_loadu_si256(text1 + 3);
+
+	const __m256i* p0 = (const __m256i*) long_state0;
+	const __m256i* p1 = (const __m256i*) long_state1;
+	for (const __m256i* e = (const __m256i*) (long_state0 + MEMORY); p0 < e; p0 += 4, p1 += 4)
+	{
+		_mm_prefetch((const char*) p0 + IMPLODE_PREFETCH_DISTANCE, _MM_HINT_T0);
+		_mm_prefetch((const char*) p0 + IMPLODE_PREFETCH_DISTANCE + 64, _MM_HINT_T0);
+		_mm_prefetch((const char*) p1 + IMPLODE_PREFETCH_DISTANCE, _MM_HINT_T0);
+		_mm_prefetch((const char*) p1 + IMPLODE_PREFETCH_DISTANCE + 64, _MM_HINT_T0);
+
+		x0 = _mm256_xor_si256(x0, _mm256_loadu_si256(p0 + 0));
+		x1 = _mm256_xor_si256(x1, _mm256_loadu_si256(p0 + 1));
+		x2 = _mm256_xor_si256(x2, _mm256_loadu_si256(p0 + 2));
+		x3 = _mm256_xor_si256(x3, _mm256_loadu_si256(p0 + 3));
+		y0 = _mm256_xor_si256(y0, _mm256_loadu_si256(p1 + 0));
+		y1 = _mm256_xor_si256(y1, _mm256_loadu_si256(p1 + 1));
+		y2 = _mm256_xor_si256(y2, _mm256_loadu_si256(p1 + 2));
+		y3 = _mm256_xor_si256(y3, _mm256_loadu_si256(p1 + 3));
+
+		for (int i = 0; i < 10; ++i)
+		{
+			x0 = _mm256_aesenc_epi128(x0, k0[i]);
+			x1 = _mm256_aesenc_epi128(x1, k0[i]);
+			x2 = _mm256_aesenc_epi128(x2, k0[i]);
+			x3 = _mm256_aesenc_epi128(x3, k0[i]);
+			y0 = _mm256_aesenc_epi128(y0, k1[i]);
+			y1 = _mm256_aesenc_epi128(y1, k1[i]);
+			y2 = _mm256_aesenc_epi128(y2, k1[i]);
+			y3 = _mm256_aesenc_epi128(y3, k1[i]);
+		}
+	}
+
+	_mm256_storeu_si256(text0 + 0, x0);
+	_mm256_storeu_si256(text0 + 1, x1);
+	_mm256_storeu_si256(text0 + 2, x2);
+	_mm256_storeu_si256(text0 + 3, x3);
+	_mm256_storeu_si256(text1 + 0, y0);
+	_mm256_storeu_si256(text1 + 1, y1);
+	_mm256_storeu_si256(text1 + 2, y2);
+	_mm256_storeu_si256(text1 + 3, y3);
+}
+
+TARGET_VAES512 static void implode_vaes512_x2(const uint8_t* long_state0, uint8_t* hash_state0, const uint8_t* long_state1, uint8_t* hash_state1)
+{
+	__m128i k128[2][10];
+	genkey(hash_state0 + 32, k128[0]);
+	genkey(hash_state1 + 32, k128[1]);
+
+	__m512i k0[10], k1[10];
+	for (int i = 0; i < 10; ++i)
+	{
+		k0[i] = _mm512_broadcast_i32x4(k128[0][i]);
+		k1[i] = _mm512_broadcast_i32x4(k128[1][i]);
+	}
+
+	__m512i* text0 = (__m512i*) (hash_state0 + 64);
+	__m512i* text1 = (__m512i*) (hash_state1 + 64);
+	__m512i x0 = _mm512_loadu_si512(text0 + 0);
+	__m512i x1 = _mm512_loadu_si512(text0 + 1);
+	__m512i y0 = _mm512_loadu_si512(text1 + 0);
+	__m512i y1 = _mm512_loadu_si512(text1 + 1);
+
+	const __m512i* p0 = (const __m512i*) long_state0;
+	const __m512i* p1 = (const __m512i*) long_state1;
+	for (const __m512i* e = (const __m512i*) (long_state0 + MEMORY); p0 < e; p0 += 2, p1 += 2)
+	{
+		_mm_prefetch((const char*) p0 + IMPLODE_PREFETCH_DISTANCE, _MM_HINT_T0);
+		_mm_prefetch((const char*) p0 + IMPLODE_PREFETCH_DISTANCE + 64, _MM_HINT_T0);
+		_mm_prefetch((const char*) p1 + IMPLODE_PREFETCH_DISTANCE, _MM_HINT_T0);
+		_mm_prefetch((const char*) p1 + IMPLODE_PREFETCH_DISTANCE + 64, _MM_HINT_T0);
+
+		x0 = _mm512_xor_si512(x0, _mm512_loadu_si512(p0 + 0));
+		x1 = _mm512_xor_si512(x1, _mm512_loadu_si512(p0 + 1));
+		y0 = _mm512_xor_si512(y0, _mm512_loadu_si512(p1 + 0));
+		y1 = _mm512_xor_si512(y1, _mm512_loadu_si512(p1 + 1));
+
+		for (int i = 0; i < 10; ++i)
+		{
+			x0 = _mm512_aesenc_epi128(x0, k0[i]);
+			x1 = _mm512_aesenc_epi128(x1, k0[i]);
+			y0 = _mm512_aesenc_epi128(y0, k1[i]);
+			y1 = _mm512_aesenc_epi128(y1, k1[i]);
+		}
+	}
+
+	_mm512_storeu_si512(text0 + 0, x0);
+	_mm512_storeu_si512(text0 + 1, x1);
+	_mm512_storeu_si512(text1 + 0, y0);
+	_mm512_storeu_si512(text1 + 1, y1);
+}
+
+TARGET_XSAVE static explode_impl detect_best_impl()
+{
+	int data[4];
+	__cpuidex(data, 0, 0);
+	if (data[0] < 7)
+	{
+		return EXPLODE_AESNI;
+	}
+
+	__cpuidex(data, 1, 0);
+	if (!(data[2] & (1 << 27)))
+	{
+		return EXPLODE_AESNI;
+	}
+	const uint64_t xcr0 = _xgetbv(0);
+
+	__cpuidex(data, 7, 0);
+	const bool avx2 = (data[1] & (1 << 5)) != 0;
+	const bool avx512f = (data[1] & (1 << 16)) != 0;
+	const bool vaes = (data[2] & (1 << 9)) != 0;
+
+	// OS must save YMM state for VAES-256 and opmask, ZMM_Hi256, Hi16_ZMM for VAES-512
+	if (vaes && avx512f && ((xcr0 & 0xE6) == 0xE6))
+	{
+		return EXPLODE_VAES512;
+	}
+	if (vaes && avx2 && ((xcr0 & 0x6) == 0x6))
+	{
+		return EXPLODE_VAES256;
+	}
+	return EXPLODE_AESNI;
+}
+
+static const explode_impl best_impl = detect_best_impl();
+
+explode_impl cn_explode_get_best_impl()
+{
+	return best_impl;
+}
+
+bool cn_explode_impl_supported(explode_impl impl)
+{
+	return impl <= best_impl;
+}
+
+const char* cn_explode_impl_name(explode_impl impl)
+{
+	switch (impl)
+	{
+	case EXPLODE_AESNI:
+		return "AES-NI";
+
+	case EXPLODE_VAES256:
+		return "VAES-256";
+
+	case EXPLODE_VAES512:
+		return "VAES-512";
+
+	default:
+		return "unknown";
+	}
+}
+
+void cn_explode_scratchpad(const uint8_t* hash_state, uint8_t* long_state, explode_impl impl)
+{
+	switch (impl)
+	{
+	case EXPLODE_VAES512:
+		explode_vaes512(hash_state, long_state);
+		break;
+
+	case EXPLODE_VAES256:
+		explode_vaes256(hash_state, long_state);
+		break;
+
+	default:
+		explode_aesni(hash_state, long_state);
+		break;
+	}
+}
+
+void cn_explode_scratchpad(const uint8_t* hash_state, uint8_t* long_state)
+{
+	cn_explode_scratchpad(hash_state, long_state, best_impl);
+}
+
+void cn_implode_scratchpad(const uint8_t* long_state, uint8_t* hash_state, explode_impl impl)
+{
+	switch (impl)
+	{
+	case EXPLODE_VAES512:
+		implode_vaes512(long_state, hash_state);
+		break;
+
+	case EXPLODE_VAES256:
+		implode_vaes256(long_state, hash_state);
+		break;
+
+	default:
+		implode_aesni(long_state, hash_state);
+		break;
+	}
+}
+
+void cn_implode_scratchpad(const uint8_t* long_state, uint8_t* hash_state)
+{
+	cn_implode_scratchpad(long_state, hash_state, best_impl);
+}
+
+void cn_explode_scratchpad_x2(const uint8_t* hash_state0, uint8_t* long_state0, const uint8_t* hash_state1, uint8_t* long_state1, explode_impl impl)
+{
+	switch (impl)
+	{
+	case EXPLODE_VAES512:
+		explode_vaes512_x2(hash_state0, long_state0, hash_state1, long_state1);
+		break;
+
+	case EXPLODE_VAES256:
+		explode_vaes256_x2(hash_state0, long_state0, hash_state1, long_state1);
+		break;
+
+	default:
+		explode_aesni(hash_state0, long_state0);
+		explode_aesni(hash_state1, long_state1);
+		break;
+	}
+}
+
+void cn_explode_scratchpad_x2(const uint8_t* hash_state0, uint8_t* long_state0, const uint8_t* hash_state1, uint8_t* long_state1)
+{
+	cn_explode_scratchpad_x2(hash_state0, long_state0, hash_state1, long_state1, best_impl);
+}
+
+void cn_implode_scratchpad_x2(const uint8_t* long_state0, uint8_t* hash_state0, const uint8_t* long_state1, uint8_t* hash_state1, explode_impl impl)
+{
+	switch (impl)
+	{
+	case EXPLODE_VAES512:
+		implode_vaes512_x2(long_state0, hash_state0, long_state1, hash_state1);
+		break;
+
+	case EXPLODE_VAES256:
+		implode_vaes256_x2(long_state0, hash_state0, long_state1, hash_state1);
+		break;
+
+	default:
+		implode_aesni(long_state0, hash_state0);
+		implode_aesni(long_state1, hash_state1);
+		break;
+	}
+}
+
+void cn_implode_scratchpad_x2(const uint8_t* long_state0, uint8_t* hash_state0, const uint8_t* long_state1, uint8_t* hash_state1)
+{
+	cn_implode_scratchpad_x2(long_state0, hash_state0, long_state1, hash_state1, best_impl);
+}
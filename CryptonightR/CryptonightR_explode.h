@@ -0,0 +1,42 @@
+#pragma once
+
+#include "definitions.h"
+
+// Scratchpad initialization (explode) from the Keccak state and folding it back (implode) after the main loop
+//
+// 10 round keys are expanded from 32 bytes of hash_state (first 10 round keys of AES-256 key schedule),
+// hash_state[0..31] for explode and hash_state[32..63] for implode. hash_state[64..191] is 8 blocks of text.
+//
+// Explode: every 128-byte chunk of the scratchpad is the text after 10 AES rounds, then it becomes the text
+// for the next chunk.
+// Implode: every 128-byte chunk is XORed into the text, then 10 AES rounds. Text is written back to hash_state.
+//
+// 8 blocks are 8 independent dependency chains, so all of them are always in flight:
+// AES-NI: 8 XMM registers, VAES-256: 4 YMM registers, VAES-512: 2 ZMM registers.
+
+enum explode_impl
+{
+	EXPLODE_AESNI,
+	EXPLODE_VAES256,
+	EXPLODE_VAES512,
+};
+
+// Fastest implementation this CPU supports
+explode_impl cn_explode_get_best_impl();
+
+bool cn_explode_impl_supported(explode_impl impl);
+const char* cn_explode_impl_name(explode_impl impl);
+
+// Writes MEMORY bytes to long_state, it must be 16-byte aligned
+void cn_explode_scratchpad(const uint8_t* hash_state, uint8_t* long_state, explode_impl impl);
+void cn_explode_scratchpad(const uint8_t* hash_state, uint8_t* long_state);
+
+// Reads MEMORY bytes from long_state (16-byte aligned) and updates hash_state[64..191]
+void cn_implode_scratchpad(const uint8_t* long_state, uint8_t* hash_state, explode_impl impl);
+void cn_implode_scratchpad(const uint8_t* long_state, uint8_t* hash_state);
+
+// Two hashes interleaved, VAES paths get twice as many independent blocks in flight
+void cn_explode_scratchpad_x2(const uint8_t* hash_state0, uint8_t* long_state0, const uint8_t* hash_state1, uint8_t* long_state1, explode_impl impl);
+void cn_explode_scratchpad_x2(const uint8_t* hash_state0, uint8_t* long_state0, const uint8_t* hash_state1, uint8_t* long_state1);
+void cn_implode_scratchpad_x2(const uint8_t* long_state0, uint8_t* hash_state0, const uint8_t* long_state1, uint8_t* hash_state1, explode_impl impl);
+void cn_implode_scratchpad_x2(const uint8_t* long_state0, uint8_t* hash_state0, const uint8_t* long_state1, uint8_t* hash_state1);
@@ -1,5 +1,6 @@
 #include <stdlib.h>
 #include <stdint.h>
+#include <string.h>
 #include <chrono>
 #include <iostream>
 #include <iomanip>
@@ -8,7 +9,17 @@
 #include "definitions.h"
 
 #include "CryptonightR_template.h"
+#include "CryptonightR_encoder.h"
+#include "CryptonightR_scheduler.h"
+#include "CryptonightR_prefetch.h"
+#include "CryptonightR_verifier.h"
+#include "CryptonightR_benchmark.h"
+#include "CryptonightR_sweep.h"
+#include "CryptonightR_analyzer.h"
+#include "CryptonightR_height_check.h"
+#include "CryptonightR_hash.h"
 
+#if DUMP_SOURCE_CODE
 // Registers to use in generated x86-64 code
 static const char* reg32[8] = {
 	"ebx", "esi", "edi", "ebp",
@@ -19,29 +30,81 @@ static const char* reg64[8] = {
 	"rbx", "rsi", "rdi", "rbp",
 	"rsp", "r15", "rax", "rdx"
 };
+#endif
 
-int compile_code(const V4_Instruction* code, std::vector<uint8_t>& machine_code)
+static const v4_x86_table v4_x86_encodings = make_v4_x86_table(v4_template_regs);
+
+// Appends random math program to machine_code, returns number of instructions
+static inline int insert_instructions(const V4_Instruction* code, std::vector<uint8_t>& machine_code)
 {
 	int num_insts = 0;
-	machine_code.clear();
-	machine_code.insert(machine_code.end(), (const uint8_t*) CryptonightR_template_part1, (const uint8_t*) CryptonightR_template_part2);
+	while (code[num_insts].opcode != RET)
+	{
+		++num_insts;
+	}
+
+	const size_t pos = machine_code.size();
+	machine_code.resize(pos + num_insts * V4_X86_MAX_INST_SIZE);
+	uint8_t* p = machine_code.data() + pos;
+
+	// rcx keeps the last rotation count, so "mov rcx, src" can be skipped for the same src
+	uint32_t prev_rot_src = (uint32_t)(-1);
+
+	for (int i = 0; i < num_insts; ++i)
+	{
+		const V4_Instruction inst = code[i];
+		const v4_x86_code& x86 = v4_x86_encodings.code[inst.opcode][inst.dst_index][inst.src_index];
+
+		const uint32_t a = inst.dst_index;
+		const uint32_t b = inst.src_index;
+
+		if (x86.mov_size && (b != prev_rot_src))
+		{
+			memcpy(p, x86.mov_code, x86.mov_size);
+			p += x86.mov_size;
+			prev_rot_src = b;
+		}
+
+		if (a == prev_rot_src)
+		{
+			prev_rot_src = (uint32_t)(-1);
+		}
+
+		memcpy(p, x86.code, x86.size);
+		if (x86.imm_offset)
+		{
+			memcpy(p + x86.imm_offset, &inst.C, sizeof(uint32_t));
+#if RANDOM_MATH_64_BIT == 1
+			// ADD constant goes through rcx
+			prev_rot_src = (uint32_t)(-1);
+#endif
+		}
+		p += x86.size;
+	}
+
+	machine_code.resize(p - machine_code.data());
+	return num_insts;
+}
 
 #if DUMP_SOURCE_CODE
+static void dump_source_code(const V4_Instruction* code, const std::vector<uint8_t>& machine_code)
+{
 #define DUMP(x, ...) x << __VA_ARGS__
 
 	std::ofstream f("random_math.inl");
 	std::ofstream f_double("random_math_double.inl");
+	std::ofstream f_quad("random_math_quad.inl");
 	std::ofstream f_asm("random_math.inc");
 	DUMP(f, "// Auto-generated file, do not edit\n\n");
 	DUMP(f_double, "// Auto-generated file, do not edit\n\n");
+	DUMP(f_quad, "// Auto-generated file, do not edit\n\n");
 	DUMP(f_asm, "; Auto-generated file, do not edit\n\n");
 	DUMP(f, "FORCEINLINE void random_math(v4_reg& r0, v4_reg& r1, v4_reg& r2, v4_reg& r3, const v4_reg r4, const v4_reg r5, const v4_reg r6, const v4_reg r7)\n");
 	DUMP(f, "{\n");
 	DUMP(f_double, "FORCEINLINE void random_math_double(__m128i& r0, __m128i& r1, __m128i& r2, __m128i& r3, const __m128i r4, const __m128i r5, const __m128i r6, const __m128i r7)\n");
 	DUMP(f_double, "{\n");
-#else
-#define DUMP(x, ...)
-#endif
+	DUMP(f_quad, "FORCEINLINE void random_math_quad(__m256i& r0, __m256i& r1, __m256i& r2, __m256i& r3, const __m256i r4, const __m256i r5, const __m256i r6, const __m256i r7)\n");
+	DUMP(f_quad, "{\n");
 
 	uint32_t prev_rot_src = (uint32_t)(-1);
 
@@ -51,7 +114,7 @@ int compile_code(const V4_Instruction* code, std::vector<uint8_t>& machine_code)
 #define reg reg32
 #endif
 
-	for (int i = 0;; ++i, ++num_insts)
+	for (int i = 0;; ++i)
 	{
 		const V4_Instruction inst = code[i];
 		if (inst.opcode == RET)
@@ -59,19 +122,15 @@ int compile_code(const V4_Instruction* code, std::vector<uint8_t>& machine_code)
 			break;
 		}
 
-		const uint8_t opcode = (inst.opcode == MUL) ? inst.opcode : (inst.opcode + 2);
-		const uint8_t dst_index = inst.dst_index;
-		const uint8_t src_index = inst.src_index;
-
 		const uint32_t a = inst.dst_index;
 		const uint32_t b = inst.src_index;
-		const uint8_t c = opcode | (dst_index << V4_OPCODE_BITS) | (src_index << (V4_OPCODE_BITS + V4_DST_INDEX_BITS));
 
 		switch (inst.opcode)
 		{
 		case MUL:
 			DUMP(f, "\tr" << a << " *= " << 'r' << b << ";\t");
 			DUMP(f_double, "\tr" << a << " = _mm_mul_epu32(r" << a << ", r" << b << ");\t");
+			DUMP(f_quad, "\tr" << a << " = _mm256_mul_epu32(r" << a << ", r" << b << ");\t");
 			DUMP(f_asm, "\timul\t" << reg64[a] << ", " << reg64[b]);
 			break;
 
@@ -79,6 +138,7 @@ int compile_code(const V4_Instruction* code, std::vector<uint8_t>& machine_code)
 			{
 				DUMP(f, "\tr" << a << " += " << 'r' << b << " + ");
 				DUMP(f_double, "\tr" << a << " = _mm_add_epi32(_mm_add_epi32(r" << a << ", r" << b << "), _mm_shuffle_epi32(_mm_cvtsi32_si128(" << static_cast<int32_t>(inst.C) << "), _MM_SHUFFLE(1, 0, 1, 0)));\t");
+				DUMP(f_quad, "\tr" << a << " = _mm256_add_epi32(_mm256_add_epi32(r" << a << ", r" << b << "), _mm256_set1_epi64x(" << inst.C << "U));\t");
 				DUMP(f_asm, "\tadd\t" << reg64[a] << ", " << reg64[b] << "\n");
 #if RANDOM_MATH_64_BIT == 1
                 DUMP(f_asm, "\tmov\tecx, " << inst.C << "\n");
@@ -94,6 +154,7 @@ int compile_code(const V4_Instruction* code, std::vector<uint8_t>& machine_code)
 		case SUB:
 			DUMP(f, "\tr" << a << " -= " << 'r' << b << ";\t");
 			DUMP(f_double, "\tr" << a << " = _mm_sub_epi32(r" << a << ", r" << b << ");\t");
+			DUMP(f_quad, "\tr" << a << " = _mm256_sub_epi32(r" << a << ", r" << b << ");\t");
 			DUMP(f_asm, "\tsub\t" << reg64[a] << ", " << reg64[b]);
 			break;
 
@@ -106,6 +167,11 @@ int compile_code(const V4_Instruction* code, std::vector<uint8_t>& machine_code)
 \t\tconst uint32_t c[2] = { _mm_cvtsi128_si32(r" << b << "), _mm_extract_epi32(r" << b << ", 2) };\n\
 \t\tconst uint32_t d[2] = { _mm_cvtsi128_si32(r" << a << "), _mm_extract_epi32(r" << a << ", 2) };\n\
 \t\tr" << a << " = _mm_insert_epi32(_mm_cvtsi32_si128(_rotr(d[0], c[0])), _rotr(d[1], c[1]), 2);\n\
+\t}");
+			// AVX2 has no 32-bit rotations, so they are done with variable shifts (shift by 32 gives 0)
+			DUMP(f_quad, "\t{\n\
+\t\tconst __m256i c = _mm256_and_si256(r" << b << ", _mm256_set1_epi32(31));\n\
+\t\tr" << a << " = _mm256_or_si256(_mm256_srlv_epi32(r" << a << ", c), _mm256_sllv_epi32(r" << a << ", _mm256_sub_epi32(_mm256_set1_epi32(32), c)));\n\
 \t}");
 #endif
 
@@ -113,10 +179,6 @@ int compile_code(const V4_Instruction* code, std::vector<uint8_t>& machine_code)
 			{
 				DUMP(f_asm, "\tmov\trcx, " << reg64[b] << "\n");
 				prev_rot_src = b;
-
-				const uint8_t* p1 = (const uint8_t*)instructions_mov[c];
-				const uint8_t* p2 = (const uint8_t*)instructions_mov[c + 1];
-				machine_code.insert(machine_code.end(), p1, p2);
 			}
 			DUMP(f_asm, "\tror\t" << reg[a] << ", cl");
 			break;
@@ -130,6 +192,10 @@ int compile_code(const V4_Instruction* code, std::vector<uint8_t>& machine_code)
 \t\tconst uint32_t c[2] = { _mm_cvtsi128_si32(r" << b << "), _mm_extract_epi32(r" << b << ", 2) };\n\
 \t\tconst uint32_t d[2] = { _mm_cvtsi128_si32(r" << a << "), _mm_extract_epi32(r" << a << ", 2) };\n\
 \t\tr" << a << " = _mm_insert_epi32(_mm_cvtsi32_si128(_rotl(d[0], c[0])), _rotl(d[1], c[1]), 2);\n\
+\t}");
+			DUMP(f_quad, "\t{\n\
+\t\tconst __m256i c = _mm256_and_si256(r" << b << ", _mm256_set1_epi32(31));\n\
+\t\tr" << a << " = _mm256_or_si256(_mm256_sllv_epi32(r" << a << ", c), _mm256_srlv_epi32(r" << a << ", _mm256_sub_epi32(_mm256_set1_epi32(32), c)));\n\
 \t}");
 #endif
 
@@ -137,10 +203,6 @@ int compile_code(const V4_Instruction* code, std::vector<uint8_t>& machine_code)
 			{
 				DUMP(f_asm, "\tmov\trcx, " << reg64[b] << "\n");
 				prev_rot_src = b;
-
-				const uint8_t* p1 = (const uint8_t*)instructions_mov[c];
-				const uint8_t* p2 = (const uint8_t*)instructions_mov[c + 1];
-				machine_code.insert(machine_code.end(), p1, p2);
 			}
 			DUMP(f_asm, "\trol\t" << reg[a] << ", cl");
 			break;
@@ -148,275 +210,248 @@ int compile_code(const V4_Instruction* code, std::vector<uint8_t>& machine_code)
 		case XOR:
 			DUMP(f, "\tr" << a << " ^= " << 'r' << b << ";\t");
 			DUMP(f_double, "\tr" << a << " = _mm_xor_si128(r" << a << ", r" << b << ");\t");
+			DUMP(f_quad, "\tr" << a << " = _mm256_xor_si256(r" << a << ", r" << b << ");\t");
 			DUMP(f_asm, "\txor\t" << reg64[a] << ", " << reg64[b]);
 			break;
 		}
 
 		DUMP(f, "\n");
 		DUMP(f_double, "\n");
+		DUMP(f_quad, "\n");
 		DUMP(f_asm, "\n");
 
 		if (a == prev_rot_src)
 		{
 			prev_rot_src = (uint32_t)(-1);
 		}
-
-		const uint8_t* p1 = (const uint8_t*)instructions[c];
-		const uint8_t* p2 = (const uint8_t*)instructions[c + 1];
-		machine_code.insert(machine_code.end(), p1, p2);
-		if (inst.opcode == ADD)
-		{
-            uint32_t* p = reinterpret_cast<uint32_t*>(machine_code.data() + machine_code.size() - sizeof(uint32_t)
-#if RANDOM_MATH_64_BIT == 1
-                - 3
-#endif
-            );
-            *p = inst.C;
-        }
 	}
 
-	machine_code.insert(machine_code.end(), (const uint8_t*) CryptonightR_template_part2, (const uint8_t*) CryptonightR_template_part3);
+#undef reg
+#undef DUMP
 
-	*(int*)(machine_code.data() + machine_code.size() - 4) = static_cast<int>((((const uint8_t*)CryptonightR_template_mainloop) - ((const uint8_t*)CryptonightR_template_part1)) - machine_code.size());
-
-	machine_code.insert(machine_code.end(), (const uint8_t*) CryptonightR_template_part3, (const uint8_t*) CryptonightR_template_end);
-
-#if DUMP_SOURCE_CODE
 	f << "}\n";
 	f_double << "}\n";
+	f_quad << "}\n";
 	f.close();
 	f_double.close();
+	f_quad.close();
 	f_asm.close();
 
 	std::ofstream f_bin("random_math.bin", std::ios::out | std::ios::binary);
 	f_bin.write((const char*)machine_code.data(), machine_code.size());
 	f_bin.close();
-#endif
-
-	return num_insts;
 }
+#endif
 
-static inline void insert_instructions(const V4_Instruction* code, std::vector<uint8_t>& machine_code)
+int compile_code(const V4_Instruction* code, std::vector<uint8_t>& machine_code)
 {
-    uint32_t prev_rot_src = (uint32_t)(-1);
+	const v4_prefetch prefetch = v4_get_prefetch();
 
-    for (int i = 0;; ++i)
-    {
-        const V4_Instruction inst = code[i];
-		if (inst.opcode == RET)
-		{
-			break;
-		}
+	machine_code.clear();
+	machine_code.insert(machine_code.end(), (const uint8_t*) CryptonightR_template_part1, (const uint8_t*) CryptonightR_template_prefetch_line);
+	v4_emit_prefetch(prefetch, V4_PREFETCH_LINE, machine_code);
+	machine_code.insert(machine_code.end(), (const uint8_t*) CryptonightR_template_prefetch_line, (const uint8_t*) CryptonightR_template_part2);
 
-        const uint8_t opcode = (inst.opcode == MUL) ? inst.opcode : (inst.opcode + 2);
-
-        const uint32_t a = inst.dst_index;
-        const uint32_t b = inst.src_index;
-        const uint8_t c = opcode | (inst.dst_index << V4_OPCODE_BITS) | (inst.src_index << (V4_OPCODE_BITS + V4_DST_INDEX_BITS));
-
-        switch (inst.opcode)
-        {
-        case ROR:
-        case ROL:
-            if (b != prev_rot_src)
-            {
-                prev_rot_src = b;
-
-                const uint8_t* p1 = (const uint8_t*) instructions_mov[c];
-                const uint8_t* p2 = (const uint8_t*) instructions_mov[c + 1];
-                machine_code.insert(machine_code.end(), p1, p2);
-            }
-            break;
-        }
-
-        if (a == prev_rot_src)
-        {
-            prev_rot_src = (uint32_t)(-1);
-        }
-
-        const uint8_t* p1 = (const uint8_t*)instructions[c];
-        const uint8_t* p2 = (const uint8_t*)instructions[c + 1];
-        machine_code.insert(machine_code.end(), p1, p2);
-        if (inst.opcode == ADD)
-        {
-            uint32_t* p = reinterpret_cast<uint32_t*>(machine_code.data() + machine_code.size() - sizeof(uint32_t)
-#if RANDOM_MATH_64_BIT == 1
-                - 3
-#endif
-                );
-            *p = inst.C;
-#if RANDOM_MATH_64_BIT == 1
-            prev_rot_src = (uint32_t)(-1);
+	V4_Instruction scheduled_code[NUM_INSTRUCTIONS * 2];
+	v4_schedule(code, scheduled_code, v4_get_scheduler_uarch());
+
+	const int num_insts = insert_instructions(scheduled_code, machine_code);
+
+	machine_code.insert(machine_code.end(), (const uint8_t*) CryptonightR_template_part2, (const uint8_t*) CryptonightR_template_prefetch_next);
+	v4_emit_prefetch(prefetch, V4_PREFETCH_NEXT, machine_code);
+	machine_code.insert(machine_code.end(), (const uint8_t*) CryptonightR_template_prefetch_next, (const uint8_t*) CryptonightR_template_part3);
+
+	*(int*)(machine_code.data() + machine_code.size() - 4) = static_cast<int>((((const uint8_t*)CryptonightR_template_mainloop) - ((const uint8_t*)CryptonightR_template_part1)) - machine_code.size());
+
+	machine_code.insert(machine_code.end(), (const uint8_t*) CryptonightR_template_part3, (const uint8_t*) CryptonightR_template_end);
+
+#if DUMP_SOURCE_CODE
+	dump_source_code(code, machine_code);
 #endif
-        }
-    }
+
+	return num_insts;
 }
 
 void compile_code_double(const V4_Instruction* code, std::vector<uint8_t>& machine_code)
 {
+    V4_Instruction scheduled_code[NUM_INSTRUCTIONS * 2];
+    v4_schedule(code, scheduled_code, v4_get_scheduler_uarch());
+
     machine_code.clear();
     machine_code.insert(machine_code.end(), (const uint8_t*)CryptonightR_template_double_part1, (const uint8_t*)CryptonightR_template_double_part2);
-    insert_instructions(code, machine_code);
+    insert_instructions(scheduled_code, machine_code);
     machine_code.insert(machine_code.end(), (const uint8_t*)CryptonightR_template_double_part2, (const uint8_t*)CryptonightR_template_double_part3);
-    insert_instructions(code, machine_code);
+    insert_instructions(scheduled_code, machine_code);
     machine_code.insert(machine_code.end(), (const uint8_t*)CryptonightR_template_double_part3, (const uint8_t*)CryptonightR_template_double_part4);
     *(int*)(machine_code.data() + machine_code.size() - 4) = static_cast<int>((((const uint8_t*)CryptonightR_template_double_mainloop) - ((const uint8_t*)CryptonightR_template_double_part1)) - machine_code.size());
     machine_code.insert(machine_code.end(), (const uint8_t*)CryptonightR_template_double_part4, (const uint8_t*)CryptonightR_template_double_end);
 }
 
-static void generate_asm_template()
-{
-	std::ofstream f("CryptonightR_template.h");
-	f << R"===(// Auto-generated file, do not edit
-
-extern "C"
+// Generated code takes an array of ways pointers to cryptonight_ctx (mainloop_multi_func)
+void compile_code_multi(const V4_Instruction* code, uint32_t ways, std::vector<uint8_t>& machine_code)
 {
-	void CryptonightR_template_part1();
-	void CryptonightR_template_mainloop();
-	void CryptonightR_template_part2();
-	void CryptonightR_template_part3();
-	void CryptonightR_template_end();
-	void CryptonightR_template_double_part1();
-	void CryptonightR_template_double_mainloop();
-	void CryptonightR_template_double_part2();
-	void CryptonightR_template_double_part3();
-	void CryptonightR_template_double_part4();
-	void CryptonightR_template_double_end();
-)===";
-
-	for (int i = 0; i <= 256; ++i)
-		f << "\tvoid CryptonightR_instruction" << i << "();\n";
-
-	for (int i = 0; i <= 256; ++i)
-		f << "\tvoid CryptonightR_instruction_mov" << i << "();\n";
-
-	f << R"===(}
-
-const void* instructions[257] = {
-)===";
-
-	for (int i = 0; i <= 256; ++i)
-		f << "\tCryptonightR_instruction" << i << ",\n";
+	V4_Instruction scheduled_code[NUM_INSTRUCTIONS * 2];
+	v4_schedule(code, scheduled_code, v4_get_scheduler_uarch());
 
-	f << "};\n\n";
-
-	f << "const void* instructions_mov[257] = {\n";
-
-	for (int i = 0; i <= 256; ++i)
-		f << "\tCryptonightR_instruction_mov" << i << ",\n";
-
-	f << "};\n";
-	f.close();
-
-	std::ofstream f_asm("CryptonightR_template.asm");
-	f_asm << R"===(; Auto-generated file, do not edit
-
-_TEXT_CN_TEMPLATE SEGMENT PAGE READ EXECUTE
-)===";
-
-	for (int i = 0; i <= 256; ++i)
-		f_asm << "PUBLIC CryptonightR_instruction" << i << "\n";
-
-	for (int i = 0; i <= 256; ++i)
-		f_asm << "PUBLIC CryptonightR_instruction_mov" << i << "\n";
+	machine_code.clear();
+	machine_code.insert(machine_code.end(), (const uint8_t*)CryptonightR_template_multi_part1, (const uint8_t*)CryptonightR_template_multi_lane_init);
+	for (uint32_t i = 0; i < ways; ++i)
+	{
+		machine_code.insert(machine_code.end(), (const uint8_t*)CryptonightR_template_multi_lane_init, (const uint8_t*)CryptonightR_template_multi_mainloop);
+	}
 
-	f_asm << "\nINCLUDE CryptonightR_template.inc\n\n";
+	const size_t mainloop_offset = machine_code.size();
+	machine_code.insert(machine_code.end(), (const uint8_t*)CryptonightR_template_multi_mainloop, (const uint8_t*)CryptonightR_template_multi_lane_loads);
 
-#if RANDOM_MATH_64_BIT == 1
-#define reg reg64
-#else
-#define reg reg32
-#endif
+	// Loads and AES rounds of all lanes first, then random math of all lanes
+	for (uint32_t i = 0; i < ways; ++i)
+	{
+		machine_code.insert(machine_code.end(), (const uint8_t*)CryptonightR_template_multi_lane_loads, (const uint8_t*)CryptonightR_template_multi_math);
+	}
+	machine_code.insert(machine_code.end(), (const uint8_t*)CryptonightR_template_multi_math, (const uint8_t*)CryptonightR_template_multi_lane_part1);
 
-	for (int i = 0; i <= 256; ++i)
+	for (uint32_t i = 0; i < ways; ++i)
 	{
-		f_asm << "CryptonightR_instruction" << i << ":\n";
+		machine_code.insert(machine_code.end(), (const uint8_t*)CryptonightR_template_multi_lane_part1, (const uint8_t*)CryptonightR_template_multi_lane_part2);
+		insert_instructions(scheduled_code, machine_code);
+		machine_code.insert(machine_code.end(), (const uint8_t*)CryptonightR_template_multi_lane_part2, (const uint8_t*)CryptonightR_template_multi_part2);
+	}
 
-		const uint8_t c = i;
+	machine_code.insert(machine_code.end(), (const uint8_t*)CryptonightR_template_multi_part2, (const uint8_t*)CryptonightR_template_multi_part3);
+	*(int*)(machine_code.data() + machine_code.size() - 4) = static_cast<int>(mainloop_offset - machine_code.size());
+	machine_code.insert(machine_code.end(), (const uint8_t*)CryptonightR_template_multi_part3, (const uint8_t*)CryptonightR_template_multi_end);
+}
 
-		uint8_t opcode = c & ((1 << V4_OPCODE_BITS) - 1);
-		opcode = (opcode <= 2) ? MUL : (opcode - 2);
+bool compile_kernel(const V4_Instruction* code, uint32_t ways, std::vector<uint8_t>& machine_code)
+{
+	switch (ways)
+	{
+	case 1:
+		compile_code(code, machine_code);
+		return true;
 
-		const uint32_t a = (c >> V4_OPCODE_BITS) & ((1 << V4_DST_INDEX_BITS) - 1);
-		const uint32_t b = (c >> (V4_OPCODE_BITS + V4_DST_INDEX_BITS)) & ((1 << V4_SRC_INDEX_BITS) - 1);
+	case 2:
+		compile_code_double(code, machine_code);
+		return true;
 
-		switch (opcode)
+	default:
+		if ((ways < 3) || (ways > TEMPLATE_MULTI_MAX_WAYS))
 		{
-		case MUL:
-			f_asm << "\timul\t" << reg64[a] << ", " << reg64[b];
-			break;
-
-		case ADD:
-            f_asm << "\tadd\t" << reg64[a] << ", " << reg64[b] << "\n";
-#if RANDOM_MATH_64_BIT == 1
-            f_asm << "\tmov ecx, 80000000h\n";
-            f_asm << "\tadd\t" << reg64[a] << ", rcx";
-#else
-			f_asm << "\tadd\t" << reg64[a] << ", 80000000h";
-#endif
-			break;
+			return false;
+		}
+		compile_code_multi(code, ways, machine_code);
+		return true;
+	}
+}
 
-		case SUB:
-			f_asm << "\tsub\t" << reg64[a] << ", " << reg64[b];
-			break;
+extern int CryptonightR_test(const benchmark_options& options);
 
-		case ROR:
-			f_asm << "\tror\t" << reg[a] << ", cl";
-			break;
+// Removes "--prefetch <points>[:<hint>]" from the command line, it changes code from compile_code in every mode
+static bool parse_prefetch_arg(int& argc, char** argv)
+{
+	for (int i = 1; i < argc; ++i)
+	{
+		if (strcmp(argv[i], "--prefetch") != 0)
+		{
+			continue;
+		}
 
-		case ROL:
-			f_asm << "\trol\t" << reg[a] << ", cl";
-			break;
+		v4_prefetch prefetch;
+		if ((i + 1 >= argc) || !v4_parse_prefetch(argv[i + 1], prefetch))
+		{
+			std::cerr << "--prefetch must be none, line, next or both, optionally followed by :t0, :t1, :t2, :nta or :w" << std::endl;
+			return false;
+		}
+		v4_set_prefetch(prefetch);
 
-		case XOR:
-			f_asm << "\txor\t" << reg64[a] << ", " << reg64[b];
-			break;
+		for (int j = i + 2; j <= argc; ++j)
+		{
+			argv[j - 2] = argv[j];
 		}
-		f_asm << "\n";
+		argc -= 2;
+		--i;
 	}
+	return true;
+}
 
-	for (int i = 0; i <= 256; ++i)
+// Removes "--mainloop <generated|interpreter|reference>" from the command line, it works in every mode
+static bool parse_mainloop_arg(int& argc, char** argv)
+{
+	for (int i = 1; i < argc; ++i)
 	{
-		f_asm << "CryptonightR_instruction_mov" << i << ":\n";
-
-		const uint8_t c = i;
-
-		uint8_t opcode = c & ((1 << V4_OPCODE_BITS) - 1);
-		opcode = (opcode <= 2) ? MUL : (opcode - 2);
+		if (strcmp(argv[i], "--mainloop") != 0)
+		{
+			continue;
+		}
 
-		const uint32_t b = (c >> (V4_OPCODE_BITS + V4_DST_INDEX_BITS)) & ((1 << V4_SRC_INDEX_BITS) - 1);
+		cn_r_mainloop_kind kind;
+		if ((i + 1 >= argc) || !cn_r_parse_mainloop_kind(argv[i + 1], kind))
+		{
+			std::cerr << "--mainloop must be generated, interpreter or reference" << std::endl;
+			return false;
+		}
+		cn_r_set_mainloop_kind(kind);
 
-		switch (opcode)
+		for (int j = i + 2; j <= argc; ++j)
 		{
-		case ROR:
-		case ROL:
-			f_asm << "\tmov\trcx, " << reg64[b];
-			break;
+			argv[j - 2] = argv[j];
 		}
-		f_asm << "\n";
+		argc -= 2;
+		--i;
 	}
-
-	f_asm << R"===(_TEXT_CN_TEMPLATE ENDS
-END
-)===";
-
-	f_asm.close();
+	return true;
 }
 
-extern int CryptonightR_test();
-
-int main()
+int main(int argc, char** argv)
 {
-#if DUMP_SOURCE_CODE
-	generate_asm_template();
+	if (!parse_mainloop_arg(argc, argv) || !parse_prefetch_arg(argc, argv))
+	{
+		return 1;
+	}
+
+	if ((argc > 1) && (strcmp(argv[1], "--verifier") == 0))
+	{
+		return verifier_main(argc, argv);
+	}
+	if ((argc > 1) && (strcmp(argv[1], "--verifier-load") == 0))
+	{
+		return verifier_load_main(argc, argv);
+	}
+	if ((argc > 1) && (strcmp(argv[1], "--sweep") == 0))
+	{
+		return sweep_main(argc, argv);
+	}
+	if ((argc > 1) && (strcmp(argv[1], "--analyze") == 0))
+	{
+		return analyzer_main(argc, argv);
+	}
+	if ((argc > 1) && (strcmp(argv[1], "--check-heights") == 0))
+	{
+		return height_check_main(argc, argv);
+	}
 
+#if DUMP_SOURCE_CODE
 	V4_Instruction code[NUM_INSTRUCTIONS * 2];
 	v4_random_math_init(code, RND_SEED);
 
+	// random_math.inl and random_math.inc are in generator order, random_math.bin must have the same instructions.
+	// Scheduled order depends on the CPU, so it can't be in checked-in files.
+	// Template parts of random_math.bin are assembled from CryptonightR_template.asm, the checked-in file has MASM encodings.
+	v4_set_scheduler_uarch(V4_UARCH_NONE);
+	v4_set_prefetch({ V4_PREFETCH_NONE, V4_PREFETCH_T0 });
+
 	std::vector<uint8_t> machine_code;
 	compile_code(code, machine_code);
 	return 0;
 #else
-	return CryptonightR_test();
+	benchmark_options options = benchmark_default_options();
+	if (!benchmark_parse_args(argc, argv, options))
+	{
+		std::cerr << "Usage: " << argv[0] << " [--mainloop <generated|interpreter|reference>] [--prefetch <none|line|next|both>[:<t0|t1|t2|nta|w>]] "
+			"[--benchmark-duration <seconds>] [--benchmark-warmup <ms>] [--benchmark-samples <n>] [--benchmark-cpu <cpu|none>] "
+			"[--benchmark-counters <none|selected|all>] [--benchmark-filter <substring>] [--benchmark-json <path>]" << std::endl;
+		return 1;
+	}
+	return CryptonightR_test(options);
 #endif
 }
@@ -0,0 +1,478 @@
+#include "CryptonightR_hash.h"
+#include "CryptonightR_keccak.h"
+#include "CryptonightR_explode.h"
+#include "CryptonightR_kernel_cache.h"
+#include "CryptonightR_numa.h"
+#include "CryptonightR_arena.h"
+#include "CryptonightR_interpreter.h"
+#include "CryptonightR_static.h"
+#include "CryptonightR_benchmark.h"
+#include <atomic>
+#include <mutex>
+#include <vector>
+#include <algorithm>
+#include <cstring>
+#include <cstdio>
+
+extern void CryptonightR_ref(cryptonight_ctx* ctx0, const V4_Instruction* code);
+
+enum
+{
+	// Current height, previous heights kept for orphan races and background compiled next heights
+	HASH_KEEP_BEHIND = 2,
+	HASH_CACHE_SLOTS = HASH_KEEP_BEHIND + 1 + KERNEL_CACHE_LOOKAHEAD,
+};
+
+static std::atomic<cn_r_mainloop_kind> mainloop_kind(CN_R_MAINLOOP_GENERATED);
+
+void cn_r_set_mainloop_kind(cn_r_mainloop_kind kind)
+{
+	mainloop_kind.store(kind, std::memory_order_relaxed);
+}
+
+cn_r_mainloop_kind cn_r_get_mainloop_kind()
+{
+	return mainloop_kind.load(std::memory_order_relaxed);
+}
+
+static const char* const mainloop_kind_names[] = { "generated", "reference", "interpreter" };
+
+const char* cn_r_mainloop_kind_name(cn_r_mainloop_kind kind)
+{
+	switch (kind)
+	{
+	case CN_R_MAINLOOP_GENERATED: return "generated machine code";
+	case CN_R_MAINLOOP_CPP: return "C++ reference code";
+	case CN_R_MAINLOOP_INTERPRETER: return "threaded interpreter";
+	case CN_R_MAINLOOP_STATIC: return "compiled-in C++ kernel";
+	}
+	return "unknown";
+}
+
+bool cn_r_parse_mainloop_kind(const char* name, cn_r_mainloop_kind& kind)
+{
+	for (int i = 0; i < static_cast<int>(sizeof(mainloop_kind_names) / sizeof(mainloop_kind_names[0])); ++i)
+	{
+		if (strcmp(name, mainloop_kind_names[i]) == 0)
+		{
+			kind = static_cast<cn_r_mainloop_kind>(i);
+			return true;
+		}
+	}
+	return false;
+}
+
+static std::once_flag cache_once;
+static kernel_cache* cache = nullptr;
+
+// Highest height seen, background compilation follows it
+static std::atomic<uint64_t> cache_height(0);
+static std::atomic<bool> cache_height_set(false);
+
+static kernel_cache* get_cache(uint64_t height)
+{
+	std::call_once(cache_once, []() { cache = kernel_cache_create(HASH_CACHE_SLOTS, KERNEL_SINGLE, HASH_KEEP_BEHIND); });
+	if (!cache)
+	{
+		return nullptr;
+	}
+
+	// Old heights (orphaned blocks) don't move the window back
+	uint64_t h = cache_height.load(std::memory_order_relaxed);
+	if (!cache_height_set.load(std::memory_order_acquire) || (height > h))
+	{
+		static std::mutex height_mutex;
+		std::lock_guard<std::mutex> lock(height_mutex);
+
+		h = cache_height.load(std::memory_order_relaxed);
+		if (!cache_height_set.load(std::memory_order_relaxed) || (height > h))
+		{
+			kernel_cache_set_height(cache, height);
+			cache_height.store(height, std::memory_order_relaxed);
+			cache_height_set.store(true, std::memory_order_release);
+		}
+	}
+
+	return cache;
+}
+
+// Every thread has its own context on its own NUMA node, freed when the thread exits
+struct thread_ctx
+{
+	cryptonight_ctx* ctx = nullptr;
+
+	~thread_ctx()
+	{
+		numa_free_ctx(ctx);
+	}
+};
+
+static cryptonight_ctx* get_thread_ctx()
+{
+	static thread_local thread_ctx t;
+	if (!t.ctx)
+	{
+		t.ctx = numa_alloc_ctx(numa_get_current_node());
+	}
+	return t.ctx;
+}
+
+void cn_r_prepare(cryptonight_ctx* ctx, const uint8_t* input, uint32_t len)
+{
+	keccak1600(input, len, ctx->hash_state);
+	cn_explode_scratchpad(ctx->hash_state, ctx->long_state);
+}
+
+static void final_hash(cryptonight_ctx* ctx, uint8_t* hash)
+{
+	keccakf(*reinterpret_cast<uint64_t(*)[25]>(ctx->hash_state), KECCAK_ROUNDS);
+
+	static void (*const extra_hashes[4])(const void*, size_t, char*) = { hash_extra_blake, hash_extra_groestl, hash_extra_jh, hash_extra_skein };
+	extra_hashes[ctx->hash_state[0] & 3](ctx->hash_state, KECCAK_STATE_SIZE, (char*) hash);
+}
+
+void cn_r_finish(cryptonight_ctx* ctx, uint8_t* hash)
+{
+	cn_implode_scratchpad(ctx->long_state, ctx->hash_state);
+	final_hash(ctx, hash);
+}
+
+// Main loop without generated code, returns the kind which was used
+static cn_r_mainloop_kind main_loop_no_jit(cryptonight_ctx** ctx, uint32_t count, uint64_t height)
+{
+	V4_Instruction code[NUM_INSTRUCTIONS * 2];
+	v4_random_math_init(code, height);
+
+	if (cn_r_get_mainloop_kind() == CN_R_MAINLOOP_CPP)
+	{
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			CryptonightR_ref(ctx[i], code);
+		}
+		return CN_R_MAINLOOP_CPP;
+	}
+
+	const v4_static_kernel kernel = v4_get_static_kernel(height);
+	if (kernel)
+	{
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			kernel(ctx[i]);
+		}
+		return CN_R_MAINLOOP_STATIC;
+	}
+
+	v4_threaded_code threaded_code;
+	v4_threaded_compile(code, threaded_code);
+	for (uint32_t i = 0; i < count; ++i)
+	{
+		CryptonightR_interpreter(ctx[i], threaded_code);
+	}
+	return CN_R_MAINLOOP_INTERPRETER;
+}
+
+static cn_r_mainloop_kind main_loop(cryptonight_ctx* ctx, uint64_t height)
+{
+	kernel_cache* c = (cn_r_get_mainloop_kind() == CN_R_MAINLOOP_GENERATED) ? get_cache(height) : nullptr;
+	const kernel_cache_entry* kernel = c ? kernel_cache_acquire(c, height, 1) : nullptr;
+	if (kernel)
+	{
+		((mainloop_func) kernel->func)(ctx);
+		kernel_cache_release(c, kernel);
+		return CN_R_MAINLOOP_GENERATED;
+	}
+
+	return main_loop_no_jit(&ctx, 1, height);
+}
+
+bool cn_r_hash(const void* input, size_t len, uint64_t height, uint8_t* hash, cn_r_hash_times* times)
+{
+	cryptonight_ctx* ctx = get_thread_ctx();
+	if (!ctx)
+	{
+		return false;
+	}
+
+	const uint64_t t0 = __rdtsc();
+	keccak1600((const uint8_t*) input, len, ctx->hash_state);
+	const uint64_t t1 = __rdtsc();
+	cn_explode_scratchpad(ctx->hash_state, ctx->long_state);
+	const uint64_t t2 = __rdtsc();
+	const cn_r_mainloop_kind kind = main_loop(ctx, height);
+	const uint64_t t3 = __rdtsc();
+	cn_implode_scratchpad(ctx->long_state, ctx->hash_state);
+	const uint64_t t4 = __rdtsc();
+	final_hash(ctx, hash);
+	const uint64_t t5 = __rdtsc();
+
+	if (times)
+	{
+		times->keccak = t1 - t0;
+		times->explode = t2 - t1;
+		times->main_loop = t3 - t2;
+		times->implode = t4 - t3;
+		times->final_hash = t5 - t4;
+		times->mainloop_kind = kind;
+	}
+
+	return true;
+}
+
+bool cn_r_hash(const void* input, size_t len, uint64_t height, uint8_t* hash)
+{
+	return cn_r_hash(input, len, height, hash, nullptr);
+}
+
+struct cn_r_batch
+{
+	uint32_t ways;
+	scratchpad_arena* arena;
+	kernel_cache* cache;
+	uint64_t height;
+	bool height_set;
+	std::vector<uint32_t> order;
+};
+
+cn_r_batch* cn_r_batch_create(uint32_t ways, int node)
+{
+	if ((ways < 1) || (ways > KERNEL_CACHE_MAX_WAYS))
+	{
+		return nullptr;
+	}
+
+	// Groups smaller than ways (last inputs of a height) use smaller kernels
+	uint32_t ways_mask = 0;
+	for (uint32_t i = 1; i <= ways; ++i)
+	{
+		ways_mask |= 1U << i;
+	}
+
+	cn_r_batch* batch = new cn_r_batch();
+	batch->ways = ways;
+	batch->arena = arena_create(ways, node, ARENA_COLOR_PAGE);
+	batch->cache = (cn_r_get_mainloop_kind() == CN_R_MAINLOOP_GENERATED) ? kernel_cache_create_on_node(HASH_CACHE_SLOTS * ways, ways_mask, HASH_KEEP_BEHIND, node) : nullptr;
+	batch->height = 0;
+	batch->height_set = false;
+
+	// Without generated code the interpreter is used, but scratchpads are required
+	if (!batch->arena)
+	{
+		cn_r_batch_destroy(batch);
+		return nullptr;
+	}
+
+	return batch;
+}
+
+void cn_r_batch_destroy(cn_r_batch* batch)
+{
+	if (!batch)
+	{
+		return;
+	}
+
+	if (batch->cache)
+	{
+		kernel_cache_destroy(batch->cache);
+	}
+	arena_destroy(batch->arena);
+	delete batch;
+}
+
+static bool run_kernel(cn_r_batch* batch, uint64_t height, uint32_t ways, cryptonight_ctx** ctx)
+{
+	const kernel_cache_entry* kernel = batch->cache ? kernel_cache_acquire(batch->cache, height, ways) : nullptr;
+	if (!kernel)
+	{
+		return false;
+	}
+
+	switch (ways)
+	{
+	case 1:
+		((mainloop_func) kernel->func)(ctx[0]);
+		break;
+
+	case 2:
+		((mainloop_double_func) kernel->func)(ctx[0], ctx[1]);
+		break;
+
+	default:
+		((mainloop_multi_func) kernel->func)(ctx);
+		break;
+	}
+
+	kernel_cache_release(batch->cache, kernel);
+	return true;
+}
+
+// Inputs order[0..count) all have the same height
+static void hash_group(cn_r_batch* batch, const void* const* inputs, const size_t* lens, uint64_t height, uint8_t* outputs, const uint32_t* order, uint32_t count)
+{
+	cryptonight_ctx** ctx = arena_get_ctxs(batch->arena);
+
+	for (uint32_t i = 0; i < count; ++i)
+	{
+		keccak1600((const uint8_t*) inputs[order[i]], lens[order[i]], ctx[i]->hash_state);
+	}
+
+	for (uint32_t i = 0; i < count; i += 2)
+	{
+		if (i + 1 < count)
+		{
+			cn_explode_scratchpad_x2(ctx[i]->hash_state, ctx[i]->long_state, ctx[i + 1]->hash_state, ctx[i + 1]->long_state);
+		}
+		else
+		{
+			cn_explode_scratchpad(ctx[i]->hash_state, ctx[i]->long_state);
+		}
+	}
+
+	if (!run_kernel(batch, height, count, ctx))
+	{
+		main_loop_no_jit(ctx, count, height);
+	}
+
+	for (uint32_t i = 0; i < count; i += 2)
+	{
+		if (i + 1 < count)
+		{
+			cn_implode_scratchpad_x2(ctx[i]->long_state, ctx[i]->hash_state, ctx[i + 1]->long_state, ctx[i + 1]->hash_state);
+		}
+		else
+		{
+			cn_implode_scratchpad(ctx[i]->long_state, ctx[i]->hash_state);
+		}
+	}
+
+	for (uint32_t i = 0; i < count; ++i)
+	{
+		final_hash(ctx[i], outputs + order[i] * 32);
+	}
+}
+
+bool cn_r_hash_batch(cn_r_batch* batch, const void* const* inputs, const size_t* lens, const uint64_t* heights, uint8_t* outputs, uint32_t n)
+{
+	if (!batch)
+	{
+		return false;
+	}
+
+	// Same heights go together, original order is kept inside a height
+	std::vector<uint32_t>& order = batch->order;
+	order.resize(n);
+	for (uint32_t i = 0; i < n; ++i)
+	{
+		order[i] = i;
+	}
+	std::stable_sort(order.begin(), order.end(), [heights](uint32_t a, uint32_t b) { return heights[a] < heights[b]; });
+
+	// Background compilation follows the newest height, old heights are compiled on demand
+	if (batch->cache && (n > 0) && (!batch->height_set || (heights[order[n - 1]] > batch->height)))
+	{
+		batch->height = heights[order[n - 1]];
+		batch->height_set = true;
+		kernel_cache_set_height(batch->cache, batch->height);
+	}
+
+	for (uint32_t i = 0; i < n;)
+	{
+		const uint64_t height = heights[order[i]];
+		uint32_t count = 1;
+		while ((i + count < n) && (count < batch->ways) && (heights[order[i + count]] == height))
+		{
+			++count;
+		}
+
+		hash_group(batch, inputs, lens, height, outputs, order.data() + i, count);
+		i += count;
+	}
+
+	return true;
+}
+
+enum
+{
+	// Calls per width for the median, one call is too noisy to pick a width
+	BEST_WAYS_SAMPLES = 5,
+};
+
+static uint32_t measure_best_ways()
+{
+	// Quiet, on the calling thread's CPUs and without counters, the first call compiles the kernel
+	benchmark_options options = benchmark_default_options();
+	options.duration_ms = 0;
+	options.min_samples = BEST_WAYS_SAMPLES;
+	options.warmup_ms = 0;
+	options.cpu = BENCHMARK_CPU_NONE;
+	options.counters = BENCHMARK_COUNTERS_NONE;
+	options.quiet = true;
+	benchmark_registry* reg = benchmark_registry_create(options);
+
+	uint32_t best_ways = 1;
+	double best_hashrate = 0.0;
+
+	for (uint32_t ways = 1; ways <= KERNEL_CACHE_MAX_WAYS; ++ways)
+	{
+		cn_r_batch* batch = cn_r_batch_create(ways, numa_get_current_node());
+		if (!batch)
+		{
+			continue;
+		}
+
+		uint8_t inputs[KERNEL_CACHE_MAX_WAYS][76] = {};
+		const void* input_ptrs[KERNEL_CACHE_MAX_WAYS];
+		size_t lens[KERNEL_CACHE_MAX_WAYS];
+		uint64_t heights[KERNEL_CACHE_MAX_WAYS];
+		uint8_t outputs[KERNEL_CACHE_MAX_WAYS][32];
+		for (uint32_t i = 0; i < ways; ++i)
+		{
+			inputs[i][0] = static_cast<uint8_t>(i);
+			input_ptrs[i] = inputs[i];
+			lens[i] = sizeof(inputs[i]);
+			heights[i] = 0;
+		}
+
+		char name[32];
+		snprintf(name, sizeof(name), "cn_r_hash_batch %u ways", ways);
+		const benchmark_result* result = benchmark_run(reg, name, ways, [&]() { cn_r_hash_batch(batch, input_ptrs, lens, heights, outputs[0], ways); });
+
+		cn_r_batch_destroy(batch);
+
+		if (result->hashrate > best_hashrate)
+		{
+			best_hashrate = result->hashrate;
+			best_ways = ways;
+		}
+	}
+
+	benchmark_registry_destroy(reg);
+	return best_ways;
+}
+
+uint32_t cn_r_batch_get_best_ways()
+{
+	static const uint32_t best_ways = measure_best_ways();
+	return best_ways;
+}
+
+// Every thread has its own batch, freed when the thread exits
+struct thread_batch
+{
+	cn_r_batch* batch = nullptr;
+
+	~thread_batch()
+	{
+		cn_r_batch_destroy(batch);
+	}
+};
+
+bool cn_r_hash_batch(const void* const* inputs, const size_t* lens, const uint64_t* heights, uint8_t* outputs, uint32_t n)
+{
+	static thread_local thread_batch t;
+	if (!t.batch)
+	{
+		t.batch = cn_r_batch_create(cn_r_batch_get_best_ways(), numa_get_current_node());
+	}
+	return cn_r_hash_batch(t.batch, inputs, lens, heights, outputs, n);
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include "definitions.h"
+
+// Complete CryptonightR hash
+//
+// Keccak-1600 of the input -> explode -> main loop for the height's program -> implode -> Keccak-f ->
+// blake/groestl/jh/skein of the state, selected by its 2 lowest bits.
+//
+// Main loop is the generated kernel from a process-wide kernel cache (CryptonightR_kernel_cache.h).
+// If generated code can't be used (no executable memory), a compiled-in kernel for the height or the threaded
+// interpreter (CryptonightR_interpreter.h) runs the program instead. Main loop kind can also be forced, for systems where JIT is not allowed at all:
+// interpreter and reference code never create the kernel cache or allocate executable memory.
+//
+// Batch API is for share verification: inputs are grouped by height, every group goes through one multi-way
+// main loop call, explode/implode are done for 2 hashes at once. Contexts are allocated once per batch object
+// from a colored scratchpad arena (CryptonightR_arena.h).
+
+enum cn_r_mainloop_kind
+{
+	CN_R_MAINLOOP_GENERATED,
+	CN_R_MAINLOOP_CPP,
+	CN_R_MAINLOOP_INTERPRETER,
+
+	// Kernel compiled in for a height from CN_R_STATIC_HEIGHTS (CryptonightR_static.h)
+	CN_R_MAINLOOP_STATIC,
+};
+
+// Must be set before the first hash, batches created earlier keep their kernel caches
+// CN_R_MAINLOOP_GENERATED is the default and falls back to the interpreter
+void cn_r_set_mainloop_kind(cn_r_mainloop_kind kind);
+cn_r_mainloop_kind cn_r_get_mainloop_kind();
+
+const char* cn_r_mainloop_kind_name(cn_r_mainloop_kind kind);
+
+// Parses "generated", "interpreter" or "reference", returns false for anything else
+bool cn_r_parse_mainloop_kind(const char* name, cn_r_mainloop_kind& kind);
+
+// Time of every stage of one hash in rdtsc ticks
+struct cn_r_hash_times
+{
+	uint64_t keccak;
+	uint64_t explode;
+	uint64_t main_loop;
+	uint64_t implode;
+	uint64_t final_hash;
+	cn_r_mainloop_kind mainloop_kind;
+};
+
+// Keccak and explode, can be used as nonce_search_hash_funcs::prepare
+void cn_r_prepare(cryptonight_ctx* ctx, const uint8_t* input, uint32_t len);
+
+// Implode, Keccak-f and final hash, can be used as nonce_search_hash_funcs::finish
+void cn_r_finish(cryptonight_ctx* ctx, uint8_t* hash);
+
+// Writes 32-byte hash, the calling thread gets its own context on the first call
+// Returns false if the context can't be allocated
+bool cn_r_hash(const void* input, size_t len, uint64_t height, uint8_t* hash);
+bool cn_r_hash(const void* input, size_t len, uint64_t height, uint8_t* hash, cn_r_hash_times* times);
+
+struct cn_r_batch;
+
+// ways is the number of hashes per main loop call: 1 (single), 2 (double) or 3-5 (generated multi-way kernels)
+cn_r_batch* cn_r_batch_create(uint32_t ways, int node);
+void cn_r_batch_destroy(cn_r_batch* batch);
+
+// Hashes n independent inputs, outputs has 32 bytes for every input
+bool cn_r_hash_batch(cn_r_batch* batch, const void* const* inputs, const size_t* lens, const uint64_t* heights, uint8_t* outputs, uint32_t n);
+
+// Number of ways with the best median throughput on this CPU, measured once on the first call (about a second)
+// Double kernel is the best on most CPUs, but single is faster when one scratchpad fills the whole L2
+uint32_t cn_r_batch_get_best_ways();
+
+// Same with a batch owned by the calling thread (cn_r_batch_get_best_ways)
+// Returns false if the batch can't be allocated
+bool cn_r_hash_batch(const void* const* inputs, const size_t* lens, const uint64_t* heights, uint8_t* outputs, uint32_t n);
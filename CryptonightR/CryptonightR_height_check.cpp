@@ -0,0 +1,517 @@
+#include "CryptonightR_height_check.h"
+#include "CryptonightR_hash.h"
+#include "CryptonightR_keccak.h"
+#include "CryptonightR_numa.h"
+#include "CryptonightR_jit_buffer.h"
+#include "CryptonightR_template.h"
+#include "CryptonightR_avx512.h"
+#include "CryptonightR_static.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef __GNUC__
+#define TARGET_AES __attribute__((target("aes,sse4.1")))
+#else
+#define TARGET_AES
+#endif
+
+extern void CryptonightR_ref(cryptonight_ctx* ctx0, const V4_Instruction* code);
+extern void CryptonightR_double_ref(cryptonight_ctx* ctx0, cryptonight_ctx* ctx1, const V4_Instruction* code);
+extern bool compile_kernel(const V4_Instruction* code, uint32_t ways, std::vector<uint8_t>& machine_code);
+
+// C++, SSE, AVX2 and ASM code for the RND_SEED program
+extern void CryptonightR(cryptonight_ctx* ctx0);
+extern void CryptonightR_double(cryptonight_ctx* ctx0, cryptonight_ctx* ctx1);
+extern void CryptonightR_double_SSE(cryptonight_ctx* ctx0, cryptonight_ctx* ctx1);
+extern void CryptonightR_quad_AVX2(cryptonight_ctx** ctx);
+extern bool CryptonightR_quad_AVX2_supported();
+extern "C" void ASM_ABI CryptonightR_asm(cryptonight_ctx* ctx0);
+extern "C" void ASM_ABI CryptonightR_double_asm(cryptonight_ctx* ctx0, cryptonight_ctx* ctx1);
+
+enum
+{
+	// Heights in one checkpoint record
+	HEIGHT_CHECK_CHUNK_SIZE = 8,
+
+	// Checkpoint file format and digest, increment when either of them changes
+	HEIGHT_CHECK_CHECKPOINT_VERSION = 2,
+
+	// Lanes of the widest kernel, every lane has its own input
+	HEIGHT_CHECK_MAX_LANES = std::max<int>(AVX512_WAYS, TEMPLATE_MULTI_MAX_WAYS),
+
+	// Generated code for every number of ways goes to its own slot
+	HEIGHT_CHECK_CODE_SLOT_SIZE = 65536,
+
+	HEIGHT_CHECK_INPUT_SIZE = 76,
+
+	HEIGHT_CHECK_PROGRESS_INTERVAL_MS = 5000,
+
+	// Mismatches printed in the summary
+	HEIGHT_CHECK_MAX_REPORTED = 20,
+};
+
+static const char* HEIGHT_CHECK_DEFAULT_CHECKPOINT = "CryptonightR_height_check.log";
+
+TARGET_AES height_check_digest height_check_get_digest(const cryptonight_ctx* ctx)
+{
+	// 4 independent lanes so AES latency is hidden, aesenc with a fixed key is a permutation of the lane state
+	const __m128i key = _mm_set_epi64x(0x243F6A8885A308D3ULL, 0x13198A2E03707344ULL);
+	__m128i s[4] = {
+		_mm_set_epi64x(0, 1), _mm_set_epi64x(0, 2), _mm_set_epi64x(0, 3), _mm_set_epi64x(0, 4),
+	};
+
+	const __m128i* p = (const __m128i*) ctx->long_state;
+	for (size_t i = 0; i < MEMORY / sizeof(__m128i); i += 4)
+	{
+		s[0] = _mm_aesenc_si128(_mm_xor_si128(s[0], _mm_load_si128(p + i + 0)), key);
+		s[1] = _mm_aesenc_si128(_mm_xor_si128(s[1], _mm_load_si128(p + i + 1)), key);
+		s[2] = _mm_aesenc_si128(_mm_xor_si128(s[2], _mm_load_si128(p + i + 2)), key);
+		s[3] = _mm_aesenc_si128(_mm_xor_si128(s[3], _mm_load_si128(p + i + 3)), key);
+	}
+
+	uint8_t buf[sizeof(s) + KECCAK_STATE_SIZE];
+	memcpy(buf, s, sizeof(s));
+	memcpy(buf + sizeof(s), ctx->hash_state, KECCAK_STATE_SIZE);
+
+	uint8_t md[KECCAK_STATE_SIZE];
+	keccak1600(buf, sizeof(buf), md);
+
+	height_check_digest result;
+	memcpy(&result.lo, md, sizeof(uint64_t));
+	memcpy(&result.hi, md + sizeof(uint64_t), sizeof(uint64_t));
+	return result;
+}
+
+struct height_check_mismatch
+{
+	uint64_t height;
+	uint32_t lane;
+	std::string kernel;
+};
+
+struct height_check_worker
+{
+	cryptonight_ctx* ctx[HEIGHT_CHECK_MAX_LANES];
+	jit_buffer code_buf;
+	bool code_buf_allocated;
+	bool avx2;
+	bool avx512;
+};
+
+static void prepare_lanes(height_check_worker& w, uint64_t height, uint32_t lanes)
+{
+	for (uint32_t i = 0; i < lanes; ++i)
+	{
+		uint8_t input[HEIGHT_CHECK_INPUT_SIZE] = {};
+		memcpy(input, &height, sizeof(height));
+		input[sizeof(height)] = static_cast<uint8_t>(i);
+		cn_r_prepare(w.ctx[i], input, sizeof(input));
+	}
+}
+
+static void check_height(height_check_worker& w, uint64_t height, std::vector<height_check_mismatch>& mismatches)
+{
+	V4_Instruction code[NUM_INSTRUCTIONS * 2];
+	v4_random_math_init(code, height);
+
+	const uint32_t num_lanes = w.avx512 ? static_cast<uint32_t>(AVX512_WAYS) : static_cast<uint32_t>(TEMPLATE_MULTI_MAX_WAYS);
+
+	height_check_digest ref[HEIGHT_CHECK_MAX_LANES];
+	prepare_lanes(w, height, num_lanes);
+	for (uint32_t i = 0; i < num_lanes; ++i)
+	{
+		CryptonightR_ref(w.ctx[i], code);
+		ref[i] = height_check_get_digest(w.ctx[i]);
+	}
+
+	auto compare = [&](const char* kernel, uint32_t lanes)
+	{
+		for (uint32_t i = 0; i < lanes; ++i)
+		{
+			const height_check_digest d = height_check_get_digest(w.ctx[i]);
+			if ((d.lo != ref[i].lo) || (d.hi != ref[i].hi))
+			{
+				mismatches.push_back({ height, i, kernel });
+			}
+		}
+	};
+
+	prepare_lanes(w, height, 2);
+	CryptonightR_double_ref(w.ctx[0], w.ctx[1], code);
+	compare("reference code (double)", 2);
+
+	void* generated[TEMPLATE_MULTI_MAX_WAYS + 1] = {};
+	for (uint32_t ways = 1; ways <= TEMPLATE_MULTI_MAX_WAYS; ++ways)
+	{
+		std::vector<uint8_t> machine_code;
+		if (compile_kernel(code, ways, machine_code) && (machine_code.size() <= HEIGHT_CHECK_CODE_SLOT_SIZE))
+		{
+			generated[ways] = jit_buffer_write(&w.code_buf, (ways - 1) * HEIGHT_CHECK_CODE_SLOT_SIZE, machine_code.data(), machine_code.size());
+		}
+		if (!generated[ways])
+		{
+			mismatches.push_back({ height, 0, "generated machine code (" + std::to_string(ways) + " ways) can't be compiled" });
+		}
+	}
+
+	if (generated[1])
+	{
+		prepare_lanes(w, height, 1);
+		((mainloop_func) generated[1])(w.ctx[0]);
+		compare("generated machine code", 1);
+	}
+
+	if (generated[2])
+	{
+		prepare_lanes(w, height, 2);
+		((mainloop_double_func) generated[2])(w.ctx[0], w.ctx[1]);
+		compare("generated machine code (double)", 2);
+	}
+
+	for (uint32_t ways = 3; ways <= TEMPLATE_MULTI_MAX_WAYS; ++ways)
+	{
+		if (generated[ways])
+		{
+			prepare_lanes(w, height, ways);
+			((mainloop_multi_func) generated[ways])(w.ctx);
+			compare(("generated machine code (" + std::to_string(ways) + " ways)").c_str(), ways);
+		}
+	}
+
+	if (w.avx512)
+	{
+		prepare_lanes(w, height, AVX512_WAYS);
+		CryptonightR_avx512(w.ctx, code);
+		compare("AVX-512 code", AVX512_WAYS);
+	}
+
+	// Compile-time generator gives every height's program, kernels are compiled in only for CN_R_STATIC_HEIGHTS
+	if (!v4_static_program_equal(v4_static_random_math_init(height), code))
+	{
+		mismatches.push_back({ height, 0, "compile-time program" });
+	}
+
+	const v4_static_kernel static_kernel = v4_get_static_kernel(height);
+	if (static_kernel)
+	{
+		prepare_lanes(w, height, 1);
+		static_kernel(w.ctx[0]);
+		compare("C++ code (compile-time program)", 1);
+	}
+
+	// Code compiled for one program
+	if (height == RND_SEED)
+	{
+		prepare_lanes(w, height, 1);
+		CryptonightR(w.ctx[0]);
+		compare("C++ code", 1);
+
+		prepare_lanes(w, height, 2);
+		CryptonightR_double(w.ctx[0], w.ctx[1]);
+		compare("C++ code (double)", 2);
+
+		prepare_lanes(w, height, 2);
+		CryptonightR_double_SSE(w.ctx[0], w.ctx[1]);
+		compare("C++ SSE code (double)", 2);
+
+		if (w.avx2)
+		{
+			prepare_lanes(w, height, 4);
+			CryptonightR_quad_AVX2(w.ctx);
+			compare("C++ AVX2 code (quad)", 4);
+		}
+
+		prepare_lanes(w, height, 1);
+		CryptonightR_asm(w.ctx[0]);
+		compare("ASM code", 1);
+
+		prepare_lanes(w, height, 2);
+		CryptonightR_double_asm(w.ctx[0], w.ctx[1]);
+		compare("ASM code (double)", 2);
+	}
+}
+
+// Checkpoint file:
+// "CryptonightR height check v<version> math<32|64> <first> <count> <chunk size>" header, then "done <chunk index>" and
+// "mismatch <height> <lane> <kernel>" lines. Mismatches of a chunk are written before its "done" line.
+// Version and random math width are the build key, results of another build can't be reused.
+struct height_check_checkpoint
+{
+	FILE* f;
+	std::mutex mutex;
+	std::vector<bool> done;
+	std::vector<height_check_mismatch> mismatches;
+};
+
+static bool open_checkpoint(height_check_checkpoint& cp, const char* path, uint64_t first_height, uint64_t count, uint64_t num_chunks)
+{
+	char build_key[64];
+	snprintf(build_key, sizeof(build_key), "CryptonightR height check v%d math%d ", HEIGHT_CHECK_CHECKPOINT_VERSION, (RANDOM_MATH_64_BIT == 1) ? 64 : 32);
+
+	char header[128];
+	snprintf(header, sizeof(header), "%s%llu %llu %u\n", build_key, (unsigned long long) first_height, (unsigned long long) count, static_cast<unsigned int>(HEIGHT_CHECK_CHUNK_SIZE));
+
+	cp.done.assign(num_chunks, false);
+	cp.mismatches.clear();
+
+	FILE* f = fopen(path, "r");
+	if (f)
+	{
+		char line[512];
+		if (!fgets(line, sizeof(line), f) || (strncmp(line, build_key, strlen(build_key)) != 0))
+		{
+			std::cerr << "Checkpoint file " << path << " was written by an incompatible build (expected \"" << build_key << "...\")" << std::endl;
+			fclose(f);
+			return false;
+		}
+		if (strcmp(line, header) != 0)
+		{
+			std::cerr << "Checkpoint file " << path << " is for another height range" << std::endl;
+			fclose(f);
+			return false;
+		}
+
+		// Records of a chunk count only after its "done" line, an interrupted write leaves a partial last line
+		std::vector<height_check_mismatch> pending;
+		while (fgets(line, sizeof(line), f))
+		{
+			const size_t len = strlen(line);
+			if ((len == 0) || (line[len - 1] != '\n'))
+			{
+				break;
+			}
+			line[len - 1] = '\0';
+
+			unsigned long long a, b;
+			int n = 0;
+			if ((sscanf(line, "done %llu", &a) == 1) && (a < num_chunks))
+			{
+				cp.done[a] = true;
+				cp.mismatches.insert(cp.mismatches.end(), pending.begin(), pending.end());
+				pending.clear();
+			}
+			else if (sscanf(line, "mismatch %llu %llu %n", &a, &b, &n) == 2)
+			{
+				pending.push_back({ a, static_cast<uint32_t>(b), line + n });
+			}
+		}
+		fclose(f);
+	}
+
+	cp.f = fopen(path, f ? "a" : "w");
+	if (!cp.f)
+	{
+		std::cerr << "Failed to open checkpoint file " << path << std::endl;
+		return false;
+	}
+	if (!f)
+	{
+		fputs(header, cp.f);
+		fflush(cp.f);
+	}
+	return true;
+}
+
+static void record_chunk(height_check_checkpoint& cp, uint64_t chunk, const std::vector<height_check_mismatch>& mismatches)
+{
+	std::lock_guard<std::mutex> lock(cp.mutex);
+	for (const height_check_mismatch& m : mismatches)
+	{
+		fprintf(cp.f, "mismatch %llu %u %s\n", (unsigned long long) m.height, m.lane, m.kernel.c_str());
+	}
+	fprintf(cp.f, "done %llu\n", (unsigned long long) chunk);
+	fflush(cp.f);
+
+	cp.done[chunk] = true;
+	cp.mismatches.insert(cp.mismatches.end(), mismatches.begin(), mismatches.end());
+}
+
+static bool create_worker(height_check_worker& w)
+{
+	const int node = numa_get_current_node();
+
+	memset(w.ctx, 0, sizeof(w.ctx));
+	w.code_buf_allocated = false;
+	for (uint32_t i = 0; i < HEIGHT_CHECK_MAX_LANES; ++i)
+	{
+		w.ctx[i] = numa_alloc_ctx(node);
+		if (!w.ctx[i])
+		{
+			return false;
+		}
+	}
+
+	w.code_buf_allocated = jit_buffer_alloc_on_node(&w.code_buf, HEIGHT_CHECK_CODE_SLOT_SIZE * TEMPLATE_MULTI_MAX_WAYS, node);
+
+	w.avx2 = CryptonightR_quad_AVX2_supported();
+	w.avx512 = CryptonightR_avx512_supported();
+
+	return w.code_buf_allocated;
+}
+
+static void destroy_worker(height_check_worker& w)
+{
+	for (uint32_t i = 0; i < HEIGHT_CHECK_MAX_LANES; ++i)
+	{
+		numa_free_ctx(w.ctx[i]);
+	}
+	if (w.code_buf_allocated)
+	{
+		jit_buffer_free(&w.code_buf);
+	}
+}
+
+int height_check_main(int argc, char** argv)
+{
+	if (argc < 4)
+	{
+		std::cerr << "Usage: " << argv[0] << " --check-heights <first height> <count> [threads] [--checkpoint <path>]" << std::endl;
+		return 1;
+	}
+
+	const uint64_t first_height = strtoull(argv[2], nullptr, 10);
+	const uint64_t count = strtoull(argv[3], nullptr, 10);
+	uint32_t num_threads = std::max(std::thread::hardware_concurrency(), 1U);
+	if ((argc > 4) && (argv[4][0] != '-'))
+	{
+		num_threads = strtoul(argv[4], nullptr, 10);
+	}
+
+	const char* checkpoint_path = HEIGHT_CHECK_DEFAULT_CHECKPOINT;
+	for (int i = 4; i < argc; ++i)
+	{
+		if ((strcmp(argv[i], "--checkpoint") == 0) && (i + 1 < argc))
+		{
+			checkpoint_path = argv[++i];
+		}
+	}
+
+	if ((count == 0) || (num_threads == 0))
+	{
+		std::cerr << "Height count and threads must be positive" << std::endl;
+		return 1;
+	}
+
+	const uint64_t num_chunks = (count + HEIGHT_CHECK_CHUNK_SIZE - 1) / HEIGHT_CHECK_CHUNK_SIZE;
+
+	height_check_checkpoint cp;
+	if (!open_checkpoint(cp, checkpoint_path, first_height, count, num_chunks))
+	{
+		return 1;
+	}
+
+	std::vector<uint64_t> chunks;
+	for (uint64_t i = 0; i < num_chunks; ++i)
+	{
+		if (!cp.done[i])
+		{
+			chunks.push_back(i);
+		}
+	}
+
+	const uint64_t resumed = num_chunks - chunks.size();
+	std::cout << "Checking heights " << first_height << "-" << first_height + count - 1 << " on " << num_threads << " threads";
+	if (resumed > 0)
+	{
+		std::cout << ", " << resumed << " of " << num_chunks << " chunks are already done in " << checkpoint_path;
+	}
+	std::cout << std::endl;
+
+	std::atomic<uint64_t> next(0);
+	std::atomic<uint64_t> heights_done(0);
+	std::atomic<uint32_t> workers_running(num_threads);
+	std::atomic<bool> failed(false);
+
+	std::vector<std::thread> threads;
+	for (uint32_t t = 0; t < num_threads; ++t)
+	{
+		threads.emplace_back([&]()
+		{
+			height_check_worker w;
+			if (create_worker(w))
+			{
+				for (;;)
+				{
+					const uint64_t k = next.fetch_add(1);
+					if (k >= chunks.size())
+					{
+						break;
+					}
+
+					const uint64_t start = first_height + chunks[k] * HEIGHT_CHECK_CHUNK_SIZE;
+					const uint64_t end = std::min<uint64_t>(start + HEIGHT_CHECK_CHUNK_SIZE, first_height + count);
+
+					std::vector<height_check_mismatch> mismatches;
+					for (uint64_t height = start; height < end; ++height)
+					{
+						check_height(w, height, mismatches);
+						++heights_done;
+					}
+					record_chunk(cp, chunks[k], mismatches);
+				}
+			}
+			else
+			{
+				std::cerr << "Failed to allocate worker memory" << std::endl;
+				failed = true;
+			}
+			destroy_worker(w);
+			--workers_running;
+		});
+	}
+
+	const uint64_t heights_left = std::min<uint64_t>(chunks.size() * HEIGHT_CHECK_CHUNK_SIZE, count);
+	const auto t1 = std::chrono::steady_clock::now();
+	auto last_report = t1;
+	while (workers_running > 0)
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+		const auto t2 = std::chrono::steady_clock::now();
+		if (t2 - last_report >= std::chrono::milliseconds(HEIGHT_CHECK_PROGRESS_INTERVAL_MS))
+		{
+			last_report = t2;
+			const uint64_t done = heights_done;
+			const double dt = std::chrono::duration_cast<std::chrono::milliseconds>(t2 - t1).count() / 1e3;
+			const double rate = done / dt;
+			std::cerr << done << "/" << heights_left << " heights, " << rate << " heights/s";
+			if (rate > 0.0)
+			{
+				std::cerr << ", " << (heights_left - done) / rate / 60.0 << " minutes left";
+			}
+			std::cerr << std::endl;
+		}
+	}
+	for (std::thread& t : threads)
+	{
+		t.join();
+	}
+	fclose(cp.f);
+
+	const double dt = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - t1).count() / 1e3;
+	const uint64_t chunks_done = std::count(cp.done.begin(), cp.done.end(), true);
+
+	std::sort(cp.mismatches.begin(), cp.mismatches.end(), [](const height_check_mismatch& a, const height_check_mismatch& b)
+	{
+		return (a.height < b.height) || ((a.height == b.height) && (a.kernel < b.kernel)) || ((a.height == b.height) && (a.kernel == b.kernel) && (a.lane < b.lane));
+	});
+
+	std::cout << "Checked " << heights_done << " heights in " << dt << " s (" << heights_done / std::max(dt, 1e-3) << " heights/s), " <<
+		chunks_done << " of " << num_chunks << " chunks done, " << cp.mismatches.size() << " mismatches" << std::endl;
+	for (size_t i = 0; (i < cp.mismatches.size()) && (i < HEIGHT_CHECK_MAX_REPORTED); ++i)
+	{
+		const height_check_mismatch& m = cp.mismatches[i];
+		std::cout << "  height " << m.height << ", lane " << m.lane << ": " << m.kernel << std::endl;
+	}
+
+	return (!failed && (chunks_done == num_chunks) && cp.mismatches.empty()) ? 0 : 1;
+}
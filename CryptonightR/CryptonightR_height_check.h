@@ -0,0 +1,31 @@
+#pragma once
+
+#include "definitions.h"
+
+// Parallel correctness check of all main loop kernels over a range of heights
+//
+// Every height's program is run by the C++ reference code and by every kernel which can run it: reference double,
+// generated single, double and 3-5 way code, AVX-512 code (if supported), compiled-in kernels for CN_R_STATIC_HEIGHTS
+// and, for RND_SEED only, C++, SSE, AVX2 and ASM code compiled for that program. The compile-time program generator
+// (CryptonightR_static.h) is compared with v4_random_math_init for every height. Inputs are prepared with Keccak and explode like real hashes.
+// Results are compared as 128-bit digests of long_state and hash_state, so there is no 2 MB reference copy per lane.
+//
+// Heights are split into chunks which worker threads take in order. Every finished chunk and every mismatch is
+// appended to a checkpoint file, and a restarted check skips chunks which are already there, so a long range can be
+// checked in several runs. Checkpoints written by a build with another file format or random math width are rejected.
+//
+// Command line mode:
+// --check-heights <first height> <count> [threads] [--checkpoint <path>]
+// Default is one thread per CPU and CryptonightR_height_check.log, returns 0 only if every height has passed.
+
+struct height_check_digest
+{
+	uint64_t lo;
+	uint64_t hi;
+};
+
+// AES is used to absorb long_state, the result is folded together with hash_state by Keccak
+// Not a cryptographic hash, but the chance that different main loop results give the same 128-bit digest is negligible
+height_check_digest height_check_get_digest(const cryptonight_ctx* ctx);
+
+int height_check_main(int argc, char** argv);
@@ -0,0 +1,162 @@
+#include "CryptonightR_interpreter.h"
+
+#ifdef __GNUC__
+#define TARGET_AES __attribute__((target("aes,sse4.1")))
+#else
+#define TARGET_AES
+#endif
+
+template<int OP, int DST, int SRC>
+static void v4_handler(const v4_threaded_inst* ip, v4_reg r0, v4_reg r1, v4_reg r2, v4_reg r3, v4_reg* r)
+{
+	// Indices are constants, so the compiler keeps everything in registers
+	v4_reg regs[4] = { r0, r1, r2, r3 };
+	const v4_reg src = (SRC < 4) ? regs[SRC & 3] : r[SRC];
+	v4_reg& dst = regs[DST];
+
+	switch (OP)
+	{
+	case MUL: dst *= src; break;
+	case ADD: dst += src + ip->c; break;
+	case SUB: dst -= src; break;
+#if RANDOM_MATH_64_BIT == 1
+	case ROR: dst = _rotr64(dst, static_cast<int>(src)); break;
+	case ROL: dst = _rotl64(dst, static_cast<int>(src)); break;
+#else
+	case ROR: dst = _rotr(dst, static_cast<int>(src)); break;
+	case ROL: dst = _rotl(dst, static_cast<int>(src)); break;
+#endif
+	case XOR: dst ^= src; break;
+	}
+
+	++ip;
+	return ip->handler(ip, regs[0], regs[1], regs[2], regs[3], r);
+}
+
+static void v4_handler_ret(const v4_threaded_inst*, v4_reg r0, v4_reg r1, v4_reg r2, v4_reg r3, v4_reg* r)
+{
+	r[0] = r0;
+	r[1] = r1;
+	r[2] = r2;
+	r[3] = r3;
+}
+
+#define V4_HANDLERS_SRC(op, dst) { \
+	v4_handler<op, dst, 0>, v4_handler<op, dst, 1>, v4_handler<op, dst, 2>, v4_handler<op, dst, 3>, \
+	v4_handler<op, dst, 4>, v4_handler<op, dst, 5>, v4_handler<op, dst, 6>, v4_handler<op, dst, 7> }
+
+#define V4_HANDLERS(op) { V4_HANDLERS_SRC(op, 0), V4_HANDLERS_SRC(op, 1), V4_HANDLERS_SRC(op, 2), V4_HANDLERS_SRC(op, 3) }
+
+static const v4_threaded_handler v4_handlers[V4_INSTRUCTION_COUNT][1 << V4_DST_INDEX_BITS][1 << V4_SRC_INDEX_BITS] = {
+	V4_HANDLERS(MUL), V4_HANDLERS(ADD), V4_HANDLERS(SUB), V4_HANDLERS(ROR), V4_HANDLERS(ROL), V4_HANDLERS(XOR),
+};
+
+void v4_threaded_compile(const V4_Instruction* code, v4_threaded_code& result)
+{
+	int i = 0;
+	for (; code[i].opcode != RET; ++i)
+	{
+		result.insts[i].handler = v4_handlers[code[i].opcode][code[i].dst_index][code[i].src_index];
+		result.insts[i].c = (code[i].opcode == ADD) ? static_cast<v4_reg>(code[i].C) : 0;
+	}
+	result.insts[i].handler = v4_handler_ret;
+	result.insts[i].c = 0;
+}
+
+static FORCEINLINE void run(const v4_threaded_code& code, v4_reg* r)
+{
+	code.insts[0].handler(code.insts, r[0], r[1], r[2], r[3], r);
+}
+
+void v4_threaded_run(const v4_threaded_code& code, v4_reg* r)
+{
+	run(code, r);
+}
+
+// Same as CryptonightR_ref except random math
+TARGET_AES void CryptonightR_interpreter(cryptonight_ctx* ctx0, const v4_threaded_code& code)
+{
+	uint8_t* l0 = ctx0->long_state;
+	uint64_t* h0 = (uint64_t*)ctx0->hash_state;
+
+	__m128i ax0 = _mm_set_epi64x(h0[1] ^ h0[5], h0[0] ^ h0[4]);
+	__m128i bx0 = _mm_set_epi64x(h0[3] ^ h0[7], h0[2] ^ h0[6]);
+	__m128i bx1 = _mm_set_epi64x(h0[9] ^ h0[11], h0[8] ^ h0[10]);
+
+	uint64_t idx0 = h0[0] ^ h0[4];
+	uint64_t idx1 = idx0 & 0x1FFFF0;
+
+	v4_reg r[8];
+	v4_reg* data = reinterpret_cast<v4_reg*>(h0 + 12);
+
+	r[0] = data[0];
+	r[1] = data[1];
+	r[2] = data[2];
+	r[3] = data[3];
+
+	for (size_t i = 0; i < 524288; i++)
+	{
+		__m128i cx = _mm_load_si128((__m128i *)&l0[idx1]);
+
+		cx = _mm_aesenc_si128(cx, ax0);
+
+		{
+			const __m128i chunk1 = _mm_load_si128((__m128i *)&l0[idx1 ^ 0x10]);
+			const __m128i chunk2 = _mm_load_si128((__m128i *)&l0[idx1 ^ 0x20]);
+			const __m128i chunk3 = _mm_load_si128((__m128i *)&l0[idx1 ^ 0x30]);
+			_mm_store_si128((__m128i *)&l0[idx1 ^ 0x10], _mm_add_epi64(chunk3, bx1));
+			_mm_store_si128((__m128i *)&l0[idx1 ^ 0x20], _mm_add_epi64(chunk1, bx0));
+			_mm_store_si128((__m128i *)&l0[idx1 ^ 0x30], _mm_add_epi64(chunk2, ax0));
+		}
+
+		_mm_store_si128((__m128i *)&l0[idx1], _mm_xor_si128(bx0, cx));
+
+		idx0 = _mm_cvtsi128_si64(cx);
+		idx1 = idx0 & 0x1FFFF0;
+
+		uint64_t hi, lo, cl, ch;
+		cl = ((uint64_t*)&l0[idx1])[0];
+		ch = ((uint64_t*)&l0[idx1])[1];
+
+#if RANDOM_MATH_64_BIT == 1
+		cl ^= (r[0] + r[1]) ^ (r[2] + r[3]);
+		r[4] = static_cast<uint64_t>(_mm_cvtsi128_si64(ax0));
+		r[5] = static_cast<uint64_t>(_mm_cvtsi128_si64(_mm_srli_si128(ax0, 8)));
+		r[6] = static_cast<uint64_t>(_mm_cvtsi128_si64(bx0));
+		r[7] = static_cast<uint64_t>(_mm_cvtsi128_si64(bx1));
+#else
+		cl ^= (r[0] + r[1]) | (static_cast<uint64_t>(r[2] + r[3]) << 32);
+		r[4] = static_cast<uint32_t>(_mm_cvtsi128_si32(ax0));
+		r[5] = static_cast<uint32_t>(_mm_cvtsi128_si32(_mm_srli_si128(ax0, 8)));
+		r[6] = static_cast<uint32_t>(_mm_cvtsi128_si32(bx0));
+		r[7] = static_cast<uint32_t>(_mm_cvtsi128_si32(bx1));
+#endif
+		run(code, r);
+
+		lo = __umul128(idx0, cl, &hi);
+
+		{
+			const __m128i chunk1 = _mm_xor_si128(_mm_load_si128((__m128i *)&l0[idx1 ^ 0x10]), _mm_set_epi64x(lo, hi));
+			const __m128i chunk2 = _mm_load_si128((__m128i *)&l0[idx1 ^ 0x20]);
+			hi ^= ((uint64_t*)&l0[idx1 ^ 0x20])[0];
+			lo ^= ((uint64_t*)&l0[idx1 ^ 0x20])[1];
+			const __m128i chunk3 = _mm_load_si128((__m128i *)&l0[idx1 ^ 0x30]);
+			_mm_store_si128((__m128i *)&l0[idx1 ^ 0x10], _mm_add_epi64(chunk3, bx1));
+			_mm_store_si128((__m128i *)&l0[idx1 ^ 0x20], _mm_add_epi64(chunk1, bx0));
+			_mm_store_si128((__m128i *)&l0[idx1 ^ 0x30], _mm_add_epi64(chunk2, ax0));
+		}
+
+		uint64_t al0 = static_cast<uint64_t>(_mm_cvtsi128_si64(ax0)) + hi;
+		uint64_t ah0 = static_cast<uint64_t>(_mm_cvtsi128_si64(_mm_srli_si128(ax0, 8))) + lo;
+		((uint64_t*)&l0[idx1])[0] = al0;
+		((uint64_t*)&l0[idx1])[1] = ah0;
+		ah0 ^= ch;
+		al0 ^= cl;
+		ax0 = _mm_set_epi64x(ah0, al0);
+		idx0 = al0;
+		idx1 = idx0 & 0x1FFFF0;
+
+		bx1 = bx0;
+		bx0 = cx;
+	}
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include "definitions.h"
+
+// Threaded-code interpreter for random math, for systems where generated code can't be executed
+//
+// Program is decoded once into an array of handler pointers. There is a handler for every (opcode, dst, src)
+// combination with registers fixed at compile time, so handlers don't decode anything. Every handler does its
+// instruction and tail-calls the next one (direct threading), there is no dispatch loop and no switch.
+// R0-R3 are passed from handler to handler in argument registers, R4-R7 are read from memory.
+// ADD constants are stored next to handler pointers, already extended to v4_reg.
+
+struct v4_threaded_inst;
+
+// r holds R4-R7 for the program and receives R0-R3 at RET
+typedef void (*v4_threaded_handler)(const v4_threaded_inst* ip, v4_reg r0, v4_reg r1, v4_reg r2, v4_reg r3, v4_reg* r);
+
+struct v4_threaded_inst
+{
+	v4_threaded_handler handler;
+
+	// ADD constant, 0 for other instructions
+	v4_reg c;
+};
+
+struct v4_threaded_code
+{
+	// Program including RET
+	v4_threaded_inst insts[NUM_INSTRUCTIONS * 2];
+};
+
+void v4_threaded_compile(const V4_Instruction* code, v4_threaded_code& result);
+
+// Same as v4_random_math
+void v4_threaded_run(const v4_threaded_code& code, v4_reg* r);
+
+// Main loop with interpreted random math, same results as CryptonightR_ref
+void CryptonightR_interpreter(cryptonight_ctx* ctx0, const v4_threaded_code& code);
@@ -0,0 +1,205 @@
+#include "CryptonightR_jit_buffer.h"
+#include "CryptonightR_numa.h"
+#include <string.h>
+
+#ifdef _WIN32
+#define NOMINMAX
+#define WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#ifndef MFD_CLOEXEC
+#define MFD_CLOEXEC 0x0001U
+#endif
+#endif
+
+static size_t get_page_size()
+{
+#ifdef _WIN32
+	SYSTEM_INFO info;
+	GetSystemInfo(&info);
+	return info.dwPageSize;
+#else
+	return static_cast<size_t>(sysconf(_SC_PAGESIZE));
+#endif
+}
+
+static const size_t page_size = get_page_size();
+
+// Protection flips work on whole pages
+static inline void page_range(size_t offset, size_t size, size_t* begin, size_t* len)
+{
+	*begin = offset & ~(page_size - 1);
+	*len = ((offset + size + page_size - 1) & ~(page_size - 1)) - *begin;
+}
+
+bool jit_buffer_alloc(jit_buffer* buf, size_t size)
+{
+	return jit_buffer_alloc_on_node(buf, size, NUMA_NODE_ANY);
+}
+
+bool jit_buffer_alloc_on_node(jit_buffer* buf, size_t size, int node)
+{
+	memset(buf, 0, sizeof(jit_buffer));
+	size = (size + page_size - 1) & ~(page_size - 1);
+
+#ifdef _WIN32
+	uint8_t* p = (node >= 0) ? (uint8_t*) VirtualAllocExNuma(GetCurrentProcess(), NULL, size, MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE, static_cast<DWORD>(node))
+	                         : (uint8_t*) VirtualAlloc(NULL, size, MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE);
+	if (!p)
+	{
+		return false;
+	}
+#else
+#ifdef SYS_memfd_create
+	const int fd = static_cast<int>(syscall(SYS_memfd_create, "CryptonightR_jit", MFD_CLOEXEC));
+	if (fd >= 0)
+	{
+		void* rw = MAP_FAILED;
+		void* rx = MAP_FAILED;
+		if (ftruncate(fd, static_cast<off_t>(size)) == 0)
+		{
+			rw = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+			rx = mmap(NULL, size, PROT_READ | PROT_EXEC, MAP_SHARED, fd, 0);
+		}
+
+		// Both mappings keep the file alive
+		close(fd);
+
+		if ((rw != MAP_FAILED) && (rx != MAP_FAILED))
+		{
+			// Policy is set on the shared memory object, so it applies to both views
+			numa_bind(rw, size, node);
+
+			buf->rw = (uint8_t*) rw;
+			buf->rx = (uint8_t*) rx;
+			buf->size = size;
+			buf->mode = JIT_BUFFER_DUAL_MAPPING;
+			return true;
+		}
+
+		if (rw != MAP_FAILED) munmap(rw, size);
+		if (rx != MAP_FAILED) munmap(rx, size);
+	}
+#endif
+
+	uint8_t* p = (uint8_t*) mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (p == MAP_FAILED)
+	{
+		return false;
+	}
+	numa_bind(p, size, node);
+#endif
+
+	buf->rw = p;
+	buf->rx = p;
+	buf->size = size;
+	buf->mode = JIT_BUFFER_PROTECT_FLIP;
+	return true;
+}
+
+void jit_buffer_free(jit_buffer* buf)
+{
+	if (buf->mode == JIT_BUFFER_NONE)
+	{
+		return;
+	}
+
+#ifdef _WIN32
+	VirtualFree(buf->rw, 0, MEM_RELEASE);
+#else
+	munmap(buf->rw, buf->size);
+	if (buf->rx != buf->rw)
+	{
+		munmap(buf->rx, buf->size);
+	}
+#endif
+
+	memset(buf, 0, sizeof(jit_buffer));
+}
+
+uint8_t* jit_buffer_begin_write(jit_buffer* buf, size_t offset, size_t size)
+{
+	if ((buf->mode == JIT_BUFFER_NONE) || (offset + size > buf->size))
+	{
+		return nullptr;
+	}
+
+	if (buf->mode == JIT_BUFFER_PROTECT_FLIP)
+	{
+		size_t begin, len;
+		page_range(offset, size, &begin, &len);
+#ifdef _WIN32
+		DWORD old_protect;
+		if (!VirtualProtect(buf->rw + begin, len, PAGE_READWRITE, &old_protect))
+#else
+		if (mprotect(buf->rw + begin, len, PROT_READ | PROT_WRITE) != 0)
+#endif
+		{
+			return nullptr;
+		}
+	}
+
+	return buf->rw + offset;
+}
+
+void* jit_buffer_end_write(jit_buffer* buf, size_t offset, size_t size)
+{
+	if ((buf->mode == JIT_BUFFER_NONE) || (offset + size > buf->size))
+	{
+		return nullptr;
+	}
+
+	if (buf->mode == JIT_BUFFER_PROTECT_FLIP)
+	{
+		size_t begin, len;
+		page_range(offset, size, &begin, &len);
+#ifdef _WIN32
+		DWORD old_protect;
+		if (!VirtualProtect(buf->rw + begin, len, PAGE_EXECUTE_READ, &old_protect))
+#else
+		if (mprotect(buf->rw + begin, len, PROT_READ | PROT_EXEC) != 0)
+#endif
+		{
+			return nullptr;
+		}
+	}
+
+#ifdef _WIN32
+	FlushInstructionCache(GetCurrentProcess(), buf->rx + offset, size);
+#else
+	__builtin___clear_cache((char*)(buf->rx + offset), (char*)(buf->rx + offset + size));
+#endif
+
+	return buf->rx + offset;
+}
+
+void* jit_buffer_write(jit_buffer* buf, size_t offset, const void* code, size_t size)
+{
+	uint8_t* p = jit_buffer_begin_write(buf, offset, size);
+	if (!p)
+	{
+		return nullptr;
+	}
+
+	memcpy(p, code, size);
+	return jit_buffer_end_write(buf, offset, size);
+}
+
+const char* jit_buffer_mode_name(jit_buffer_mode mode)
+{
+	switch (mode)
+	{
+	case JIT_BUFFER_DUAL_MAPPING:
+		return "dual mapping (RW + RX views)";
+
+	case JIT_BUFFER_PROTECT_FLIP:
+		return "protection flips";
+
+	default:
+		return "none";
+	}
+}
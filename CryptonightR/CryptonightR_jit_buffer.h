@@ -0,0 +1,48 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Executable memory for generated code which is never writable and executable at the same time (W^X)
+//
+// Linux: one memfd is mapped twice - RW view is used to write code, RX view is used to run it
+// Writing a new program is just memcpy into RW view, no syscalls at all
+// If memfd can't be mapped executable (old kernel, hardened policy), it falls back to mprotect flips
+//
+// Windows: VirtualAlloc + VirtualProtect flips
+//
+// Code produced by compile_code/compile_code_double is position independent, so it can be written
+// through one view and executed through the other. Use page-aligned offsets for code that can run
+// while another part of the buffer is being rewritten: protection flips are page granular.
+
+enum jit_buffer_mode
+{
+	JIT_BUFFER_NONE,
+	JIT_BUFFER_DUAL_MAPPING,
+	JIT_BUFFER_PROTECT_FLIP,
+};
+
+struct jit_buffer
+{
+	uint8_t* rw; // view used to write code
+	uint8_t* rx; // view used to execute code, same as rw in JIT_BUFFER_PROTECT_FLIP mode
+	size_t size;
+	jit_buffer_mode mode;
+};
+
+bool jit_buffer_alloc(jit_buffer* buf, size_t size);
+
+// Same, but pages are bound to a NUMA node (NUMA_NODE_ANY for no binding)
+bool jit_buffer_alloc_on_node(jit_buffer* buf, size_t size, int node);
+void jit_buffer_free(jit_buffer* buf);
+
+// Returns writable pointer to [offset, offset + size), nullptr on failure
+uint8_t* jit_buffer_begin_write(jit_buffer* buf, size_t offset, size_t size);
+
+// Makes [offset, offset + size) executable, returns pointer to call, nullptr on failure
+void* jit_buffer_end_write(jit_buffer* buf, size_t offset, size_t size);
+
+// begin_write + memcpy + end_write
+void* jit_buffer_write(jit_buffer* buf, size_t offset, const void* code, size_t size);
+
+const char* jit_buffer_mode_name(jit_buffer_mode mode);
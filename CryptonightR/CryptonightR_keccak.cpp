@@ -0,0 +1,112 @@
+#include "CryptonightR_keccak.h"
+#include <string.h>
+
+static const uint64_t keccakf_rndc[24] =
+{
+	0x0000000000000001, 0x0000000000008082, 0x800000000000808a,
+	0x8000000080008000, 0x000000000000808b, 0x0000000080000001,
+	0x8000000080008081, 0x8000000000008009, 0x000000000000008a,
+	0x0000000000000088, 0x0000000080008009, 0x000000008000000a,
+	0x000000008000808b, 0x800000000000008b, 0x8000000000008089,
+	0x8000000000008003, 0x8000000000008002, 0x8000000000000080,
+	0x000000000000800a, 0x800000008000000a, 0x8000000080008081,
+	0x8000000000008080, 0x0000000080000001, 0x8000000080008008
+};
+
+static const int keccakf_rotc[24] =
+{
+	1, 3, 6, 10, 15, 21, 28, 36, 45, 55, 2, 14,
+	27, 41, 56, 8, 25, 43, 62, 18, 39, 61, 20, 44
+};
+
+static const int keccakf_piln[24] =
+{
+	10, 7, 11, 17, 18, 3, 5, 16, 8, 21, 24, 4,
+	15, 23, 19, 13, 12, 2, 20, 14, 22, 9, 6, 1
+};
+
+static inline uint64_t rotl64(uint64_t x, int y)
+{
+	return (x << y) | (x >> (64 - y));
+}
+
+void keccakf(uint64_t (&st)[25], int rounds)
+{
+	for (int round = 0; round < rounds; ++round)
+	{
+		// Theta
+		uint64_t bc[5];
+		for (int i = 0; i < 5; ++i)
+		{
+			bc[i] = st[i] ^ st[i + 5] ^ st[i + 10] ^ st[i + 15] ^ st[i + 20];
+		}
+
+		for (int i = 0; i < 5; ++i)
+		{
+			const uint64_t t = bc[(i + 4) % 5] ^ rotl64(bc[(i + 1) % 5], 1);
+			for (int j = 0; j < 25; j += 5)
+			{
+				st[j + i] ^= t;
+			}
+		}
+
+		// Rho Pi
+		uint64_t t = st[1];
+		for (int i = 0; i < 24; ++i)
+		{
+			const int j = keccakf_piln[i];
+			const uint64_t t1 = st[j];
+			st[j] = rotl64(t, keccakf_rotc[i]);
+			t = t1;
+		}
+
+		// Chi
+		for (int j = 0; j < 25; j += 5)
+		{
+			for (int i = 0; i < 5; ++i)
+			{
+				bc[i] = st[j + i];
+			}
+			for (int i = 0; i < 5; ++i)
+			{
+				st[j + i] ^= (~bc[(i + 1) % 5]) & bc[(i + 2) % 5];
+			}
+		}
+
+		// Iota
+		st[0] ^= keccakf_rndc[round];
+	}
+}
+
+// Little endian only, like the rest of the project
+void keccak1600(const uint8_t* in, size_t inlen, uint8_t* md)
+{
+	uint64_t st[25] = {};
+
+	for (; inlen >= KECCAK_RATE; inlen -= KECCAK_RATE, in += KECCAK_RATE)
+	{
+		for (int i = 0; i < KECCAK_RATE / 8; ++i)
+		{
+			uint64_t x;
+			memcpy(&x, in + i * 8, sizeof(x));
+			st[i] ^= x;
+		}
+		keccakf(st, KECCAK_ROUNDS);
+	}
+
+	// Last block and padding
+	uint8_t temp[KECCAK_RATE] = {};
+	memcpy(temp, in, inlen);
+	temp[inlen] = 1;
+	temp[KECCAK_RATE - 1] |= 0x80;
+
+	for (int i = 0; i < KECCAK_RATE / 8; ++i)
+	{
+		uint64_t x;
+		memcpy(&x, temp + i * 8, sizeof(x));
+		st[i] ^= x;
+	}
+	keccakf(st, KECCAK_ROUNDS);
+
+	memcpy(md, st, KECCAK_STATE_SIZE);
+}
@@ -0,0 +1,18 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Keccak-1600 as used by Cryptonight: original Keccak padding (0x01), rate 136 bytes (Keccak-256)
+
+enum
+{
+	KECCAK_STATE_SIZE = 200,
+	KECCAK_RATE = 136,
+	KECCAK_ROUNDS = 24,
+};
+
+void keccakf(uint64_t (&st)[25], int rounds);
+
+// Absorbs input and returns the whole 200-byte state (Cryptonight hash state), first 32 bytes are Keccak-256
+void keccak1600(const uint8_t* in, size_t inlen, uint8_t* md);
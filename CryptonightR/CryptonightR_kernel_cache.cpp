@@ -0,0 +1,367 @@
+#include "CryptonightR_kernel_cache.h"
+#include "CryptonightR_jit_buffer.h"
+#include "CryptonightR_code_file.h"
+#include "CryptonightR_numa.h"
+#include <vector>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+
+extern bool compile_kernel(const V4_Instruction* code, uint32_t ways, std::vector<uint8_t>& machine_code);
+
+enum slot_state
+{
+	SLOT_EMPTY,
+	SLOT_COMPILING,
+	SLOT_READY,
+};
+
+struct kernel_cache_slot
+{
+	kernel_cache_entry entry;
+	slot_state state;
+	int refs;
+	bool from_file;
+};
+
+struct kernel_cache
+{
+	jit_buffer buf;
+	std::vector<kernel_cache_slot> slots;
+	code_file* file;
+	uint32_t ways_mask;
+	uint32_t keep_behind;
+
+	std::mutex mutex;
+	std::condition_variable slot_ready;
+	std::condition_variable work_available;
+	std::deque<kernel_cache_key> queue;
+	std::thread worker;
+	bool stop;
+
+	uint64_t height;
+	bool height_set;
+
+	// Kernels for current height, this is what a block change swaps
+	kernel_cache_slot* current[KERNEL_CACHE_MAX_WAYS + 1];
+
+	kernel_cache_stats stats;
+};
+
+static inline bool same_key(const kernel_cache_key& a, const kernel_cache_key& b)
+{
+	return (a.height == b.height) && (a.ways == b.ways) && (a.math_bits == b.math_bits);
+}
+
+static inline bool in_window(const kernel_cache* cache, uint64_t height)
+{
+	if (!cache->height_set)
+	{
+		return false;
+	}
+	return (height + cache->keep_behind >= cache->height) && (height <= cache->height + KERNEL_CACHE_LOOKAHEAD);
+}
+
+static kernel_cache_slot* find_slot(kernel_cache* cache, const kernel_cache_key& key)
+{
+	for (kernel_cache_slot& slot : cache->slots)
+	{
+		if ((slot.state != SLOT_EMPTY) && same_key(slot.entry.key, key))
+		{
+			return &slot;
+		}
+	}
+	return nullptr;
+}
+
+// Picks an empty slot, or the lowest unused height outside of the current window
+static kernel_cache_slot* reserve_slot(kernel_cache* cache, const kernel_cache_key& key)
+{
+	kernel_cache_slot* result = nullptr;
+	for (kernel_cache_slot& slot : cache->slots)
+	{
+		if (slot.state == SLOT_EMPTY)
+		{
+			result = &slot;
+			break;
+		}
+
+		if ((slot.state == SLOT_READY) && (slot.refs == 0) && !in_window(cache, slot.entry.key.height))
+		{
+			if (!result || (slot.entry.key.height < result->entry.key.height))
+			{
+				result = &slot;
+			}
+		}
+	}
+
+	if (!result)
+	{
+		return nullptr;
+	}
+
+	if (result->state != SLOT_EMPTY)
+	{
+		++cache->stats.evicted;
+		for (kernel_cache_slot*& p : cache->current)
+		{
+			if (p == result)
+			{
+				p = nullptr;
+			}
+		}
+	}
+
+	result->entry.key = key;
+	result->entry.func = nullptr;
+	result->entry.num_insts = 0;
+	result->state = SLOT_COMPILING;
+	result->refs = 0;
+	result->from_file = false;
+	return result;
+}
+
+// Called without the lock held, slot is in SLOT_COMPILING state and belongs to the caller
+static bool compile_slot(kernel_cache* cache, kernel_cache_slot* slot)
+{
+	const kernel_cache_key& key = slot->entry.key;
+
+	// Precompiled code doesn't need a slot in jit buffer, slot only tracks it
+	if (cache->file)
+	{
+		slot->entry.func = const_cast<void*>(code_file_get(cache->file, key.height, key.ways, &slot->entry.num_insts));
+		if (slot->entry.func)
+		{
+			slot->from_file = true;
+			return true;
+		}
+	}
+
+	V4_Instruction code[NUM_INSTRUCTIONS * 2];
+	const int num_insts = v4_random_math_init(code, key.height);
+
+	std::vector<uint8_t> machine_code;
+	if (!compile_kernel(code, key.ways, machine_code) || (machine_code.size() > KERNEL_CACHE_SLOT_SIZE))
+	{
+		return false;
+	}
+
+	const size_t offset = static_cast<size_t>(slot - cache->slots.data()) * KERNEL_CACHE_SLOT_SIZE;
+	slot->entry.func = jit_buffer_write(&cache->buf, offset, machine_code.data(), machine_code.size());
+	slot->entry.num_insts = num_insts;
+	return slot->entry.func != nullptr;
+}
+
+static void finish_slot(kernel_cache* cache, kernel_cache_slot* slot, bool compiled)
+{
+	slot->state = compiled ? SLOT_READY : SLOT_EMPTY;
+	if (compiled && slot->from_file)
+	{
+		++cache->stats.from_file;
+	}
+	cache->slot_ready.notify_all();
+}
+
+static void worker_thread(kernel_cache* cache)
+{
+	std::unique_lock<std::mutex> lock(cache->mutex);
+	for (;;)
+	{
+		cache->work_available.wait(lock, [cache]() { return cache->stop || !cache->queue.empty(); });
+		if (cache->stop)
+		{
+			return;
+		}
+
+		const kernel_cache_key key = cache->queue.front();
+		cache->queue.pop_front();
+
+		// Current height could have moved on while this key was waiting in the queue
+		if (!in_window(cache, key.height) || find_slot(cache, key))
+		{
+			continue;
+		}
+
+		kernel_cache_slot* slot = reserve_slot(cache, key);
+		if (!slot)
+		{
+			continue;
+		}
+
+		lock.unlock();
+		const bool compiled = compile_slot(cache, slot);
+		lock.lock();
+
+		finish_slot(cache, slot, compiled);
+		if (compiled)
+		{
+			++cache->stats.precompiled;
+		}
+	}
+}
+
+kernel_cache* kernel_cache_create(uint32_t num_slots, uint32_t ways_mask, uint32_t keep_behind)
+{
+	return kernel_cache_create_on_node(num_slots, ways_mask, keep_behind, NUMA_NODE_ANY);
+}
+
+kernel_cache* kernel_cache_create_on_node(uint32_t num_slots, uint32_t ways_mask, uint32_t keep_behind, int node)
+{
+	kernel_cache* cache = new kernel_cache();
+	if (!jit_buffer_alloc_on_node(&cache->buf, static_cast<size_t>(num_slots) * KERNEL_CACHE_SLOT_SIZE, node))
+	{
+		delete cache;
+		return nullptr;
+	}
+
+	cache->slots.resize(num_slots);
+	for (kernel_cache_slot& slot : cache->slots)
+	{
+		slot.state = SLOT_EMPTY;
+		slot.refs = 0;
+	}
+
+	cache->file = nullptr;
+	cache->ways_mask = ways_mask;
+	cache->keep_behind = keep_behind;
+	cache->stop = false;
+	cache->height = 0;
+	cache->height_set = false;
+	memset(cache->current, 0, sizeof(cache->current));
+	memset(&cache->stats, 0, sizeof(cache->stats));
+
+	cache->worker = std::thread(worker_thread, cache);
+	return cache;
+}
+
+void kernel_cache_destroy(kernel_cache* cache)
+{
+	{
+		std::lock_guard<std::mutex> lock(cache->mutex);
+		cache->stop = true;
+	}
+	cache->work_available.notify_all();
+	cache->worker.join();
+
+	jit_buffer_free(&cache->buf);
+	delete cache;
+}
+
+void kernel_cache_set_height(kernel_cache* cache, uint64_t height)
+{
+	{
+		std::lock_guard<std::mutex> lock(cache->mutex);
+		cache->height = height;
+		cache->height_set = true;
+
+		for (uint32_t ways = 1; ways <= KERNEL_CACHE_MAX_WAYS; ++ways)
+		{
+			cache->current[ways] = nullptr;
+			if (cache->ways_mask & (1U << ways))
+			{
+				const kernel_cache_key key = { height, ways, V4_MATH_BITS };
+				kernel_cache_slot* slot = find_slot(cache, key);
+				if (slot && (slot->state == SLOT_READY))
+				{
+					cache->current[ways] = slot;
+				}
+			}
+		}
+
+		cache->queue.clear();
+		for (uint64_t h = height + 1; h <= height + KERNEL_CACHE_LOOKAHEAD; ++h)
+		{
+			for (uint32_t ways = 1; ways <= KERNEL_CACHE_MAX_WAYS; ++ways)
+			{
+				if (cache->ways_mask & (1U << ways))
+				{
+					cache->queue.push_back({ h, ways, V4_MATH_BITS });
+				}
+			}
+		}
+	}
+	cache->work_available.notify_one();
+}
+
+const kernel_cache_entry* kernel_cache_acquire(kernel_cache* cache, uint64_t height, uint32_t ways)
+{
+	const kernel_cache_key key = { height, ways, V4_MATH_BITS };
+
+	std::unique_lock<std::mutex> lock(cache->mutex);
+
+	kernel_cache_slot* slot = nullptr;
+	if (cache->height_set && (height == cache->height) && (ways <= KERNEL_CACHE_MAX_WAYS))
+	{
+		slot = cache->current[ways];
+	}
+
+	if (!slot)
+	{
+		slot = find_slot(cache, key);
+	}
+
+	if (slot)
+	{
+		// Background thread is compiling it right now
+		cache->slot_ready.wait(lock, [slot]() { return slot->state != SLOT_COMPILING; });
+	}
+
+	if (slot && (slot->state == SLOT_READY) && same_key(slot->entry.key, key))
+	{
+		++cache->stats.hits;
+	}
+	else
+	{
+		++cache->stats.misses;
+
+		slot = reserve_slot(cache, key);
+		if (!slot)
+		{
+			return nullptr;
+		}
+
+		lock.unlock();
+		const bool compiled = compile_slot(cache, slot);
+		lock.lock();
+
+		finish_slot(cache, slot, compiled);
+		if (!compiled)
+		{
+			return nullptr;
+		}
+	}
+
+	if (cache->height_set && (height == cache->height) && (ways <= KERNEL_CACHE_MAX_WAYS))
+	{
+		cache->current[ways] = slot;
+	}
+
+	++slot->refs;
+	return &slot->entry;
+}
+
+void kernel_cache_release(kernel_cache* cache, const kernel_cache_entry* entry)
+{
+	std::lock_guard<std::mutex> lock(cache->mutex);
+	for (kernel_cache_slot& slot : cache->slots)
+	{
+		if (&slot.entry == entry)
+		{
+			--slot.refs;
+			return;
+		}
+	}
+}
+
+void kernel_cache_attach_file(kernel_cache* cache, code_file* file)
+{
+	std::lock_guard<std::mutex> lock(cache->mutex);
+	cache->file = file;
+}
+
+kernel_cache_stats kernel_cache_get_stats(kernel_cache* cache)
+{
+	std::lock_guard<std::mutex> lock(cache->mutex);
+	return cache->stats;
+}
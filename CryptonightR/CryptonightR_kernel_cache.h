@@ -0,0 +1,80 @@
+#pragma once
+
+#include "definitions.h"
+
+// Cache of compiled CryptonightR kernels keyed by (height, ways, math width)
+//
+// Every block has its own program, so a verifier needs kernels for the current height, a few previous heights
+// (orphan races) and the next height. A background thread compiles height+1..height+KERNEL_CACHE_LOOKAHEAD
+// as soon as the current height is set, so switching to the next block usually only swaps a pointer.
+//
+// Kernels are written to W^X memory (CryptonightR_jit_buffer.h), one page-aligned slot per kernel,
+// so a slot can be rewritten while kernels in other slots are running.
+
+enum
+{
+	KERNEL_CACHE_LOOKAHEAD = 2,
+	KERNEL_CACHE_SLOT_SIZE = 16384,
+	KERNEL_CACHE_MAX_WAYS = 5,
+
+	// ways_mask bits
+	KERNEL_SINGLE = 1 << 1,
+	KERNEL_DOUBLE = 1 << 2,
+	KERNEL_TRIPLE = 1 << 3,
+	KERNEL_QUAD = 1 << 4,
+	KERNEL_PENTA = 1 << 5,
+};
+
+// Only one width is compiled in (RANDOM_MATH_64_BIT), but it's a part of the key
+// because the same height gives different machine code for different widths
+constexpr uint32_t V4_MATH_BITS = sizeof(v4_reg) * 8;
+
+struct kernel_cache_key
+{
+	uint64_t height;
+	uint32_t ways;
+	uint32_t math_bits;
+};
+
+struct kernel_cache_entry
+{
+	kernel_cache_key key;
+
+	// mainloop_func for 1 way, mainloop_double_func for 2 ways, mainloop_multi_func for 3 and more ways
+	void* func;
+	int num_insts;
+};
+
+struct kernel_cache_stats
+{
+	uint64_t hits;
+	uint64_t misses;
+	uint64_t precompiled;
+	uint64_t evicted;
+	uint64_t from_file;
+};
+
+struct kernel_cache;
+struct code_file;
+
+// num_slots must be enough for all heights in use: (keep_behind + 1 + KERNEL_CACHE_LOOKAHEAD) per kernel type
+kernel_cache* kernel_cache_create(uint32_t num_slots, uint32_t ways_mask, uint32_t keep_behind);
+
+// Generated code is bound to a NUMA node, so every node can have its own copy of the kernels
+kernel_cache* kernel_cache_create_on_node(uint32_t num_slots, uint32_t ways_mask, uint32_t keep_behind, int node);
+void kernel_cache_destroy(kernel_cache* cache);
+
+// Sets current height and starts background compilation of the next heights
+void kernel_cache_set_height(kernel_cache* cache, uint64_t height);
+
+// Returns ready to run kernel, compiles it synchronously if it's not in cache yet
+// Returns nullptr if all slots are in use
+// Kernel can't be evicted until it's released
+const kernel_cache_entry* kernel_cache_acquire(kernel_cache* cache, uint64_t height, uint32_t ways);
+void kernel_cache_release(kernel_cache* cache, const kernel_cache_entry* entry);
+
+// Kernels found in the file (CryptonightR_code_file.h) are used directly instead of being compiled
+// Must be called before the first kernel_cache_set_height, the file must stay open while the cache is in use
+void kernel_cache_attach_file(kernel_cache* cache, code_file* file);
+
+kernel_cache_stats kernel_cache_get_stats(kernel_cache* cache);
@@ -0,0 +1,249 @@
+#include "CryptonightR_large_pages.h"
+#include "CryptonightR_numa.h"
+#include <stdio.h>
+#include <string.h>
+
+#ifdef _WIN32
+#define NOMINMAX
+#define WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+#else
+#include <sys/mman.h>
+#include <unistd.h>
+
+#ifndef MAP_HUGETLB
+#define MAP_HUGETLB 0x40000
+#endif
+
+#ifndef MAP_HUGE_SHIFT
+#define MAP_HUGE_SHIFT 26
+#endif
+
+#ifndef MADV_HUGEPAGE
+#define MADV_HUGEPAGE 14
+#endif
+#endif
+
+static inline size_t round_up(size_t size, size_t alignment)
+{
+	return (size + alignment - 1) & ~(alignment - 1);
+}
+
+#ifndef _WIN32
+static uint8_t* map_hugetlb(size_t size, uint32_t page_shift)
+{
+	void* p = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | (page_shift << MAP_HUGE_SHIFT), -1, 0);
+	return (p != MAP_FAILED) ? (uint8_t*) p : nullptr;
+}
+
+// Checks /proc/self/smaps: all resident memory of the mapping must be in transparent huge pages
+static large_page_kind check_thp(const uint8_t* ptr)
+{
+	FILE* f = fopen("/proc/self/smaps", "r");
+	if (!f)
+	{
+		return PAGES_THP_REQUESTED;
+	}
+
+	const uintptr_t addr = reinterpret_cast<uintptr_t>(ptr);
+	bool found = false;
+	uint64_t rss = 0;
+	uint64_t anon_huge = 0;
+	bool have_rss = false;
+	bool have_anon_huge = false;
+
+	char line[256];
+	while (fgets(line, sizeof(line), f))
+	{
+		unsigned long long begin, end;
+		if (sscanf(line, "%llx-%llx ", &begin, &end) == 2)
+		{
+			if (found)
+			{
+				break;
+			}
+			found = (addr >= begin) && (addr < end);
+			continue;
+		}
+
+		if (!found)
+		{
+			continue;
+		}
+
+		unsigned long long value;
+		if (sscanf(line, "Rss: %llu kB", &value) == 1)
+		{
+			rss = value;
+			have_rss = true;
+		}
+		else if (sscanf(line, "AnonHugePages: %llu kB", &value) == 1)
+		{
+			anon_huge = value;
+			have_anon_huge = true;
+		}
+	}
+	fclose(f);
+
+	if (!have_rss || !have_anon_huge)
+	{
+		return PAGES_THP_REQUESTED;
+	}
+
+	return ((anon_huge > 0) && (anon_huge == rss)) ? PAGES_THP_2MB : PAGES_4KB;
+}
+#endif
+
+bool large_pages_alloc(large_page_alloc* alloc, size_t size, int node, bool round_up_to_1gb)
+{
+	memset(alloc, 0, sizeof(large_page_alloc));
+
+#ifdef _WIN32
+	// 1 GB pages need VirtualAlloc2 with MEM_EXTENDED_PARAMETER_NONPAGED_HUGE, not supported here
+	(void)round_up_to_1gb;
+
+	const DWORD preferred_node = (node >= 0) ? static_cast<DWORD>(node) : NUMA_NO_PREFERRED_NODE;
+
+	const size_t large_page_size = GetLargePageMinimum();
+	if (large_page_size)
+	{
+		const size_t n = round_up(size, large_page_size);
+		alloc->ptr = (uint8_t*) VirtualAllocExNuma(GetCurrentProcess(), NULL, n, MEM_COMMIT | MEM_RESERVE | MEM_LARGE_PAGES, PAGE_READWRITE, preferred_node);
+		if (alloc->ptr)
+		{
+			alloc->size = n;
+			alloc->kind = (large_page_size >= LARGE_PAGES_1GB) ? PAGES_HUGETLB_1GB : PAGES_HUGETLB_2MB;
+			alloc->locked = true;
+		}
+	}
+
+	if (!alloc->ptr)
+	{
+		alloc->ptr = (uint8_t*) VirtualAllocExNuma(GetCurrentProcess(), NULL, size, MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE, preferred_node);
+		if (!alloc->ptr)
+		{
+			return false;
+		}
+		alloc->size = size;
+		alloc->kind = PAGES_4KB;
+	}
+
+	alloc->map_ptr = alloc->ptr;
+	alloc->map_size = alloc->size;
+
+	// Large pages are committed and locked by VirtualAlloc itself
+	if (alloc->kind == PAGES_4KB)
+	{
+		for (size_t i = 0; i < alloc->size; i += 4096)
+		{
+			alloc->ptr[i] = 0;
+		}
+		alloc->locked = VirtualLock(alloc->ptr, alloc->size) != 0;
+	}
+#else
+	if ((size >= LARGE_PAGES_1GB) || round_up_to_1gb)
+	{
+		const size_t n = round_up(size, LARGE_PAGES_1GB);
+		alloc->ptr = map_hugetlb(n, 30);
+		if (alloc->ptr)
+		{
+			alloc->size = n;
+			alloc->kind = PAGES_HUGETLB_1GB;
+		}
+	}
+
+	if (!alloc->ptr)
+	{
+		const size_t n = round_up(size, LARGE_PAGES_2MB);
+		alloc->ptr = map_hugetlb(n, 21);
+		if (alloc->ptr)
+		{
+			alloc->size = n;
+			alloc->kind = PAGES_HUGETLB_2MB;
+		}
+	}
+
+	if (alloc->ptr)
+	{
+		alloc->map_ptr = alloc->ptr;
+		alloc->map_size = alloc->size;
+	}
+	else
+	{
+		// THP needs 2 MB aligned memory, so map more and use the aligned part
+		const size_t n = round_up(size, LARGE_PAGES_2MB);
+		void* p = mmap(NULL, n + LARGE_PAGES_2MB, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+		if (p == MAP_FAILED)
+		{
+			return false;
+		}
+
+		alloc->map_ptr = (uint8_t*) p;
+		alloc->map_size = n + LARGE_PAGES_2MB;
+		alloc->ptr = (uint8_t*) round_up(reinterpret_cast<size_t>(p), LARGE_PAGES_2MB);
+		alloc->size = n;
+		alloc->kind = (madvise(alloc->ptr, alloc->size, MADV_HUGEPAGE) == 0) ? PAGES_THP_REQUESTED : PAGES_4KB;
+	}
+
+	numa_bind(alloc->ptr, alloc->size, node);
+
+	// Prefault everything now, page faults in the main loop would be much more expensive
+	for (size_t i = 0; i < alloc->size; i += 4096)
+	{
+		alloc->ptr[i] = 0;
+	}
+
+	alloc->locked = mlock(alloc->ptr, alloc->size) == 0;
+
+	if (alloc->kind == PAGES_THP_REQUESTED)
+	{
+		alloc->kind = check_thp(alloc->ptr);
+	}
+#endif
+
+	return true;
+}
+
+void large_pages_free(large_page_alloc* alloc)
+{
+	if (!alloc->map_ptr)
+	{
+		return;
+	}
+
+#ifdef _WIN32
+	VirtualFree(alloc->map_ptr, 0, MEM_RELEASE);
+#else
+	if (alloc->locked)
+	{
+		munlock(alloc->ptr, alloc->size);
+	}
+	munmap(alloc->map_ptr, alloc->map_size);
+#endif
+
+	memset(alloc, 0, sizeof(large_page_alloc));
+}
+
+const char* large_pages_kind_name(large_page_kind kind)
+{
+	switch (kind)
+	{
+	case PAGES_4KB:
+		return "4 KB pages";
+
+	case PAGES_THP_REQUESTED:
+		return "transparent huge pages (requested, not checked)";
+
+	case PAGES_THP_2MB:
+		return "2 MB transparent huge pages";
+
+	case PAGES_HUGETLB_2MB:
+		return "2 MB huge pages";
+
+	case PAGES_HUGETLB_1GB:
+		return "1 GB huge pages";
+
+	default:
+		return "none";
+	}
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Scratchpad memory in the largest pages the system can give
+//
+// Main loop reads and writes random 16-byte blocks all over 2 MB, so with 4 KB pages almost every access
+// needs a different TLB entry. One 2 MB page covers the whole scratchpad.
+//
+// Linux: MAP_HUGETLB with 1 GB pages (only for allocations of at least 1 GB or if asked), then MAP_HUGETLB with 2 MB pages,
+// then transparent huge pages (2 MB aligned mapping + MADV_HUGEPAGE), then normal pages.
+// Windows: MEM_LARGE_PAGES (needs SeLockMemoryPrivilege), then normal pages.
+//
+// Memory is bound to a NUMA node (CryptonightR_numa.h) before it's touched, then prefaulted and locked,
+// so there are no page faults in the main loop.
+
+enum large_page_kind
+{
+	PAGES_NONE,
+	PAGES_4KB,
+
+	// Transparent huge pages, only a request to the kernel
+	PAGES_THP_REQUESTED,
+
+	// Transparent huge pages, checked after prefaulting
+	PAGES_THP_2MB,
+
+	PAGES_HUGETLB_2MB,
+	PAGES_HUGETLB_1GB,
+};
+
+enum
+{
+	LARGE_PAGES_2MB = 2 << 20,
+	LARGE_PAGES_1GB = 1 << 30,
+};
+
+struct large_page_alloc
+{
+	uint8_t* ptr;
+	size_t size;
+	large_page_kind kind;
+
+	// mlock/VirtualLock succeeded (large pages on Windows are always locked)
+	bool locked;
+
+	// For THP fallback the mapping is bigger than ptr..ptr+size, so it can be aligned
+	uint8_t* map_ptr;
+	size_t map_size;
+};
+
+// Returns false if even normal pages can't be allocated
+// With round_up_to_1gb smaller allocations also try a whole 1 GB page first (scratchpad arena)
+bool large_pages_alloc(large_page_alloc* alloc, size_t size, int node, bool round_up_to_1gb = false);
+void large_pages_free(large_page_alloc* alloc);
+
+const char* large_pages_kind_name(large_page_kind kind);
@@ -0,0 +1,553 @@
+#include "CryptonightR_nonce_search.h"
+#include "CryptonightR_kernel_cache.h"
+#include "CryptonightR_numa.h"
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+#include <new>
+
+#ifdef _WIN32
+#define NOMINMAX
+#define WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+#else
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+enum
+{
+	CACHE_LINE_SIZE = 64,
+};
+
+// Hot fields of a worker fill a whole cache line, so workers never share lines unless they steal
+struct nonce_search_worker
+{
+	// (end << 32) | begin, nonces [begin, end) are not taken yet
+	std::atomic<uint64_t> range;
+
+	// Only written by this worker
+	std::atomic<uint64_t> hashes;
+
+	uint8_t padding[CACHE_LINE_SIZE - sizeof(std::atomic<uint64_t>) * 2];
+
+	nonce_search* search;
+	uint32_t cpu;
+	int node;
+	std::thread thread;
+
+	// Set by the worker thread once its contexts are allocated, for placement reports
+	std::atomic<bool> ctx_ready;
+	cryptonight_ctx* ctx[KERNEL_CACHE_MAX_WAYS];
+	std::atomic<const void*> code;
+};
+
+struct nonce_search
+{
+	nonce_search_hash_funcs funcs;
+	uint32_t ways;
+	std::vector<nonce_search_worker*> workers;
+
+	// One per node used by workers, index 0 is also used when node is unknown
+	kernel_cache* caches[NUMA_MAX_NODES];
+
+	// Changed on every start and stop, workers check it between batches, so it has its own cache line
+	uint8_t padding0[CACHE_LINE_SIZE];
+	std::atomic<uint32_t> generation;
+	uint8_t padding1[CACHE_LINE_SIZE];
+
+	std::mutex mutex;
+	std::condition_variable job_changed;
+	std::condition_variable worker_idle;
+	nonce_search_job job;
+	bool active;
+	bool quit;
+	uint32_t num_busy;
+	uint32_t num_finished;
+
+	std::mutex results_mutex;
+	std::vector<nonce_search_result> results;
+};
+
+static inline uint64_t make_range(uint32_t begin, uint32_t end)
+{
+	return (static_cast<uint64_t>(end) << 32) | begin;
+}
+
+static inline uint32_t range_begin(uint64_t range) { return static_cast<uint32_t>(range); }
+static inline uint32_t range_end(uint64_t range) { return static_cast<uint32_t>(range >> 32); }
+
+// Takes up to max_count nonces from the front of worker's own range
+static uint32_t take_nonces(nonce_search_worker* worker, uint32_t max_count, uint32_t* first)
+{
+	uint64_t range = worker->range.load(std::memory_order_relaxed);
+	for (;;)
+	{
+		const uint32_t begin = range_begin(range);
+		const uint32_t end = range_end(range);
+		if (begin >= end)
+		{
+			return 0;
+		}
+
+		const uint32_t count = ((end - begin) < max_count) ? (end - begin) : max_count;
+		if (worker->range.compare_exchange_weak(range, make_range(begin + count, end), std::memory_order_relaxed))
+		{
+			*first = begin;
+			return count;
+		}
+	}
+}
+
+// Moves the upper half of the largest range to the worker's own (empty) range
+static bool steal_nonces(nonce_search_worker* worker)
+{
+	nonce_search* search = worker->search;
+
+	for (;;)
+	{
+		nonce_search_worker* victim = nullptr;
+		uint64_t victim_range = 0;
+		uint32_t max_size = 1;
+
+		for (nonce_search_worker* w : search->workers)
+		{
+			const uint64_t range = w->range.load(std::memory_order_relaxed);
+			const uint32_t size = (range_end(range) > range_begin(range)) ? (range_end(range) - range_begin(range)) : 0;
+			if (size > max_size)
+			{
+				victim = w;
+				victim_range = range;
+				max_size = size;
+			}
+		}
+
+		// Single remaining nonces are left to their owners
+		if (!victim)
+		{
+			return false;
+		}
+
+		const uint32_t begin = range_begin(victim_range);
+		const uint32_t end = range_end(victim_range);
+		const uint32_t mid = begin + (end - begin) / 2;
+		if (victim->range.compare_exchange_strong(victim_range, make_range(begin, mid), std::memory_order_relaxed))
+		{
+			// Nobody else writes to an empty range, so a plain store is enough
+			worker->range.store(make_range(mid, end), std::memory_order_relaxed);
+			return true;
+		}
+	}
+}
+
+static void pin_thread(uint32_t cpu)
+{
+#ifdef _WIN32
+	SetThreadAffinityMask(GetCurrentThread(), static_cast<DWORD_PTR>(1) << (cpu % (sizeof(DWORD_PTR) * 8)));
+#else
+	cpu_set_t set;
+	CPU_ZERO(&set);
+	CPU_SET(cpu % CPU_SETSIZE, &set);
+	pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+#endif
+}
+
+static inline uint32_t cache_index(int node)
+{
+	return (node >= 0) ? static_cast<uint32_t>(node) : 0;
+}
+
+static void run_kernel(const kernel_cache_entry* kernel, uint32_t ways, cryptonight_ctx** ctx)
+{
+	switch (ways)
+	{
+	case 1:
+		((mainloop_func) kernel->func)(ctx[0]);
+		break;
+
+	case 2:
+		((mainloop_double_func) kernel->func)(ctx[0], ctx[1]);
+		break;
+
+	default:
+		((mainloop_multi_func) kernel->func)(ctx);
+		break;
+	}
+}
+
+static void run_job(nonce_search_worker* worker, const nonce_search_job& job, uint32_t generation, cryptonight_ctx** ctx)
+{
+	nonce_search* search = worker->search;
+	const uint32_t ways = search->ways;
+
+	kernel_cache* cache = search->caches[cache_index(worker->node)];
+	const kernel_cache_entry* kernel = kernel_cache_acquire(cache, job.height, ways);
+	if (!kernel)
+	{
+		return;
+	}
+	worker->code.store(kernel->func, std::memory_order_relaxed);
+
+	uint8_t blob[KERNEL_CACHE_MAX_WAYS][NONCE_SEARCH_MAX_BLOB_SIZE];
+	for (uint32_t i = 0; i < ways; ++i)
+	{
+		memcpy(blob[i], job.blob, job.blob_size);
+	}
+
+	while (search->generation.load(std::memory_order_relaxed) == generation)
+	{
+		uint32_t nonces[KERNEL_CACHE_MAX_WAYS];
+		uint32_t n = 0;
+		while (n < ways)
+		{
+			uint32_t first;
+			const uint32_t count = take_nonces(worker, ways - n, &first);
+			if (count > 0)
+			{
+				for (uint32_t i = 0; i < count; ++i)
+				{
+					nonces[n++] = first + i;
+				}
+			}
+			else if (!steal_nonces(worker))
+			{
+				break;
+			}
+		}
+
+		if (n == 0)
+		{
+			break;
+		}
+
+		// Unused lanes (at the end of nonce space) run on their old state, their results are ignored
+		for (uint32_t i = 0; i < n; ++i)
+		{
+			memcpy(blob[i] + job.nonce_offset, &nonces[i], sizeof(uint32_t));
+			search->funcs.prepare(ctx[i], blob[i], job.blob_size);
+		}
+
+		run_kernel(kernel, ways, ctx);
+
+		for (uint32_t i = 0; i < n; ++i)
+		{
+			nonce_search_result result;
+			result.nonce = nonces[i];
+			search->funcs.finish(ctx[i], result.hash);
+
+			uint64_t value;
+			memcpy(&value, result.hash + 24, sizeof(value));
+			if (value < job.target)
+			{
+				std::lock_guard<std::mutex> lock(search->results_mutex);
+				search->results.push_back(result);
+			}
+		}
+
+		worker->hashes.store(worker->hashes.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+	}
+
+	kernel_cache_release(cache, kernel);
+}
+
+static void worker_thread(nonce_search_worker* worker)
+{
+	nonce_search* search = worker->search;
+	pin_thread(worker->cpu);
+
+	// Allocated after pinning, so even without binding the first touch puts them on this CPU's node
+	cryptonight_ctx** ctx = worker->ctx;
+	bool allocated = true;
+	for (uint32_t i = 0; i < search->ways; ++i)
+	{
+		ctx[i] = numa_alloc_ctx(worker->node);
+		allocated = allocated && ctx[i];
+	}
+	worker->ctx_ready.store(allocated, std::memory_order_release);
+
+	uint32_t generation = 0;
+
+	std::unique_lock<std::mutex> lock(search->mutex);
+	for (;;)
+	{
+		search->job_changed.wait(lock, [search, generation]() { return search->quit || (search->active && (search->generation.load(std::memory_order_relaxed) != generation)); });
+		if (search->quit)
+		{
+			break;
+		}
+
+		generation = search->generation.load(std::memory_order_relaxed);
+		const nonce_search_job job = search->job;
+		++search->num_busy;
+		lock.unlock();
+
+		if (allocated)
+		{
+			run_job(worker, job, generation, ctx);
+		}
+
+		lock.lock();
+		--search->num_busy;
+		if (search->generation.load(std::memory_order_relaxed) == generation)
+		{
+			++search->num_finished;
+		}
+		search->worker_idle.notify_all();
+	}
+	lock.unlock();
+
+	worker->ctx_ready.store(false, std::memory_order_relaxed);
+	for (uint32_t i = 0; i < search->ways; ++i)
+	{
+		numa_free_ctx(ctx[i]);
+	}
+}
+
+nonce_search* nonce_search_create(uint32_t num_threads, const uint32_t* cpus, uint32_t ways, const nonce_search_hash_funcs& funcs)
+{
+	if ((num_threads == 0) || (num_threads > NONCE_SEARCH_MAX_THREADS) || (ways == 0) || (ways > KERNEL_CACHE_MAX_WAYS) || !funcs.prepare || !funcs.finish)
+	{
+		return nullptr;
+	}
+
+	nonce_search* search = new nonce_search();
+	search->funcs = funcs;
+	search->ways = ways;
+	memset(search->caches, 0, sizeof(search->caches));
+	search->generation = 0;
+	search->active = false;
+	search->quit = false;
+	search->num_busy = 0;
+	search->num_finished = 0;
+	memset(&search->job, 0, sizeof(search->job));
+
+	for (uint32_t i = 0; i < num_threads; ++i)
+	{
+		nonce_search_worker* worker = new (_mm_malloc(sizeof(nonce_search_worker), CACHE_LINE_SIZE)) nonce_search_worker();
+		worker->range = make_range(0, 0);
+		worker->hashes = 0;
+		worker->search = search;
+		worker->cpu = cpus ? cpus[i] : i;
+		worker->node = numa_get_cpu_node(worker->cpu);
+		worker->ctx_ready = false;
+		memset(worker->ctx, 0, sizeof(worker->ctx));
+		worker->code = nullptr;
+		search->workers.push_back(worker);
+
+		// Current height and KERNEL_CACHE_LOOKAHEAD next heights, plus the previous height while a job switches
+		kernel_cache*& cache = search->caches[cache_index(worker->node)];
+		if (!cache)
+		{
+			cache = kernel_cache_create_on_node(2 + KERNEL_CACHE_LOOKAHEAD, 1U << ways, 1, worker->node);
+		}
+		if (!cache)
+		{
+			for (nonce_search_worker* w : search->workers)
+			{
+				w->~nonce_search_worker();
+				_mm_free(w);
+			}
+			for (kernel_cache* c : search->caches)
+			{
+				if (c)
+				{
+					kernel_cache_destroy(c);
+				}
+			}
+			delete search;
+			return nullptr;
+		}
+	}
+
+	for (nonce_search_worker* worker : search->workers)
+	{
+		worker->thread = std::thread(worker_thread, worker);
+	}
+
+	return search;
+}
+
+void nonce_search_destroy(nonce_search* search)
+{
+	nonce_search_stop(search);
+
+	{
+		std::lock_guard<std::mutex> lock(search->mutex);
+		search->quit = true;
+	}
+	search->job_changed.notify_all();
+
+	for (nonce_search_worker* worker : search->workers)
+	{
+		worker->thread.join();
+		worker->~nonce_search_worker();
+		_mm_free(worker);
+	}
+
+	for (kernel_cache* cache : search->caches)
+	{
+		if (cache)
+		{
+			kernel_cache_destroy(cache);
+		}
+	}
+	delete search;
+}
+
+void nonce_search_stop(nonce_search* search)
+{
+	std::unique_lock<std::mutex> lock(search->mutex);
+	search->active = false;
+	search->generation.fetch_add(1, std::memory_order_relaxed);
+	search->worker_idle.wait(lock, [search]() { return search->num_busy == 0; });
+}
+
+bool nonce_search_start(nonce_search* search, const nonce_search_job& job)
+{
+	if ((job.blob_size > NONCE_SEARCH_MAX_BLOB_SIZE) || (job.nonce_offset + sizeof(uint32_t) > job.blob_size) || (job.first_nonce >= job.last_nonce))
+	{
+		return false;
+	}
+
+	nonce_search_stop(search);
+	for (kernel_cache* cache : search->caches)
+	{
+		if (cache)
+		{
+			kernel_cache_set_height(cache, job.height);
+		}
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(search->mutex);
+		search->job = job;
+
+		// All workers are idle, so ranges can be written directly
+		const uint32_t num_workers = static_cast<uint32_t>(search->workers.size());
+		const uint32_t total = job.last_nonce - job.first_nonce;
+		for (uint32_t i = 0; i < num_workers; ++i)
+		{
+			const uint32_t begin = job.first_nonce + static_cast<uint32_t>(static_cast<uint64_t>(total) * i / num_workers);
+			const uint32_t end = job.first_nonce + static_cast<uint32_t>(static_cast<uint64_t>(total) * (i + 1) / num_workers);
+			search->workers[i]->range.store(make_range(begin, end), std::memory_order_relaxed);
+		}
+
+		search->num_finished = 0;
+		search->active = true;
+		search->generation.fetch_add(1, std::memory_order_relaxed);
+	}
+	search->job_changed.notify_all();
+	return true;
+}
+
+void nonce_search_wait(nonce_search* search)
+{
+	std::unique_lock<std::mutex> lock(search->mutex);
+	const uint32_t generation = search->generation.load(std::memory_order_relaxed);
+	search->worker_idle.wait(lock, [search, generation]()
+	{
+		return !search->active || (search->generation.load(std::memory_order_relaxed) != generation) || (search->num_finished == search->workers.size());
+	});
+}
+
+void nonce_search_get_results(nonce_search* search, std::vector<nonce_search_result>& results)
+{
+	std::lock_guard<std::mutex> lock(search->results_mutex);
+	results.insert(results.end(), search->results.begin(), search->results.end());
+	search->results.clear();
+}
+
+uint64_t nonce_search_get_hashes(nonce_search* search)
+{
+	uint64_t total = 0;
+	for (const nonce_search_worker* worker : search->workers)
+	{
+		total += worker->hashes.load(std::memory_order_relaxed);
+	}
+	return total;
+}
+
+uint32_t nonce_search_get_num_threads(nonce_search* search)
+{
+	return static_cast<uint32_t>(search->workers.size());
+}
+
+bool nonce_search_get_worker_info(nonce_search* search, uint32_t index, nonce_search_worker_info& info)
+{
+	if (index >= search->workers.size())
+	{
+		return false;
+	}
+
+	const nonce_search_worker* worker = search->workers[index];
+	info.cpu = worker->cpu;
+	info.node = worker->node;
+	info.hashes = worker->hashes.load(std::memory_order_relaxed);
+	info.local_pages = 0;
+	info.remote_pages = 0;
+	info.code_node = NUMA_NODE_ANY;
+	info.page_kind = PAGES_NONE;
+
+	if (!worker->ctx_ready.load(std::memory_order_acquire))
+	{
+		return false;
+	}
+
+	uint64_t pages[NUMA_MAX_NODES];
+	uint64_t total[NUMA_MAX_NODES] = {};
+	for (uint32_t i = 0; i < search->ways; ++i)
+	{
+		const large_page_kind kind = numa_get_ctx_page_kind(worker->ctx[i]);
+		if ((i == 0) || (kind < info.page_kind))
+		{
+			info.page_kind = kind;
+		}
+
+		if (!numa_get_pages_per_node(worker->ctx[i], sizeof(cryptonight_ctx), pages))
+		{
+			return false;
+		}
+		for (int j = 0; j < NUMA_MAX_NODES; ++j)
+		{
+			total[j] += pages[j];
+		}
+
+		if (!numa_get_pages_per_node(worker->ctx[i]->long_state, MEMORY, pages))
+		{
+			return false;
+		}
+		for (int j = 0; j < NUMA_MAX_NODES; ++j)
+		{
+			total[j] += pages[j];
+		}
+	}
+
+	// Unknown node (no NUMA support) is reported as node 0
+	const int node = (worker->node >= 0) ? worker->node : 0;
+	for (int j = 0; j < NUMA_MAX_NODES; ++j)
+	{
+		if (j == node)
+		{
+			info.local_pages += total[j];
+		}
+		else
+		{
+			info.remote_pages += total[j];
+		}
+	}
+
+	const void* code = worker->code.load(std::memory_order_relaxed);
+	if (code && numa_get_pages_per_node(code, 1, pages))
+	{
+		for (int j = 0; j < NUMA_MAX_NODES; ++j)
+		{
+			if (pages[j])
+			{
+				info.code_node = j;
+			}
+		}
+	}
+
+	return true;
+}
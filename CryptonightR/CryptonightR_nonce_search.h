@@ -0,0 +1,102 @@
+#pragma once
+
+#include "definitions.h"
+#include "CryptonightR_large_pages.h"
+#include <vector>
+
+// Multi-threaded nonce search for one job (blob, height, target)
+//
+// Every worker is pinned to its own CPU, allocates its contexts there and runs the kernel for the job's height
+// from a shared kernel cache. Nonce space is split between workers at the start of a job. A worker takes nonces
+// from the front of its own range, and when it's empty it steals the upper half of the largest remaining range.
+// A range is a single 64-bit word (begin, end) changed with CAS, so there are no locks on the hot path and
+// workers only touch each other's cache lines when stealing.
+//
+// Hash input preparation and final hash are callbacks, the engine only owns threads, contexts and main loop kernels.
+//
+// Contexts, scratchpads and generated code are bound to the NUMA node of the worker's CPU (CryptonightR_numa.h),
+// every node gets its own kernel cache.
+
+enum
+{
+	NONCE_SEARCH_MAX_BLOB_SIZE = 128,
+	NONCE_SEARCH_MAX_THREADS = 256,
+};
+
+struct nonce_search_hash_funcs
+{
+	// Fills ctx->hash_state and ctx->long_state for the blob (nonce is already written into it)
+	void (*prepare)(cryptonight_ctx* ctx, const uint8_t* blob, uint32_t blob_size);
+
+	// Writes 32-byte hash after the main loop
+	void (*finish)(cryptonight_ctx* ctx, uint8_t* hash);
+};
+
+struct nonce_search_job
+{
+	uint8_t blob[NONCE_SEARCH_MAX_BLOB_SIZE];
+	uint32_t blob_size;
+
+	// 32-bit little endian nonce is written here
+	uint32_t nonce_offset;
+
+	uint64_t height;
+
+	// Hash is accepted if its last 8 bytes (as little endian number) are below target
+	uint64_t target;
+
+	// Nonces [first_nonce, last_nonce) are searched, so 0xFFFFFFFF is never used
+	uint32_t first_nonce;
+	uint32_t last_nonce;
+};
+
+struct nonce_search_result
+{
+	uint32_t nonce;
+	uint8_t hash[32];
+};
+
+// Where worker's memory actually is, to check that the main loop doesn't go to other nodes
+struct nonce_search_worker_info
+{
+	uint32_t cpu;
+	int node;
+	uint64_t hashes;
+
+	// Resident pages of contexts and scratchpads on worker's node and on other nodes
+	uint64_t local_pages;
+	uint64_t remote_pages;
+
+	// Node of the last kernel used by the worker, NUMA_NODE_ANY if it's unknown
+	int code_node;
+
+	// Smallest page size among worker's scratchpads
+	large_page_kind page_kind;
+};
+
+struct nonce_search;
+
+// ways is 1 (single), 2 (double) or 3-5 (generated multi-way kernels)
+// cpus can be nullptr, then thread i runs on CPU i
+nonce_search* nonce_search_create(uint32_t num_threads, const uint32_t* cpus, uint32_t ways, const nonce_search_hash_funcs& funcs);
+void nonce_search_destroy(nonce_search* search);
+
+// Stops the current job (if any) and starts searching for the new one
+bool nonce_search_start(nonce_search* search, const nonce_search_job& job);
+
+// Waits until all workers are idle, no results are added after it returns
+void nonce_search_stop(nonce_search* search);
+
+// Waits until the whole nonce range of the current job is searched
+void nonce_search_wait(nonce_search* search);
+
+// Moves found results to the caller
+void nonce_search_get_results(nonce_search* search, std::vector<nonce_search_result>& results);
+
+// Total number of hashes done by all workers since creation
+uint64_t nonce_search_get_hashes(nonce_search* search);
+
+uint32_t nonce_search_get_num_threads(nonce_search* search);
+
+// Returns false if worker's memory placement can't be queried
+bool nonce_search_get_worker_info(nonce_search* search, uint32_t index, nonce_search_worker_info& info);
@@ -0,0 +1,292 @@
+#include "CryptonightR_numa.h"
+#include <stdio.h>
+
+#ifdef _WIN32
+#define NOMINMAX
+#define WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+#include <Psapi.h>
+#else
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#ifndef MPOL_BIND
+#define MPOL_BIND 2
+#endif
+#endif
+
+enum
+{
+	// Pages queried per syscall
+	QUERY_BATCH = 512,
+};
+
+static size_t get_page_size()
+{
+#ifdef _WIN32
+	SYSTEM_INFO info;
+	GetSystemInfo(&info);
+	return info.dwPageSize;
+#else
+	return static_cast<size_t>(sysconf(_SC_PAGESIZE));
+#endif
+}
+
+static const size_t page_size = get_page_size();
+
+static inline size_t round_up_to_page(size_t size)
+{
+	return (size + page_size - 1) & ~(page_size - 1);
+}
+
+#ifndef _WIN32
+static bool path_exists(const char* path)
+{
+	return access(path, F_OK) == 0;
+}
+#endif
+
+uint32_t numa_get_node_count()
+{
+#ifdef _WIN32
+	ULONG highest_node;
+	if (!GetNumaHighestNodeNumber(&highest_node))
+	{
+		return 1;
+	}
+	return highest_node + 1;
+#else
+	uint32_t count = 1;
+	for (uint32_t node = 1; node < NUMA_MAX_NODES; ++node)
+	{
+		char path[64];
+		snprintf(path, sizeof(path), "/sys/devices/system/node/node%u", node);
+		if (path_exists(path))
+		{
+			count = node + 1;
+		}
+	}
+	return count;
+#endif
+}
+
+int numa_get_current_node()
+{
+#ifdef _WIN32
+	PROCESSOR_NUMBER processor;
+	GetCurrentProcessorNumberEx(&processor);
+
+	USHORT node;
+	if (!GetNumaProcessorNodeEx(&processor, &node))
+	{
+		return NUMA_NODE_ANY;
+	}
+	return node;
+#else
+	unsigned int cpu, node;
+	if (syscall(SYS_getcpu, &cpu, &node, nullptr) != 0)
+	{
+		return NUMA_NODE_ANY;
+	}
+	return static_cast<int>(node);
+#endif
+}
+
+int numa_get_cpu_node(uint32_t cpu)
+{
+#ifdef _WIN32
+	PROCESSOR_NUMBER processor = {};
+	processor.Group = static_cast<WORD>(cpu / 64);
+	processor.Number = static_cast<BYTE>(cpu % 64);
+
+	USHORT node;
+	if (!GetNumaProcessorNodeEx(&processor, &node) || (node == 0xFFFF))
+	{
+		return NUMA_NODE_ANY;
+	}
+	return node;
+#else
+	for (int node = 0; node < NUMA_MAX_NODES; ++node)
+	{
+		char path[96];
+		snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%u/node%d", cpu, node);
+		if (path_exists(path))
+		{
+			return node;
+		}
+	}
+	return NUMA_NODE_ANY;
+#endif
+}
+
+bool numa_bind(void* ptr, size_t size, int node)
+{
+	if ((node < 0) || (node >= NUMA_MAX_NODES))
+	{
+		return false;
+	}
+
+#ifdef _WIN32
+	// Placement is chosen at allocation time (VirtualAllocExNuma)
+	(void)ptr;
+	(void)size;
+	return false;
+#else
+	unsigned long mask[NUMA_MAX_NODES / (sizeof(unsigned long) * 8)] = {};
+	mask[node / (sizeof(unsigned long) * 8)] = 1UL << (node % (sizeof(unsigned long) * 8));
+
+	// Kernel ignores the last bit of maxnode
+	return syscall(SYS_mbind, ptr, size, MPOL_BIND, mask, NUMA_MAX_NODES + 1, 0) == 0;
+#endif
+}
+
+void* numa_alloc(size_t size, int node)
+{
+	size = round_up_to_page(size);
+
+#ifdef _WIN32
+	uint8_t* p;
+	if (node >= 0)
+	{
+		p = (uint8_t*) VirtualAllocExNuma(GetCurrentProcess(), NULL, size, MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE, static_cast<DWORD>(node));
+	}
+	else
+	{
+		p = (uint8_t*) VirtualAlloc(NULL, size, MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE);
+	}
+	if (!p)
+	{
+		return nullptr;
+	}
+#else
+	uint8_t* p = (uint8_t*) mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (p == MAP_FAILED)
+	{
+		return nullptr;
+	}
+	numa_bind(p, size, node);
+#endif
+
+	// Pages are placed on first touch, so do it now and not in the main loop
+	for (size_t i = 0; i < size; i += page_size)
+	{
+		p[i] = 0;
+	}
+
+	return p;
+}
+
+void numa_free(void* ptr, size_t size)
+{
+	if (!ptr)
+	{
+		return;
+	}
+
+#ifdef _WIN32
+	(void)size;
+	VirtualFree(ptr, 0, MEM_RELEASE);
+#else
+	munmap(ptr, round_up_to_page(size));
+#endif
+}
+
+bool numa_get_pages_per_node(const void* ptr, size_t size, uint64_t* pages_per_node)
+{
+	memset(pages_per_node, 0, NUMA_MAX_NODES * sizeof(uint64_t));
+
+	const uintptr_t begin = reinterpret_cast<uintptr_t>(ptr) & ~(page_size - 1);
+	const uintptr_t end = reinterpret_cast<uintptr_t>(ptr) + size;
+
+	for (uintptr_t p = begin; p < end;)
+	{
+		uint32_t count = 0;
+
+#ifdef _WIN32
+		PSAPI_WORKING_SET_EX_INFORMATION info[QUERY_BATCH];
+		for (; (count < QUERY_BATCH) && (p < end); ++count, p += page_size)
+		{
+			info[count].VirtualAddress = reinterpret_cast<void*>(p);
+		}
+
+		if (!QueryWorkingSetEx(GetCurrentProcess(), info, count * sizeof(PSAPI_WORKING_SET_EX_INFORMATION)))
+		{
+			return false;
+		}
+
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			if (info[i].VirtualAttributes.Valid && (info[i].VirtualAttributes.Node < NUMA_MAX_NODES))
+			{
+				++pages_per_node[info[i].VirtualAttributes.Node];
+			}
+		}
+#else
+		void* pages[QUERY_BATCH];
+		int status[QUERY_BATCH];
+		for (; (count < QUERY_BATCH) && (p < end); ++count, p += page_size)
+		{
+			pages[count] = reinterpret_cast<void*>(p);
+		}
+
+		// move_pages without target nodes only reports where pages are
+		if (syscall(SYS_move_pages, 0, count, pages, nullptr, status, 0) != 0)
+		{
+			return false;
+		}
+
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			if ((status[i] >= 0) && (status[i] < NUMA_MAX_NODES))
+			{
+				++pages_per_node[status[i]];
+			}
+		}
+#endif
+	}
+
+	return true;
+}
+
+// Scratchpad allocation is kept next to the context, so it can be freed and reported later
+struct numa_ctx
+{
+	cryptonight_ctx ctx;
+	large_page_alloc long_state;
+};
+
+cryptonight_ctx* numa_alloc_ctx(int node)
+{
+	numa_ctx* p = (numa_ctx*) numa_alloc(sizeof(numa_ctx), node);
+	if (!p)
+	{
+		return nullptr;
+	}
+
+	if (!large_pages_alloc(&p->long_state, MEMORY, node))
+	{
+		numa_free(p, sizeof(numa_ctx));
+		return nullptr;
+	}
+
+	p->ctx.long_state = p->long_state.ptr;
+	return &p->ctx;
+}
+
+void numa_free_ctx(cryptonight_ctx* ctx)
+{
+	if (!ctx)
+	{
+		return;
+	}
+
+	numa_ctx* p = reinterpret_cast<numa_ctx*>(ctx);
+	large_pages_free(&p->long_state);
+	numa_free(p, sizeof(numa_ctx));
+}
+
+large_page_kind numa_get_ctx_page_kind(const cryptonight_ctx* ctx)
+{
+	return reinterpret_cast<const numa_ctx*>(ctx)->long_state.kind;
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include "definitions.h"
+#include "CryptonightR_large_pages.h"
+
+// NUMA node placement for scratchpads, contexts and generated code
+//
+// Main loop does random 16-byte accesses all over a 2 MB scratchpad, so every L3 miss to a remote node pays
+// the interconnect latency. Memory is bound to the node of the thread which uses it before it's touched.
+//
+// Linux: mbind/move_pages/getcpu syscalls (no libnuma dependency)
+// Windows: VirtualAllocExNuma, QueryWorkingSetEx, GetNumaProcessorNodeEx
+//
+// Everything works on single node machines and systems without NUMA support, binding is just skipped.
+
+enum
+{
+	NUMA_NODE_ANY = -1,
+	NUMA_MAX_NODES = 64,
+};
+
+uint32_t numa_get_node_count();
+
+// Node of the CPU the calling thread runs on, NUMA_NODE_ANY if unknown
+int numa_get_current_node();
+
+// Node of a logical CPU, NUMA_NODE_ANY if unknown
+int numa_get_cpu_node(uint32_t cpu);
+
+// Page-aligned zero-filled memory, all pages are touched, so they are already placed when this returns
+void* numa_alloc(size_t size, int node);
+void numa_free(void* ptr, size_t size);
+
+// Binds not yet touched memory to the node, returns false if it's not supported
+bool numa_bind(void* ptr, size_t size, int node);
+
+// Counts resident pages of [ptr, ptr + size) per node, pages_per_node must have NUMA_MAX_NODES elements
+// Returns false if page placement can't be queried
+bool numa_get_pages_per_node(const void* ptr, size_t size, uint64_t* pages_per_node);
+
+// Context and its scratchpad on the node, scratchpad is in the largest pages available (CryptonightR_large_pages.h)
+cryptonight_ctx* numa_alloc_ctx(int node);
+void numa_free_ctx(cryptonight_ctx* ctx);
+
+// Page size which the context's scratchpad actually got
+large_page_kind numa_get_ctx_page_kind(const cryptonight_ctx* ctx);
@@ -0,0 +1,252 @@
+#include "CryptonightR_perf.h"
+#include <string.h>
+
+#ifndef _WIN32
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#ifndef _WIN32
+
+struct perf_event_desc
+{
+	const char* name;
+	uint32_t type;
+	uint64_t config;
+};
+
+struct perf_counters
+{
+	int fds[PERF_MAX_COUNTERS];
+	const char* names[PERF_MAX_COUNTERS];
+	uint32_t count;
+};
+
+static uint64_t cache_event(uint64_t cache, uint64_t op, uint64_t result)
+{
+	return cache | (op << 8) | (result << 16);
+}
+
+// Intel raw event: event select | unit mask
+static uint64_t intel_event(uint64_t event, uint64_t umask)
+{
+	return event | (umask << 8);
+}
+
+// Appends events which depend on the CPU model
+static uint32_t get_model_events(perf_event_desc* events)
+{
+	int data[4];
+	__cpuidex(data, 0, 0);
+	char vendor[13] = {};
+	memcpy(vendor + 0, &data[1], 4);
+	memcpy(vendor + 4, &data[3], 4);
+	memcpy(vendor + 8, &data[2], 4);
+
+	__cpuidex(data, 1, 0);
+	const uint32_t family = ((data[0] >> 8) & 15) + ((data[0] >> 20) & 255);
+	const uint32_t model = ((data[0] >> 4) & 15) | ((data[0] >> 12) & 0xF0);
+
+	uint32_t n = 0;
+
+	if ((strcmp(vendor, "AuthenticAMD") == 0) || (strcmp(vendor, "HygonGenuine") == 0))
+	{
+		// L2CacheReqStat: instruction and data cache misses in L2
+		if (family >= 0x17)
+		{
+			events[n++] = { "L2 misses", PERF_TYPE_RAW, intel_event(0x64, 0x09) };
+		}
+		return n;
+	}
+
+	if ((strcmp(vendor, "GenuineIntel") != 0) || (family != 6))
+	{
+		return n;
+	}
+
+	// Sandy Bridge, Sandy Bridge-E, Ivy Bridge, Ivy Bridge-E: UOPS_DISPATCHED_PORT, loads and store data share ports
+	if ((model == 0x2A) || (model == 0x2D) || (model == 0x3A) || (model == 0x3E))
+	{
+		events[n++] = { "uops port 0", PERF_TYPE_RAW, intel_event(0xA1, 0x01) };
+		events[n++] = { "uops port 1", PERF_TYPE_RAW, intel_event(0xA1, 0x02) };
+		events[n++] = { "uops port 2", PERF_TYPE_RAW, intel_event(0xA1, 0x0C) };
+		events[n++] = { "uops port 3", PERF_TYPE_RAW, intel_event(0xA1, 0x30) };
+		events[n++] = { "uops port 4", PERF_TYPE_RAW, intel_event(0xA1, 0x40) };
+		events[n++] = { "uops port 5", PERF_TYPE_RAW, intel_event(0xA1, 0x80) };
+		return n;
+	}
+
+	// Ice Lake, Tiger Lake, Rocket Lake, Sapphire Rapids, Emerald Rapids: some ports are counted together
+	if ((model == 0x6A) || (model == 0x6C) || (model == 0x7D) || (model == 0x7E) || (model == 0x8C) || (model == 0x8D) ||
+		(model == 0x8F) || (model == 0xA7) || (model == 0xCF))
+	{
+		events[n++] = { "L2 misses", PERF_TYPE_RAW, intel_event(0x24, 0x3F) };
+		events[n++] = { "uops port 0", PERF_TYPE_RAW, intel_event(0xA1, 0x01) };
+		events[n++] = { "uops port 1", PERF_TYPE_RAW, intel_event(0xA1, 0x02) };
+		events[n++] = { "uops ports 2, 3, 10", PERF_TYPE_RAW, intel_event(0xA1, 0x04) };
+		events[n++] = { "uops ports 4, 9", PERF_TYPE_RAW, intel_event(0xA1, 0x10) };
+		events[n++] = { "uops ports 5, 11", PERF_TYPE_RAW, intel_event(0xA1, 0x20) };
+		events[n++] = { "uops port 6", PERF_TYPE_RAW, intel_event(0xA1, 0x40) };
+		events[n++] = { "uops ports 7, 8", PERF_TYPE_RAW, intel_event(0xA1, 0x80) };
+		return n;
+	}
+
+	// Haswell, Broadwell, Skylake and its derivatives: UOPS_EXECUTED_PORT/UOPS_DISPATCHED_PORT for ports 0-7
+	// Hybrid CPUs (Alder Lake and later) have separate PMUs for P and E cores, raw events are skipped there
+	if ((model == 0x3C) || (model == 0x3F) || (model == 0x45) || (model == 0x46) || (model == 0x3D) || (model == 0x47) ||
+		(model == 0x4F) || (model == 0x56) || (model == 0x4E) || (model == 0x5E) || (model == 0x55) || (model == 0x8E) ||
+		(model == 0x9E) || (model == 0xA5) || (model == 0xA6) || (model == 0x66))
+	{
+		static const char* port_names[8] = {
+			"uops port 0", "uops port 1", "uops port 2", "uops port 3",
+			"uops port 4", "uops port 5", "uops port 6", "uops port 7",
+		};
+
+		events[n++] = { "L2 misses", PERF_TYPE_RAW, intel_event(0x24, 0x3F) };
+		for (uint32_t i = 0; i < 8; ++i)
+		{
+			events[n++] = { port_names[i], PERF_TYPE_RAW, intel_event(0xA1, 1U << i) };
+		}
+	}
+
+	return n;
+}
+
+static int open_event(const perf_event_desc& desc)
+{
+	perf_event_attr attr;
+	memset(&attr, 0, sizeof(attr));
+	attr.size = sizeof(attr);
+	attr.type = desc.type;
+	attr.config = desc.config;
+	attr.disabled = 1;
+	attr.exclude_kernel = 1;
+	attr.exclude_hv = 1;
+	attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+	return static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, PERF_FLAG_FD_CLOEXEC));
+}
+
+perf_counters* perf_counters_create()
+{
+	perf_event_desc events[PERF_MAX_COUNTERS];
+	uint32_t n = 0;
+
+	events[n++] = { "cycles", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES };
+	events[n++] = { "instructions", PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS };
+	events[n++] = { "L1D misses", PERF_TYPE_HW_CACHE, cache_event(PERF_COUNT_HW_CACHE_L1D, PERF_COUNT_HW_CACHE_OP_READ, PERF_COUNT_HW_CACHE_RESULT_MISS) };
+	events[n++] = { "LLC misses", PERF_TYPE_HW_CACHE, cache_event(PERF_COUNT_HW_CACHE_LL, PERF_COUNT_HW_CACHE_OP_READ, PERF_COUNT_HW_CACHE_RESULT_MISS) };
+	events[n++] = { "dTLB misses", PERF_TYPE_HW_CACHE, cache_event(PERF_COUNT_HW_CACHE_DTLB, PERF_COUNT_HW_CACHE_OP_READ, PERF_COUNT_HW_CACHE_RESULT_MISS) };
+	n += get_model_events(events + n);
+
+	perf_counters* counters = new perf_counters();
+	counters->count = 0;
+
+	for (uint32_t i = 0; i < n; ++i)
+	{
+		const int fd = open_event(events[i]);
+		if (fd >= 0)
+		{
+			counters->fds[counters->count] = fd;
+			counters->names[counters->count] = events[i].name;
+			++counters->count;
+		}
+	}
+
+	if (counters->count == 0)
+	{
+		delete counters;
+		return nullptr;
+	}
+
+	return counters;
+}
+
+void perf_counters_destroy(perf_counters* counters)
+{
+	if (!counters)
+	{
+		return;
+	}
+
+	for (uint32_t i = 0; i < counters->count; ++i)
+	{
+		close(counters->fds[i]);
+	}
+	delete counters;
+}
+
+uint32_t perf_counters_get_count(const perf_counters* counters)
+{
+	return counters->count;
+}
+
+const char* perf_counters_get_name(const perf_counters* counters, uint32_t index)
+{
+	return (index < counters->count) ? counters->names[index] : nullptr;
+}
+
+void perf_counters_start(perf_counters* counters)
+{
+	for (uint32_t i = 0; i < counters->count; ++i)
+	{
+		ioctl(counters->fds[i], PERF_EVENT_IOC_RESET, 0);
+	}
+	for (uint32_t i = 0; i < counters->count; ++i)
+	{
+		ioctl(counters->fds[i], PERF_EVENT_IOC_ENABLE, 0);
+	}
+}
+
+void perf_counters_stop(perf_counters* counters, double* values)
+{
+	for (uint32_t i = 0; i < counters->count; ++i)
+	{
+		ioctl(counters->fds[i], PERF_EVENT_IOC_DISABLE, 0);
+	}
+
+	for (uint32_t i = 0; i < counters->count; ++i)
+	{
+		// value, time_enabled, time_running
+		uint64_t data[3];
+		if ((read(counters->fds[i], data, sizeof(data)) != sizeof(data)) || (data[2] == 0))
+		{
+			values[i] = -1.0;
+			continue;
+		}
+		values[i] = static_cast<double>(data[0]) * (static_cast<double>(data[1]) / data[2]);
+	}
+}
+
+#else
+
+perf_counters* perf_counters_create()
+{
+	return nullptr;
+}
+
+void perf_counters_destroy(perf_counters*)
+{
+}
+
+uint32_t perf_counters_get_count(const perf_counters*)
+{
+	return 0;
+}
+
+const char* perf_counters_get_name(const perf_counters*, uint32_t)
+{
+	return nullptr;
+}
+
+void perf_counters_start(perf_counters*)
+{
+}
+
+void perf_counters_stop(perf_counters*, double*)
+{
+}
+
+#endif
@@ -0,0 +1,39 @@
+#pragma once
+
+#include "definitions.h"
+
+// Hardware performance counters for the calling thread (Linux perf_event_open)
+//
+// Generic events: cycles, instructions, L1D/LLC load misses, dTLB load misses.
+// Raw events where the CPU model is known: L2 misses (Intel, AMD Zen) and uops dispatched per execution port
+// (Intel Sandy Bridge and later), so it's visible if a kernel is bound by memory latency, AES ports or the
+// IMUL chain.
+//
+// There are more events than hardware counters, the kernel multiplexes them and counts are scaled by
+// time_enabled / time_running, so they're estimates for the steady-state loops measured here.
+// Only user-space events are counted, this works with perf_event_paranoid <= 2.
+//
+// Not supported on Windows and in virtual machines without a virtual PMU, perf_counters_create returns nullptr.
+
+enum
+{
+	PERF_MAX_COUNTERS = 16,
+};
+
+struct perf_counters;
+
+// Counters of the calling thread, events which can't be opened are skipped
+// Returns nullptr if none can be opened
+perf_counters* perf_counters_create();
+void perf_counters_destroy(perf_counters* counters);
+
+uint32_t perf_counters_get_count(const perf_counters* counters);
+
+// "cycles", "instructions", "L1D misses", "uops port 0" ...
+const char* perf_counters_get_name(const perf_counters* counters, uint32_t index);
+
+// Resets and starts all counters
+void perf_counters_start(perf_counters* counters);
+
+// Stops counters and writes scaled counts, negative if the event never got a hardware counter
+void perf_counters_stop(perf_counters* counters, double* values);
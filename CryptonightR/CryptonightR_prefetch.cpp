@@ -0,0 +1,117 @@
+#include "CryptonightR_prefetch.h"
+#include <string.h>
+#include <atomic>
+
+// Points in the low byte, hint in the next one
+static std::atomic<uint32_t> prefetch_setting(V4_PREFETCH_NONE);
+
+static const char* points_names[V4_PREFETCH_POINT_COUNT] = { "none", "line", "next", "both" };
+static const char* hint_names[V4_PREFETCH_HINT_COUNT] = { "t0", "t1", "t2", "nta", "w" };
+
+// "0F 18 /n" for prefetcht0/t1/t2/nta, "0F 0D /1" for prefetchw
+static const uint8_t hint_opcode[V4_PREFETCH_HINT_COUNT] = { 0x18, 0x18, 0x18, 0x18, 0x0D };
+static const uint8_t hint_modrm_reg[V4_PREFETCH_HINT_COUNT] = { 1, 2, 3, 0, 1 };
+
+enum
+{
+	// prefetch [r10+r11]
+	PREFETCH_LINE_SIZE = 5,
+
+	// lea rcx, [rsp+rdx]; xor rcx, r13; and ecx, 2097136; prefetch [rcx+r11]
+	PREFETCH_NEXT_SIZE = 4 + 3 + 6 + 5,
+};
+
+v4_prefetch v4_get_prefetch()
+{
+	const uint32_t setting = prefetch_setting.load(std::memory_order_relaxed);
+
+	v4_prefetch result;
+	result.points = setting & 0xFF;
+	result.hint = static_cast<v4_prefetch_hint>(setting >> 8);
+	return result;
+}
+
+void v4_set_prefetch(const v4_prefetch& prefetch)
+{
+	prefetch_setting.store((prefetch.points & V4_PREFETCH_BOTH) | (static_cast<uint32_t>(prefetch.hint) << 8), std::memory_order_relaxed);
+}
+
+const char* v4_prefetch_points_name(uint32_t points)
+{
+	return (points < V4_PREFETCH_POINT_COUNT) ? points_names[points] : "unknown";
+}
+
+const char* v4_prefetch_hint_name(v4_prefetch_hint hint)
+{
+	return (hint < V4_PREFETCH_HINT_COUNT) ? hint_names[hint] : "unknown";
+}
+
+bool v4_parse_prefetch(const char* s, v4_prefetch& result)
+{
+	const char* hint = strchr(s, ':');
+	const size_t points_len = hint ? static_cast<size_t>(hint - s) : strlen(s);
+
+	int points = -1;
+	for (int i = 0; i < V4_PREFETCH_POINT_COUNT; ++i)
+	{
+		if ((strlen(points_names[i]) == points_len) && (memcmp(points_names[i], s, points_len) == 0))
+		{
+			points = i;
+		}
+	}
+
+	int hint_index = hint ? -1 : V4_PREFETCH_T0;
+	for (int i = 0; hint && (i < V4_PREFETCH_HINT_COUNT); ++i)
+	{
+		if (strcmp(hint_names[i], hint + 1) == 0)
+		{
+			hint_index = i;
+		}
+	}
+
+	if ((points < 0) || (hint_index < 0))
+	{
+		return false;
+	}
+
+	result.points = static_cast<uint32_t>(points);
+	result.hint = static_cast<v4_prefetch_hint>(hint_index);
+	return true;
+}
+
+void v4_emit_prefetch(const v4_prefetch& prefetch, v4_prefetch_point point, std::vector<uint8_t>& machine_code)
+{
+	if (!(prefetch.points & point) || (prefetch.hint >= V4_PREFETCH_HINT_COUNT))
+	{
+		return;
+	}
+
+	const uint8_t opcode = hint_opcode[prefetch.hint];
+	const uint8_t modrm = static_cast<uint8_t>((hint_modrm_reg[prefetch.hint] << 3) | 4);
+
+	if (point == V4_PREFETCH_LINE)
+	{
+		// prefetch [r10+r11]
+		const uint8_t code[PREFETCH_LINE_SIZE] = { 0x43, 0x0F, opcode, modrm, 0x1A };
+		machine_code.insert(machine_code.end(), code, code + sizeof(code));
+	}
+	else if (point == V4_PREFETCH_NEXT)
+	{
+		const uint8_t code[PREFETCH_NEXT_SIZE] = {
+			0x48, 0x8D, 0x0C, 0x14,             // lea rcx, [rsp+rdx]
+			0x4C, 0x31, 0xE9,                   // xor rcx, r13
+			0x81, 0xE1, 0xF0, 0xFF, 0x1F, 0x00, // and ecx, 2097136
+			0x42, 0x0F, opcode, modrm, 0x19,    // prefetch [rcx+r11]
+		};
+		machine_code.insert(machine_code.end(), code, code + sizeof(code));
+	}
+}
+
+size_t v4_prefetch_code_size(const v4_prefetch& prefetch, v4_prefetch_point point)
+{
+	if (!(prefetch.points & point) || (prefetch.hint >= V4_PREFETCH_HINT_COUNT))
+	{
+		return 0;
+	}
+	return (point == V4_PREFETCH_LINE) ? PREFETCH_LINE_SIZE : ((point == V4_PREFETCH_NEXT) ? PREFETCH_NEXT_SIZE : 0);
+}
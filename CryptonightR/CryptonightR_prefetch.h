@@ -0,0 +1,81 @@
+#pragma once
+
+#include "definitions.h"
+#include <vector>
+
+// Software prefetching of scratchpad lines in single hash main loops
+//
+// Every scratchpad address comes from the previous load, so nothing can be prefetched more than one access ahead.
+// Instead, prefetch is issued at the earliest point where the address is known:
+// - second load (cx & 0x1FFFF0) is known right after AES round, but loaded only after the first shuffle
+// - next iteration's first load is known after multiply and the chunk load in the second shuffle,
+//   but loaded only at the top of the next iteration
+// It can help when the out-of-order window doesn't reach these loads on its own, for example with high memory latency.
+//
+// Generated code gets prefetch instructions at CryptonightR_template_prefetch_line and CryptonightR_template_prefetch_next,
+// CryptonightR_static kernels get them as template parameters.
+
+enum v4_prefetch_point
+{
+	V4_PREFETCH_NONE = 0,
+	V4_PREFETCH_LINE = 1,
+	V4_PREFETCH_NEXT = 2,
+	V4_PREFETCH_BOTH = V4_PREFETCH_LINE | V4_PREFETCH_NEXT,
+	V4_PREFETCH_POINT_COUNT,
+};
+
+enum v4_prefetch_hint
+{
+	V4_PREFETCH_T0,
+	V4_PREFETCH_T1,
+	V4_PREFETCH_T2,
+	V4_PREFETCH_NTA,
+
+	// prefetchw, both lines are written later in the same iteration
+	V4_PREFETCH_W,
+
+	V4_PREFETCH_HINT_COUNT,
+};
+
+struct v4_prefetch
+{
+	// V4_PREFETCH_NONE, V4_PREFETCH_LINE, V4_PREFETCH_NEXT or V4_PREFETCH_BOTH
+	uint32_t points;
+	v4_prefetch_hint hint;
+};
+
+// Prefetch for compile_code, none by default
+v4_prefetch v4_get_prefetch();
+void v4_set_prefetch(const v4_prefetch& prefetch);
+
+// "none", "line", "next" or "both"
+const char* v4_prefetch_points_name(uint32_t points);
+
+// "t0", "t1", "t2", "nta" or "w"
+const char* v4_prefetch_hint_name(v4_prefetch_hint hint);
+
+// "<points>[:<hint>]", hint is t0 if it's not given
+bool v4_parse_prefetch(const char* s, v4_prefetch& result);
+
+// Appends prefetch instructions for one point (V4_PREFETCH_LINE or V4_PREFETCH_NEXT), nothing if it's not enabled
+void v4_emit_prefetch(const v4_prefetch& prefetch, v4_prefetch_point point, std::vector<uint8_t>& machine_code);
+
+// Number of bytes v4_emit_prefetch appends for one point
+size_t v4_prefetch_code_size(const v4_prefetch& prefetch, v4_prefetch_point point);
+
+template<int hint>
+FORCEINLINE void v4_prefetch_address(const void* p)
+{
+	switch (hint)
+	{
+	case V4_PREFETCH_T0: _mm_prefetch((const char*)p, _MM_HINT_T0); break;
+	case V4_PREFETCH_T1: _mm_prefetch((const char*)p, _MM_HINT_T1); break;
+	case V4_PREFETCH_T2: _mm_prefetch((const char*)p, _MM_HINT_T2); break;
+	case V4_PREFETCH_NTA: _mm_prefetch((const char*)p, _MM_HINT_NTA); break;
+#ifdef __GNUC__
+	case V4_PREFETCH_W: __builtin_prefetch(p, 1, 3); break;
+#else
+	case V4_PREFETCH_W: _m_prefetchw(p); break;
+#endif
+	}
+}
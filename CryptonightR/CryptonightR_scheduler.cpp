@@ -0,0 +1,310 @@
+#include "CryptonightR_scheduler.h"
+#include <vector>
+#include <atomic>
+
+// Rotations are "D3 /r" with count in cl, plus "mov rcx, src" which is eliminated at rename on most CPUs
+// ADD is "add dst, src" + "add dst, imm32" (or "mov ecx, imm32" + "add dst, rcx" for 64-bit math)
+static const v4_uarch_info uarch_info[V4_UARCH_COUNT] = {
+	// name               width   MUL ADD SUB ROR ROL XOR
+	{ "generator order",      4, {  3,  2,  1,  2,  2,  1 }, { 1, 2, 1, 2, 2, 1 }, { 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F } },
+
+	// Ports 0, 1, 5: IMUL on p1, rotations by cl on p0/p5
+	{ "Sandy Bridge",         4, {  3,  2,  1,  2,  2,  1 }, { 1, 2, 1, 2, 2, 1 }, { 0x02, 0x23, 0x23, 0x21, 0x21, 0x23 } },
+
+	// Ports 0, 1, 5, 6: IMUL on p1, rotations by cl on p0/p6 (Haswell to Ice Lake)
+	{ "Haswell",              4, {  3,  2,  1,  2,  2,  1 }, { 1, 2, 1, 2, 2, 1 }, { 0x02, 0x63, 0x63, 0x41, 0x41, 0x63 } },
+
+	// ALU0-ALU3: IMUL on ALU1, rotations by cl are a single uop on ALU1/ALU2
+	{ "Zen",                  5, {  3,  2,  1,  1,  1,  1 }, { 1, 2, 1, 1, 1, 1 }, { 0x02, 0x0F, 0x0F, 0x06, 0x06, 0x0F } },
+};
+
+static std::atomic<int> scheduler_uarch(-1);
+
+const v4_uarch_info* v4_get_uarch_info(v4_uarch uarch)
+{
+	return (uarch < V4_UARCH_COUNT) ? &uarch_info[uarch] : nullptr;
+}
+
+v4_uarch v4_detect_uarch()
+{
+	int data[4];
+	__cpuidex(data, 0, 0);
+	char vendor[13] = {};
+	memcpy(vendor + 0, &data[1], 4);
+	memcpy(vendor + 4, &data[3], 4);
+	memcpy(vendor + 8, &data[2], 4);
+
+	__cpuidex(data, 1, 0);
+	const uint32_t family = ((data[0] >> 8) & 15) + ((data[0] >> 20) & 255);
+	const uint32_t model = ((data[0] >> 4) & 15) | ((data[0] >> 12) & 0xF0);
+
+	if (strcmp(vendor, "GenuineIntel") == 0)
+	{
+		// Sandy Bridge, Sandy Bridge-E, Ivy Bridge, Ivy Bridge-E
+		if ((family == 6) && ((model == 0x2A) || (model == 0x2D) || (model == 0x3A) || (model == 0x3E)))
+		{
+			return V4_UARCH_SANDYBRIDGE;
+		}
+		return V4_UARCH_HASWELL;
+	}
+
+	if ((strcmp(vendor, "AuthenticAMD") == 0) || (strcmp(vendor, "HygonGenuine") == 0))
+	{
+		if (family >= 0x17)
+		{
+			return V4_UARCH_ZEN;
+		}
+	}
+
+	return V4_UARCH_HASWELL;
+}
+
+v4_uarch v4_get_scheduler_uarch()
+{
+	int uarch = scheduler_uarch.load(std::memory_order_relaxed);
+	if (uarch < 0)
+	{
+		uarch = v4_detect_uarch();
+		scheduler_uarch.store(uarch, std::memory_order_relaxed);
+	}
+	return static_cast<v4_uarch>(uarch);
+}
+
+void v4_set_scheduler_uarch(v4_uarch uarch)
+{
+	scheduler_uarch.store(uarch, std::memory_order_relaxed);
+}
+
+enum
+{
+	SCHED_MAX_NODES = NUM_INSTRUCTIONS * 2,
+};
+
+struct sched_node
+{
+	V4_Instruction inst;
+
+	// Successors and their distance in cycles
+	// True dependencies wait for the result, anti dependencies (WAR) only have to be emitted later
+	uint8_t succs[SCHED_MAX_NODES];
+	uint8_t succ_latency[SCHED_MAX_NODES];
+	int num_succs;
+
+	int preds_left;
+
+	// Longest latency path from this node to the end of the program
+	int height;
+
+	int ready_cycle;
+};
+
+static inline void add_edge(sched_node* nodes, int from, int to, int latency)
+{
+	sched_node& node = nodes[from];
+	node.succs[node.num_succs] = static_cast<uint8_t>(to);
+	node.succ_latency[node.num_succs] = static_cast<uint8_t>(latency);
+	++node.num_succs;
+	++nodes[to].preds_left;
+}
+
+// Tries to find a free port for every uop, returns updated busy mask or -1
+static int take_ports(uint32_t busy, uint32_t ports, uint32_t uops)
+{
+	for (uint32_t i = 0; i < uops; ++i)
+	{
+		const uint32_t free_ports = ports & ~busy;
+		if (!free_ports)
+		{
+			return -1;
+		}
+		busy |= free_ports & (0U - free_ports);
+	}
+	return static_cast<int>(busy);
+}
+
+static inline bool is_rotation(const V4_Instruction& inst)
+{
+	return (inst.opcode == ROR) || (inst.opcode == ROL);
+}
+
+int v4_schedule(const V4_Instruction* code, V4_Instruction* result, v4_uarch uarch)
+{
+	int num_insts = 0;
+	while (code[num_insts].opcode != RET)
+	{
+		++num_insts;
+	}
+
+	if ((uarch == V4_UARCH_NONE) || (uarch >= V4_UARCH_COUNT) || (num_insts > SCHED_MAX_NODES))
+	{
+		memcpy(result, code, (num_insts + 1) * sizeof(V4_Instruction));
+		return num_insts;
+	}
+
+	const v4_uarch_info& info = uarch_info[uarch];
+
+	std::vector<sched_node> nodes(num_insts);
+
+	// Every instruction reads both dst and src and writes dst
+	int last_writer[8] = { -1, -1, -1, -1, -1, -1, -1, -1 };
+	int readers[8][SCHED_MAX_NODES];
+	int num_readers[8] = {};
+
+	for (int i = 0; i < num_insts; ++i)
+	{
+		sched_node& node = nodes[i];
+		node.inst = code[i];
+		node.num_succs = 0;
+		node.preds_left = 0;
+		node.ready_cycle = 0;
+
+		const uint32_t a = node.inst.dst_index;
+		const uint32_t b = node.inst.src_index;
+
+		if (last_writer[a] >= 0)
+		{
+			add_edge(nodes.data(), last_writer[a], i, info.latency[nodes[last_writer[a]].inst.opcode]);
+		}
+
+		if ((last_writer[b] >= 0) && (last_writer[b] != last_writer[a]))
+		{
+			add_edge(nodes.data(), last_writer[b], i, info.latency[nodes[last_writer[b]].inst.opcode]);
+		}
+
+		// Instructions which read dst as a source must be emitted before it's overwritten
+		for (int j = 0; j < num_readers[a]; ++j)
+		{
+			add_edge(nodes.data(), readers[a][j], i, 0);
+		}
+
+		if (b != a)
+		{
+			readers[b][num_readers[b]++] = i;
+		}
+		last_writer[a] = i;
+		num_readers[a] = 0;
+	}
+
+	for (int i = num_insts - 1; i >= 0; --i)
+	{
+		sched_node& node = nodes[i];
+		node.height = info.latency[node.inst.opcode];
+		for (int j = 0; j < node.num_succs; ++j)
+		{
+			const int h = node.succ_latency[j] + nodes[node.succs[j]].height;
+			if (node.height < h)
+			{
+				node.height = h;
+			}
+		}
+	}
+
+	// Instructions with all predecessors emitted
+	int ready[SCHED_MAX_NODES];
+	int num_ready = 0;
+	for (int i = 0; i < num_insts; ++i)
+	{
+		if (nodes[i].preds_left == 0)
+		{
+			ready[num_ready++] = i;
+		}
+	}
+
+	// rcx keeps the last rotation count, so rotations by the same register are kept together when possible
+	uint32_t prev_rot_src = (uint32_t)(-1);
+
+	int num_emitted = 0;
+	for (int cycle = 0; num_emitted < num_insts; ++cycle)
+	{
+		uint32_t busy = 0;
+		uint32_t issued_uops = 0;
+
+		for (;;)
+		{
+			int best = -1;
+			for (int k = 0; k < num_ready; ++k)
+			{
+				const sched_node& node = nodes[ready[k]];
+				const uint32_t opcode = node.inst.opcode;
+				if ((node.ready_cycle > cycle) || (issued_uops + info.uops[opcode] > info.issue_width) || (take_ports(busy, info.ports[opcode], info.uops[opcode]) < 0))
+				{
+					continue;
+				}
+
+				if (best < 0)
+				{
+					best = k;
+					continue;
+				}
+
+				// Critical path first, then rotations which can reuse rcx, then generator order
+				const sched_node& cur = nodes[ready[best]];
+				if (node.height != cur.height)
+				{
+					if (node.height > cur.height)
+					{
+						best = k;
+					}
+					continue;
+				}
+
+				const bool node_reuses_rcx = is_rotation(node.inst) && (node.inst.src_index == prev_rot_src);
+				const bool cur_reuses_rcx = is_rotation(cur.inst) && (cur.inst.src_index == prev_rot_src);
+				if (node_reuses_rcx != cur_reuses_rcx)
+				{
+					if (node_reuses_rcx)
+					{
+						best = k;
+					}
+					continue;
+				}
+
+				if (ready[k] < ready[best])
+				{
+					best = k;
+				}
+			}
+
+			if (best < 0)
+			{
+				break;
+			}
+
+			const int index = ready[best];
+			ready[best] = ready[--num_ready];
+
+			const sched_node& node = nodes[index];
+			const uint32_t opcode = node.inst.opcode;
+
+			busy = static_cast<uint32_t>(take_ports(busy, info.ports[opcode], info.uops[opcode]));
+			issued_uops += info.uops[opcode];
+
+			result[num_emitted++] = node.inst;
+
+			for (int j = 0; j < node.num_succs; ++j)
+			{
+				sched_node& succ = nodes[node.succs[j]];
+				if (succ.ready_cycle < cycle + node.succ_latency[j])
+				{
+					succ.ready_cycle = cycle + node.succ_latency[j];
+				}
+				if (--succ.preds_left == 0)
+				{
+					ready[num_ready++] = node.succs[j];
+				}
+			}
+
+			if (is_rotation(node.inst))
+			{
+				prev_rot_src = node.inst.src_index;
+			}
+			if (node.inst.dst_index == prev_rot_src)
+			{
+				prev_rot_src = (uint32_t)(-1);
+			}
+		}
+	}
+
+	result[num_insts] = code[num_insts];
+	return num_insts;
+}
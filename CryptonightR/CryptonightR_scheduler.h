@@ -0,0 +1,49 @@
+#pragma once
+
+#include "definitions.h"
+
+// Instruction scheduler for random math programs
+//
+// Builds dependency graph over R0-R7 and reorders independent instructions with a list scheduler,
+// so the longest (usually IMUL) chains start first and the out-of-order core has more independent work
+// to overlap with AES and shuffle work from the main loop. Only the order changes, every instruction
+// still sees the same input values, so the result is bit-exact with the original program.
+//
+// Latencies and execution ports come from published instruction tables for each microarchitecture.
+
+enum v4_uarch
+{
+	V4_UARCH_NONE, // keep generator order
+	V4_UARCH_SANDYBRIDGE,
+	V4_UARCH_HASWELL,
+	V4_UARCH_ZEN,
+	V4_UARCH_COUNT,
+};
+
+struct v4_uarch_info
+{
+	const char* name;
+
+	// Max uops issued per cycle
+	uint32_t issue_width;
+
+	// Per opcode, as emitted by CryptonightR_encoder.h
+	uint8_t latency[V4_INSTRUCTION_COUNT];
+	uint8_t uops[V4_INSTRUCTION_COUNT];
+
+	// Bit mask of ALU ports which can execute each uop
+	uint8_t ports[V4_INSTRUCTION_COUNT];
+};
+
+const v4_uarch_info* v4_get_uarch_info(v4_uarch uarch);
+
+// Picks the table for the current CPU using cpuid vendor and family/model
+v4_uarch v4_detect_uarch();
+
+// Scheduling target for compile_code and compile_code_double, detected CPU by default
+v4_uarch v4_get_scheduler_uarch();
+void v4_set_scheduler_uarch(v4_uarch uarch);
+
+// Writes reordered program (including RET) to result, returns number of instructions
+// result must have space for the whole program
+int v4_schedule(const V4_Instruction* code, V4_Instruction* result, v4_uarch uarch);
@@ -0,0 +1,63 @@
+#include "CryptonightR_static.h"
+#include <vector>
+
+bool v4_static_program_equal(const v4_static_program& program, const V4_Instruction* code)
+{
+	// Field by field, V4_Instruction has padding
+	for (int i = 0; i <= program.size; ++i)
+	{
+		const V4_Instruction& a = code[i];
+		const V4_Instruction& b = program.code[i];
+		if ((a.opcode != b.opcode) || (a.dst_index != b.dst_index) || (a.src_index != b.src_index) || (a.C != b.C))
+		{
+			return false;
+		}
+		if ((a.opcode == RET) != (i == program.size))
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+// A compiled-in program must be the same as the one v4_random_math_init gives now, otherwise its kernel is never used
+static bool same_program(const v4_static_program& program, uint64_t height)
+{
+	V4_Instruction code[NUM_INSTRUCTIONS * 2];
+	v4_random_math_init(code, height);
+	return v4_static_program_equal(program, code);
+}
+
+template<uint64_t... heights>
+static v4_static_kernel find_kernel(uint64_t height)
+{
+	static const uint64_t kernel_heights[] = { heights... };
+	static const v4_static_kernel kernels[] = { CryptonightR_static<v4_static_program_for<heights>>... };
+	enum { NUM_KERNELS = sizeof(kernel_heights) / sizeof(kernel_heights[0]) };
+
+	// Checked once, on the first call
+	static const std::vector<bool> valid = []()
+	{
+		const v4_static_program* programs[] = { &v4_static_program_for<heights>::value... };
+		std::vector<bool> result(NUM_KERNELS);
+		for (size_t i = 0; i < NUM_KERNELS; ++i)
+		{
+			result[i] = same_program(*programs[i], kernel_heights[i]);
+		}
+		return result;
+	}();
+
+	for (size_t i = 0; i < NUM_KERNELS; ++i)
+	{
+		if ((kernel_heights[i] == height) && valid[i])
+		{
+			return kernels[i];
+		}
+	}
+	return nullptr;
+}
+
+v4_static_kernel v4_get_static_kernel(uint64_t height)
+{
+	return find_kernel<CN_R_STATIC_HEIGHTS>(height);
+}
@@ -0,0 +1,485 @@
+#pragma once
+
+#include "definitions.h"
+#include "CryptonightR_prefetch.h"
+#include <utility>
+
+// Compile-time random math programs and C++ main loops specialized for them
+//
+// v4_static_random_math_init is v4_random_math_init written as a constexpr function (with its own constexpr Blake-256),
+// so a program for any height can be a compile-time constant. CryptonightR_static<Program> unrolls such program into
+// the main loop, the compiler sees every register index and constant like in random_math.inl, but no generated source
+// file is needed. The same functions work at run time, the test compares them with v4_random_math_init.
+//
+// Kernels are compiled in for heights listed in CN_R_STATIC_HEIGHTS, v4_get_static_kernel finds them.
+// Every height costs one main loop in the binary and a few ms of compile time. Generating one program takes more
+// constexpr evaluation steps than MSVC allows by default, the project sets /constexpr:steps.
+
+// Comma-separated list, can be set on the compiler command line: CN_R_STATIC_HEIGHTS=RND_SEED,1806260,1806261
+#ifndef CN_R_STATIC_HEIGHTS
+#define CN_R_STATIC_HEIGHTS RND_SEED
+#endif
+
+enum
+{
+	// Same settings as in the program generator
+	V4_STATIC_TOTAL_LATENCY = 15 * 3,
+	V4_STATIC_ALU_COUNT_MUL = 1,
+	V4_STATIC_ALU_COUNT = 3,
+	V4_STATIC_MIN_INSTRUCTIONS = 60,
+	V4_STATIC_MAX_RETRIES = 64,
+	V4_STATIC_MAX_ITERATIONS = 256,
+
+	V4_STATIC_BLAKE_ROUNDS = 14,
+};
+
+struct v4_static_program
+{
+	// Program including RET
+	V4_Instruction code[NUM_INSTRUCTIONS + 1];
+
+	// Number of instructions without RET
+	int size;
+};
+
+static constexpr uint32_t v4_static_blake_iv[8] = {
+	0x6A09E667, 0xBB67AE85, 0x3C6EF372, 0xA54FF53A, 0x510E527F, 0x9B05688C, 0x1F83D9AB, 0x5BE0CD19,
+};
+
+static constexpr uint32_t v4_static_blake_c[16] = {
+	0x243F6A88, 0x85A308D3, 0x13198A2E, 0x03707344, 0xA4093822, 0x299F31D0, 0x082EFA98, 0xEC4E6C89,
+	0x452821E6, 0x38D01377, 0xBE5466CF, 0x34E90C6C, 0xC0AC29B7, 0xC97C50DD, 0x3F84D5B5, 0xB5470917,
+};
+
+static constexpr uint8_t v4_static_blake_sigma[10][16] = {
+	{  0,  1,  2,  3,  4,  5,  6,  7,  8,  9, 10, 11, 12, 13, 14, 15 },
+	{ 14, 10,  4,  8,  9, 15, 13,  6,  1, 12,  0,  2, 11,  7,  5,  3 },
+	{ 11,  8, 12,  0,  5,  2, 15, 13, 10, 14,  3,  6,  7,  1,  9,  4 },
+	{  7,  9,  3,  1, 13, 12, 11, 14,  2,  6,  5, 10,  4,  0, 15,  8 },
+	{  9,  0,  5,  7,  2,  4, 10, 15, 14,  1, 11, 12,  6,  8,  3, 13 },
+	{  2, 12,  6, 10,  0, 11,  8,  3,  4, 13,  7,  5, 15, 14,  1,  9 },
+	{ 12,  5,  1, 15, 14, 13,  4, 10,  0,  7,  6,  3,  9,  2,  8, 11 },
+	{ 13, 11,  7, 14, 12,  1,  3,  9,  5,  0, 15,  4,  8,  6,  2, 10 },
+	{  6, 15, 14,  9, 11,  3,  0,  8, 12,  2, 13,  7,  1,  4, 10,  5 },
+	{ 10,  2,  8,  4,  7,  6,  1,  5, 15, 11,  9, 14,  3, 12, 13,  0 },
+};
+
+static constexpr uint32_t v4_static_rotr32(uint32_t x, int n)
+{
+	return (x >> n) | (x << (32 - n));
+}
+
+static constexpr void v4_static_blake_g(uint32_t (&v)[16], const uint32_t (&m)[16], int r, int a, int b, int c, int d, int i)
+{
+	const uint8_t* s = v4_static_blake_sigma[r % 10];
+	v[a] += v[b] + (m[s[i * 2]] ^ v4_static_blake_c[s[i * 2 + 1]]);
+	v[d] = v4_static_rotr32(v[d] ^ v[a], 16);
+	v[c] += v[d];
+	v[b] = v4_static_rotr32(v[b] ^ v[c], 12);
+	v[a] += v[b] + (m[s[i * 2 + 1]] ^ v4_static_blake_c[s[i * 2]]);
+	v[d] = v4_static_rotr32(v[d] ^ v[a], 8);
+	v[c] += v[d];
+	v[b] = v4_static_rotr32(v[b] ^ v[c], 7);
+}
+
+// Blake-256 of 32 bytes in place (hash_extra_blake): one padded block, 256 bits counted
+static constexpr void v4_static_blake32(uint8_t (&data)[32])
+{
+	uint32_t m[16] = {};
+	for (int i = 0; i < 8; ++i)
+	{
+		m[i] = (uint32_t(data[i * 4]) << 24) | (uint32_t(data[i * 4 + 1]) << 16) | (uint32_t(data[i * 4 + 2]) << 8) | data[i * 4 + 3];
+	}
+	m[8] = 0x80000000U;
+	m[13] = 1;
+	m[15] = 256;
+
+	uint32_t v[16] = {};
+	for (int i = 0; i < 8; ++i)
+	{
+		v[i] = v4_static_blake_iv[i];
+		v[i + 8] = v4_static_blake_c[i];
+	}
+	v[12] ^= 256;
+	v[13] ^= 256;
+
+	for (int r = 0; r < V4_STATIC_BLAKE_ROUNDS; ++r)
+	{
+		v4_static_blake_g(v, m, r, 0, 4,  8, 12, 0);
+		v4_static_blake_g(v, m, r, 1, 5,  9, 13, 1);
+		v4_static_blake_g(v, m, r, 2, 6, 10, 14, 2);
+		v4_static_blake_g(v, m, r, 3, 7, 11, 15, 3);
+		v4_static_blake_g(v, m, r, 0, 5, 10, 15, 4);
+		v4_static_blake_g(v, m, r, 1, 6, 11, 12, 5);
+		v4_static_blake_g(v, m, r, 2, 7,  8, 13, 6);
+		v4_static_blake_g(v, m, r, 3, 4,  9, 14, 7);
+	}
+
+	for (int i = 0; i < 8; ++i)
+	{
+		const uint32_t h = v4_static_blake_iv[i] ^ v[i] ^ v[i + 8];
+		data[i * 4 + 0] = static_cast<uint8_t>(h >> 24);
+		data[i * 4 + 1] = static_cast<uint8_t>(h >> 16);
+		data[i * 4 + 2] = static_cast<uint8_t>(h >> 8);
+		data[i * 4 + 3] = static_cast<uint8_t>(h);
+	}
+}
+
+static constexpr void v4_static_check_data(int& data_index, int bytes_needed, uint8_t (&data)[32])
+{
+	if (data_index + bytes_needed > 32)
+	{
+		v4_static_blake32(data);
+		data_index = 0;
+	}
+}
+
+// Same program as v4_random_math_init(code, height)
+static constexpr v4_static_program v4_static_random_math_init(uint64_t height)
+{
+	const int op_latency[V4_INSTRUCTION_COUNT] = { 3, 2, 1, 2, 2, 1 };
+	const int asic_op_latency[V4_INSTRUCTION_COUNT] = { 3, 1, 1, 1, 1, 1 };
+	const int op_ALUs[V4_INSTRUCTION_COUNT] = {
+		V4_STATIC_ALU_COUNT_MUL, V4_STATIC_ALU_COUNT, V4_STATIC_ALU_COUNT, V4_STATIC_ALU_COUNT, V4_STATIC_ALU_COUNT, V4_STATIC_ALU_COUNT,
+	};
+
+	v4_static_program result = {};
+
+	// Height is the seed in little-endian order, data_index past the end makes the first byte hash it
+	uint8_t data[32] = {};
+	for (int i = 0; i < 8; ++i)
+	{
+		data[i] = static_cast<uint8_t>(height >> (i * 8));
+	}
+	int data_index = sizeof(data);
+
+	int latency[8] = {};
+	int asic_latency[8] = {};
+
+	// Destination value, opcode and source value of the last instruction for every register
+	uint32_t inst_data[8] = { 0, 1, 2, 3, 0xFFFFFF, 0xFFFFFF, 0xFFFFFF, 0xFFFFFF };
+
+	bool alu_busy[V4_STATIC_TOTAL_LATENCY + 1][V4_STATIC_ALU_COUNT] = {};
+	bool rotated[4] = {};
+	int rotate_count = 0;
+
+	int num_retries = 0;
+	int total_iterations = 0;
+	int code_size = 0;
+
+	while (((latency[0] < V4_STATIC_TOTAL_LATENCY) || (latency[1] < V4_STATIC_TOTAL_LATENCY) || (latency[2] < V4_STATIC_TOTAL_LATENCY) || (latency[3] < V4_STATIC_TOTAL_LATENCY)) && (num_retries < V4_STATIC_MAX_RETRIES))
+	{
+		if (++total_iterations > V4_STATIC_MAX_ITERATIONS)
+		{
+			break;
+		}
+
+		v4_static_check_data(data_index, 1, data);
+		const uint8_t c = data[data_index++];
+
+		// MUL = 0-2, ADD = 3, SUB = 4, ROR/ROL = 5 (direction from the next byte), XOR = 6-7
+		int opcode = c & ((1 << V4_OPCODE_BITS) - 1);
+		if (opcode == 5)
+		{
+			v4_static_check_data(data_index, 1, data);
+			opcode = (data[data_index++] < 0x80) ? ROR : ROL;
+		}
+		else if (opcode >= 6)
+		{
+			opcode = XOR;
+		}
+		else
+		{
+			opcode = (opcode <= 2) ? MUL : (opcode - 2);
+		}
+
+		const int a = (c >> V4_OPCODE_BITS) & ((1 << V4_DST_INDEX_BITS) - 1);
+		int b = (c >> (V4_OPCODE_BITS + V4_DST_INDEX_BITS)) & ((1 << V4_SRC_INDEX_BITS) - 1);
+
+		// No ADD/SUB/XOR with the same register, the matching constant register is used
+		if (((opcode == ADD) || (opcode == SUB) || (opcode == XOR)) && (a == b))
+		{
+			b = a + 4;
+		}
+
+		const bool is_rotation = (opcode == ROR) || (opcode == ROL);
+
+		// Two rotations in a row are one rotation
+		if (is_rotation && rotated[a])
+		{
+			continue;
+		}
+
+		// Same instruction (except MUL) with the same source value twice can be merged
+		if ((opcode != MUL) && ((inst_data[a] & 0xFFFF00) == static_cast<uint32_t>(opcode << 8) + ((inst_data[b] & 255) << 16)))
+		{
+			continue;
+		}
+
+		// First cycle when an ALU is free for this instruction
+		int next_latency = (latency[a] > latency[b]) ? latency[a] : latency[b];
+		int alu_index = -1;
+		while (next_latency < V4_STATIC_TOTAL_LATENCY)
+		{
+			for (int i = op_ALUs[opcode] - 1; i >= 0; --i)
+			{
+				if (alu_busy[next_latency][i])
+				{
+					continue;
+				}
+
+				// ADD is two 1-cycle instructions, rotation waits for the previous rotation
+				if ((opcode == ADD) && alu_busy[next_latency + 1][i])
+				{
+					continue;
+				}
+				if (is_rotation && (next_latency < rotate_count * op_latency[opcode]))
+				{
+					continue;
+				}
+
+				alu_index = i;
+				break;
+			}
+			if (alu_index >= 0)
+			{
+				break;
+			}
+			++next_latency;
+		}
+
+		// No register stays unchanged for more than 7 cycles
+		if (next_latency > latency[a] + 7)
+		{
+			continue;
+		}
+
+		next_latency += op_latency[opcode];
+
+		if (next_latency > V4_STATIC_TOTAL_LATENCY)
+		{
+			++num_retries;
+			continue;
+		}
+
+		if (is_rotation)
+		{
+			++rotate_count;
+		}
+
+		alu_busy[next_latency - op_latency[opcode]][alu_index] = true;
+		latency[a] = next_latency;
+		asic_latency[a] = ((asic_latency[a] > asic_latency[b]) ? asic_latency[a] : asic_latency[b]) + asic_op_latency[opcode];
+		rotated[a] = is_rotation;
+		inst_data[a] = code_size + (opcode << 8) + ((inst_data[b] & 255) << 16);
+
+		V4_Instruction& inst = result.code[code_size];
+		inst.opcode = static_cast<uint8_t>(opcode);
+		inst.dst_index = static_cast<uint8_t>(a);
+		inst.src_index = static_cast<uint8_t>(b);
+		inst.C = 0;
+
+		if (opcode == ADD)
+		{
+			alu_busy[next_latency - op_latency[opcode] + 1][alu_index] = true;
+
+			// 32-bit constant in little-endian order
+			v4_static_check_data(data_index, 4, data);
+			inst.C = uint32_t(data[data_index]) | (uint32_t(data[data_index + 1]) << 8) | (uint32_t(data[data_index + 2]) << 16) | (uint32_t(data[data_index + 3]) << 24);
+			data_index += 4;
+		}
+
+		if (++code_size >= V4_STATIC_MIN_INSTRUCTIONS)
+		{
+			break;
+		}
+	}
+
+	// MUL and ROR chains until ASIC latency is reached for at least one register
+	const int prev_code_size = code_size;
+	while ((code_size < NUM_INSTRUCTIONS) && (asic_latency[0] < V4_STATIC_TOTAL_LATENCY) && (asic_latency[1] < V4_STATIC_TOTAL_LATENCY) && (asic_latency[2] < V4_STATIC_TOTAL_LATENCY) && (asic_latency[3] < V4_STATIC_TOTAL_LATENCY))
+	{
+		int min_idx = 0;
+		int max_idx = 0;
+		for (int i = 1; i < 4; ++i)
+		{
+			if (asic_latency[i] < asic_latency[min_idx]) min_idx = i;
+			if (asic_latency[i] > asic_latency[max_idx]) max_idx = i;
+		}
+
+		const int pattern[3] = { ROR, MUL, MUL };
+		const int opcode = pattern[(code_size - prev_code_size) % 3];
+		latency[min_idx] = latency[max_idx] + op_latency[opcode];
+		asic_latency[min_idx] = asic_latency[max_idx] + asic_op_latency[opcode];
+
+		V4_Instruction& inst = result.code[code_size];
+		inst.opcode = static_cast<uint8_t>(opcode);
+		inst.dst_index = static_cast<uint8_t>(min_idx);
+		inst.src_index = static_cast<uint8_t>(max_idx);
+		inst.C = 0;
+		++code_size;
+	}
+
+	result.code[code_size].opcode = RET;
+	result.size = code_size;
+	return result;
+}
+
+// Compile-time program for a height, usable as a template argument
+template<uint64_t height>
+struct v4_static_program_for
+{
+	static constexpr v4_static_program value = v4_static_random_math_init(height);
+};
+
+template<uint64_t height>
+constexpr v4_static_program v4_static_program_for<height>::value;
+
+template<typename Program, size_t index>
+static FORCEINLINE void v4_static_instruction(v4_reg (&r)[8])
+{
+	constexpr V4_Instruction inst = Program::value.code[index];
+	v4_reg& dst = r[inst.dst_index];
+	const v4_reg src = r[inst.src_index];
+
+	switch (inst.opcode)
+	{
+	case MUL: dst *= src; break;
+	case ADD: dst += src + inst.C; break;
+	case SUB: dst -= src; break;
+#if RANDOM_MATH_64_BIT == 1
+	case ROR: dst = _rotr64(dst, static_cast<int>(src)); break;
+	case ROL: dst = _rotl64(dst, static_cast<int>(src)); break;
+#else
+	case ROR: dst = _rotr(dst, static_cast<int>(src)); break;
+	case ROL: dst = _rotl(dst, static_cast<int>(src)); break;
+#endif
+	case XOR: dst ^= src; break;
+	}
+}
+
+template<typename Program, size_t... index>
+static FORCEINLINE void v4_static_random_math(v4_reg (&r)[8], std::index_sequence<index...>)
+{
+	// Braced list is evaluated in order
+	const int unused[] = { 0, (v4_static_instruction<Program, index>(r), 0)... };
+	(void) unused;
+}
+
+#ifdef __GNUC__
+#define V4_STATIC_TARGET __attribute__((target("aes,sse4.1")))
+#else
+#define V4_STATIC_TARGET
+#endif
+
+// CryptonightR_ref with the program unrolled, Program is v4_static_program_for<height>
+// prefetch_points and prefetch_hint are from v4_prefetch_point and v4_prefetch_hint (CryptonightR_prefetch.h)
+template<typename Program, uint32_t prefetch_points = V4_PREFETCH_NONE, int prefetch_hint = V4_PREFETCH_T0>
+V4_STATIC_TARGET void CryptonightR_static(cryptonight_ctx* ctx0)
+{
+	uint8_t* l0 = ctx0->long_state;
+	uint64_t* h0 = (uint64_t*)ctx0->hash_state;
+
+	__m128i ax0 = _mm_set_epi64x(h0[1] ^ h0[5], h0[0] ^ h0[4]);
+	__m128i bx0 = _mm_set_epi64x(h0[3] ^ h0[7], h0[2] ^ h0[6]);
+	__m128i bx1 = _mm_set_epi64x(h0[9] ^ h0[11], h0[8] ^ h0[10]);
+
+	uint64_t idx0 = h0[0] ^ h0[4];
+	uint64_t idx1 = idx0 & 0x1FFFF0;
+
+	// Constant indices only, so r stays in registers
+	v4_reg r[8];
+	v4_reg* data = reinterpret_cast<v4_reg*>(h0 + 12);
+	r[0] = data[0];
+	r[1] = data[1];
+	r[2] = data[2];
+	r[3] = data[3];
+
+	for (size_t i = 0; i < 524288; i++)
+	{
+		__m128i cx = _mm_load_si128((__m128i *)&l0[idx1]);
+
+		cx = _mm_aesenc_si128(cx, ax0);
+
+		// Second load, its address is known now
+		if (prefetch_points & V4_PREFETCH_LINE)
+		{
+			v4_prefetch_address<prefetch_hint>(&l0[_mm_cvtsi128_si64(cx) & 0x1FFFF0]);
+		}
+
+		{
+			const __m128i chunk1 = _mm_load_si128((__m128i *)&l0[idx1 ^ 0x10]);
+			const __m128i chunk2 = _mm_load_si128((__m128i *)&l0[idx1 ^ 0x20]);
+			const __m128i chunk3 = _mm_load_si128((__m128i *)&l0[idx1 ^ 0x30]);
+			_mm_store_si128((__m128i *)&l0[idx1 ^ 0x10], _mm_add_epi64(chunk3, bx1));
+			_mm_store_si128((__m128i *)&l0[idx1 ^ 0x20], _mm_add_epi64(chunk1, bx0));
+			_mm_store_si128((__m128i *)&l0[idx1 ^ 0x30], _mm_add_epi64(chunk2, ax0));
+		}
+
+		_mm_store_si128((__m128i *)&l0[idx1], _mm_xor_si128(bx0, cx));
+
+		idx0 = _mm_cvtsi128_si64(cx);
+		idx1 = idx0 & 0x1FFFF0;
+
+		uint64_t hi, lo, cl, ch;
+		cl = ((uint64_t*)&l0[idx1])[0];
+		ch = ((uint64_t*)&l0[idx1])[1];
+
+#if RANDOM_MATH_64_BIT == 1
+		cl ^= (r[0] + r[1]) ^ (r[2] + r[3]);
+		r[4] = static_cast<uint64_t>(_mm_cvtsi128_si64(ax0));
+		r[5] = static_cast<uint64_t>(_mm_cvtsi128_si64(_mm_srli_si128(ax0, 8)));
+		r[6] = static_cast<uint64_t>(_mm_cvtsi128_si64(bx0));
+		r[7] = static_cast<uint64_t>(_mm_cvtsi128_si64(bx1));
+#else
+		cl ^= (r[0] + r[1]) | (static_cast<uint64_t>(r[2] + r[3]) << 32);
+		r[4] = static_cast<uint32_t>(_mm_cvtsi128_si32(ax0));
+		r[5] = static_cast<uint32_t>(_mm_cvtsi128_si32(_mm_srli_si128(ax0, 8)));
+		r[6] = static_cast<uint32_t>(_mm_cvtsi128_si32(bx0));
+		r[7] = static_cast<uint32_t>(_mm_cvtsi128_si32(bx1));
+#endif
+		v4_static_random_math<Program>(r, std::make_index_sequence<Program::value.size>());
+
+		lo = __umul128(idx0, cl, &hi);
+
+		{
+			const __m128i chunk1 = _mm_xor_si128(_mm_load_si128((__m128i *)&l0[idx1 ^ 0x10]), _mm_set_epi64x(lo, hi));
+			const __m128i chunk2 = _mm_load_si128((__m128i *)&l0[idx1 ^ 0x20]);
+			hi ^= ((uint64_t*)&l0[idx1 ^ 0x20])[0];
+			lo ^= ((uint64_t*)&l0[idx1 ^ 0x20])[1];
+
+			// Next iteration's first load, its address is known now
+			if (prefetch_points & V4_PREFETCH_NEXT)
+			{
+				v4_prefetch_address<prefetch_hint>(&l0[((static_cast<uint64_t>(_mm_cvtsi128_si64(ax0)) + hi) ^ cl) & 0x1FFFF0]);
+			}
+
+			const __m128i chunk3 = _mm_load_si128((__m128i *)&l0[idx1 ^ 0x30]);
+			_mm_store_si128((__m128i *)&l0[idx1 ^ 0x10], _mm_add_epi64(chunk3, bx1));
+			_mm_store_si128((__m128i *)&l0[idx1 ^ 0x20], _mm_add_epi64(chunk1, bx0));
+			_mm_store_si128((__m128i *)&l0[idx1 ^ 0x30], _mm_add_epi64(chunk2, ax0));
+		}
+
+		uint64_t al0 = static_cast<uint64_t>(_mm_cvtsi128_si64(ax0)) + hi;
+		uint64_t ah0 = static_cast<uint64_t>(_mm_cvtsi128_si64(_mm_srli_si128(ax0, 8))) + lo;
+		((uint64_t*)&l0[idx1])[0] = al0;
+		((uint64_t*)&l0[idx1])[1] = ah0;
+		ah0 ^= ch;
+		al0 ^= cl;
+		ax0 = _mm_set_epi64x(ah0, al0);
+		idx0 = al0;
+		idx1 = idx0 & 0x1FFFF0;
+
+		bx1 = bx0;
+		bx0 = cx;
+	}
+}
+
+// Same instructions and constants, code ends with RET
+bool v4_static_program_equal(const v4_static_program& program, const V4_Instruction* code);
+
+typedef void (*v4_static_kernel)(cryptonight_ctx*);
+
+// Compiled-in kernel for a height from CN_R_STATIC_HEIGHTS, nullptr for other heights
+// and if the compiled-in program is not the same as v4_random_math_init gives
+v4_static_kernel v4_get_static_kernel(uint64_t height);
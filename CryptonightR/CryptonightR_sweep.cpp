@@ -0,0 +1,256 @@
+#include "CryptonightR_sweep.h"
+#include "CryptonightR_benchmark.h"
+#include "CryptonightR_kernel_cache.h"
+#include "CryptonightR_hash.h"
+#include "CryptonightR_numa.h"
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <algorithm>
+#include <iostream>
+#include <string>
+#include <vector>
+
+extern "C" void ASM_ABI cnv2_mainloop_ivybridge_asm(cryptonight_ctx* ctx0);
+extern "C" void ASM_ABI cnv2_mainloop_ryzen_asm(cryptonight_ctx* ctx0);
+extern "C" void ASM_ABI cnv2_double_mainloop_sandybridge_asm(cryptonight_ctx* ctx0, cryptonight_ctx* ctx1);
+
+enum
+{
+	SWEEP_DEFAULT_DURATION_MS = 250,
+	SWEEP_DEFAULT_MIN_SAMPLES = 3,
+	SWEEP_DEFAULT_WARMUP_MS = 20,
+
+	// Baselines are measured this many times longer than one height
+	SWEEP_BASELINE_FACTOR = 10,
+
+	// Slowest outliers printed for every kernel type
+	SWEEP_MAX_OUTLIERS_SHOWN = 20,
+};
+
+// Heights with hashrate further than this many (normalized) median absolute deviations from the median
+static const double SWEEP_OUTLIER_MADS = 4.0;
+
+// Baselines drifting more than this between the start and the end of the sweep make slowdowns unreliable
+static const double SWEEP_MAX_BASELINE_DRIFT = 0.05;
+
+struct sweep_point
+{
+	uint64_t height;
+	double hashrate;
+};
+
+static double quantile(const std::vector<sweep_point>& sorted, double q)
+{
+	const size_t index = std::min(static_cast<size_t>(q * (sorted.size() - 1) + 0.5), sorted.size() - 1);
+	return sorted[index].hashrate;
+}
+
+static void report(const char* kernel_name, std::vector<sweep_point> points, double baseline)
+{
+	std::sort(points.begin(), points.end(), [](const sweep_point& a, const sweep_point& b) { return a.hashrate < b.hashrate; });
+
+	const size_t n = points.size();
+	const double median = quantile(points, 0.5);
+
+	std::cout << kernel_name << ", " << n << " heights:" << std::endl;
+	std::cout << "  H/s: min " << points[0].hashrate << " (height " << points[0].height << "), p1 " << quantile(points, 0.01) <<
+		", p10 " << quantile(points, 0.1) << ", median " << median << ", p90 " << quantile(points, 0.9) << ", p99 " <<
+		quantile(points, 0.99) << ", max " << points[n - 1].hashrate << " (height " << points[n - 1].height << ")" << std::endl;
+
+	// Slowdown is time per hash relative to CryptonightV2, the slowest height is the lowest hashrate
+	std::cout << "  Slowdown vs CryptonightV2 (" << baseline << " H/s): median " << baseline / median << "x, p99 " <<
+		baseline / quantile(points, 0.01) << "x, max " << baseline / points[0].hashrate << "x (height " << points[0].height << ")" << std::endl;
+
+	// Median absolute deviation is not affected by the outliers themselves
+	std::vector<double> deviations(n);
+	for (size_t i = 0; i < n; ++i)
+	{
+		deviations[i] = fabs(points[i].hashrate - median);
+	}
+	std::nth_element(deviations.begin(), deviations.begin() + n / 2, deviations.end());
+	const double mad = deviations[n / 2] * 1.4826;
+	const double threshold = SWEEP_OUTLIER_MADS * mad;
+
+	uint32_t slow = 0;
+	uint32_t fast = 0;
+	for (const sweep_point& p : points)
+	{
+		if (p.hashrate < median - threshold)
+		{
+			++slow;
+		}
+		else if (p.hashrate > median + threshold)
+		{
+			++fast;
+		}
+	}
+
+	std::cout << "  Outliers (" << SWEEP_OUTLIER_MADS << " MADs from median): " << slow << " slow, " << fast << " fast" << std::endl;
+	for (uint32_t i = 0; (i < slow) && (i < SWEEP_MAX_OUTLIERS_SHOWN); ++i)
+	{
+		std::cout << "    height " << points[i].height << ": " << points[i].hashrate << " H/s, " << baseline / points[i].hashrate << "x slower than CryptonightV2" << std::endl;
+	}
+}
+
+static mainloop_func get_cnv2_baseline()
+{
+	int data[4];
+	__cpuidex(data, 0, 0);
+	char vendor[13] = {};
+	memcpy(vendor + 0, &data[1], 4);
+	memcpy(vendor + 4, &data[3], 4);
+	memcpy(vendor + 8, &data[2], 4);
+
+	return (strcmp(vendor, "GenuineIntel") == 0) ? cnv2_mainloop_ivybridge_asm : cnv2_mainloop_ryzen_asm;
+}
+
+int sweep_main(int argc, char** argv)
+{
+	if (argc < 4)
+	{
+		std::cerr << "Usage: " << argv[0] << " --sweep <first height> <count> [--benchmark-* options]" << std::endl;
+		return 1;
+	}
+
+	const uint64_t first_height = strtoull(argv[2], nullptr, 10);
+	const uint64_t count = strtoull(argv[3], nullptr, 10);
+	if (count == 0)
+	{
+		std::cerr << "Height count must be positive" << std::endl;
+		return 1;
+	}
+
+	benchmark_options options = benchmark_default_options();
+	options.duration_ms = SWEEP_DEFAULT_DURATION_MS;
+	options.min_samples = SWEEP_DEFAULT_MIN_SAMPLES;
+	options.warmup_ms = SWEEP_DEFAULT_WARMUP_MS;
+	if (!benchmark_parse_args(argc, argv, options))
+	{
+		std::cerr << "Invalid benchmark options" << std::endl;
+		return 1;
+	}
+	options.quiet = true;
+
+	benchmark_options baseline_options = options;
+	baseline_options.duration_ms *= SWEEP_BASELINE_FACTOR;
+	baseline_options.min_samples *= SWEEP_BASELINE_FACTOR;
+	baseline_options.filter = nullptr;
+	baseline_options.json_path = nullptr;
+
+	const int node = numa_get_current_node();
+	cryptonight_ctx* ctx[2] = { numa_alloc_ctx(node), numa_alloc_ctx(node) };
+	kernel_cache* cache = kernel_cache_create(2 * (1 + KERNEL_CACHE_LOOKAHEAD), KERNEL_SINGLE | KERNEL_DOUBLE, 0);
+	benchmark_registry* bench = benchmark_registry_create(options);
+	benchmark_registry* baseline_bench = benchmark_registry_create(baseline_options);
+
+	if (!ctx[0] || !ctx[1] || !cache || !bench || !baseline_bench)
+	{
+		std::cerr << "Failed to allocate sweep contexts" << std::endl;
+		numa_free_ctx(ctx[0]);
+		numa_free_ctx(ctx[1]);
+		if (cache)
+		{
+			kernel_cache_destroy(cache);
+		}
+		benchmark_registry_destroy(bench);
+		benchmark_registry_destroy(baseline_bench);
+		return 1;
+	}
+
+	// Realistic scratchpads, main loops keep them valid after every run
+	const uint8_t input[76] = {};
+	cn_r_prepare(ctx[0], input, sizeof(input));
+	cn_r_prepare(ctx[1], input, sizeof(input));
+
+	const mainloop_func cnv2_single = get_cnv2_baseline();
+	auto measure_baselines = [&](double& single, double& dbl)
+	{
+		single = benchmark_run(baseline_bench, "CryptonightV2", 1, [&]() { cnv2_single(ctx[0]); }, true)->hashrate;
+		dbl = benchmark_run(baseline_bench, "CryptonightV2_double", 2, [&]() { cnv2_double_mainloop_sandybridge_asm(ctx[0], ctx[1]); }, true)->hashrate;
+	};
+
+	double baseline_single_before, baseline_double_before;
+	measure_baselines(baseline_single_before, baseline_double_before);
+
+	std::vector<sweep_point> single_points;
+	std::vector<sweep_point> double_points;
+	single_points.reserve(count);
+	double_points.reserve(count);
+
+	bool failed = false;
+	for (uint64_t height = first_height; height < first_height + count; ++height)
+	{
+		std::cerr << "Height " << height << " (" << height - first_height + 1 << "/" << count << ")\r" << std::flush;
+
+		kernel_cache_set_height(cache, height);
+		const kernel_cache_entry* single = kernel_cache_acquire(cache, height, 1);
+		const kernel_cache_entry* dbl = kernel_cache_acquire(cache, height, 2);
+		if (!single || !dbl)
+		{
+			std::cerr << "Failed to compile code for height " << height << std::endl;
+			kernel_cache_release(cache, single);
+			kernel_cache_release(cache, dbl);
+			failed = true;
+			break;
+		}
+
+		const mainloop_func generated = (mainloop_func) single->func;
+		const mainloop_double_func double_generated = (mainloop_double_func) dbl->func;
+		const std::string suffix = "(generated machine code, height " + std::to_string(height) + ")";
+
+		const benchmark_result* r1 = benchmark_run(bench, ("CryptonightR " + suffix).c_str(), 1, [&]() { generated(ctx[0]); }, true);
+		const benchmark_result* r2 = benchmark_run(bench, ("CryptonightR_double " + suffix).c_str(), 2, [&]() { double_generated(ctx[0], ctx[1]); }, true);
+		if (r1)
+		{
+			single_points.push_back({ height, r1->hashrate });
+		}
+		if (r2)
+		{
+			double_points.push_back({ height, r2->hashrate });
+		}
+
+		kernel_cache_release(cache, single);
+		kernel_cache_release(cache, dbl);
+	}
+	std::cerr << std::string(48, ' ') << '\r' << std::flush;
+
+	double baseline_single_after, baseline_double_after;
+	measure_baselines(baseline_single_after, baseline_double_after);
+
+	if (!failed)
+	{
+		const double baseline_single = (baseline_single_before + baseline_single_after) * 0.5;
+		const double baseline_double = (baseline_double_before + baseline_double_after) * 0.5;
+
+		std::cout << "Sweep of heights " << first_height << "-" << first_height + count - 1 << ", " << options.duration_ms << " ms per kernel and height" << std::endl;
+		if ((fabs(baseline_single_after / baseline_single_before - 1.0) > SWEEP_MAX_BASELINE_DRIFT) ||
+			(fabs(baseline_double_after / baseline_double_before - 1.0) > SWEEP_MAX_BASELINE_DRIFT))
+		{
+			std::cout << "Warning: CryptonightV2 baselines changed during the sweep (" << baseline_single_before << " -> " << baseline_single_after <<
+				" H/s, double " << baseline_double_before << " -> " << baseline_double_after << " H/s), slowdowns are not reliable" << std::endl;
+		}
+
+		if (!single_points.empty())
+		{
+			report("CryptonightR (generated machine code)", single_points, baseline_single);
+		}
+		if (!double_points.empty())
+		{
+			report("CryptonightR_double (generated machine code)", double_points, baseline_double);
+		}
+
+		benchmark_set_info(bench, "sweep_heights", std::to_string(first_height) + "-" + std::to_string(first_height + count - 1));
+		benchmark_set_info(bench, "cnv2_hashrate", std::to_string(baseline_single));
+		benchmark_set_info(bench, "cnv2_double_hashrate", std::to_string(baseline_double));
+		failed = !benchmark_write_json(bench);
+	}
+
+	benchmark_registry_destroy(baseline_bench);
+	benchmark_registry_destroy(bench);
+	kernel_cache_destroy(cache);
+	numa_free_ctx(ctx[0]);
+	numa_free_ctx(ctx[1]);
+
+	return failed ? 1 : 0;
+}
@@ -0,0 +1,18 @@
+#pragma once
+
+#include "definitions.h"
+
+// Per-height throughput sweep
+//
+// Every height has its own random program, so hashrate of generated code varies from block to block.
+// The sweep benchmarks generated single and double kernels for a range of heights (kernels for the next
+// heights are compiled in background) and reports the hashrate distribution, slowdown relative to the
+// CryptonightV2 ASM main loops and outlier heights, which is used for capacity planning and to find
+// pathological programs before they go live.
+//
+// Command line mode:
+// --sweep <first height> <count> [benchmark options (CryptonightR_benchmark.h)]
+// Default is 250 ms per kernel and height with 3 samples minimum, CryptonightV2 baselines are measured
+// before and after the sweep for 10 times longer. --benchmark-json writes every height's result.
+
+int sweep_main(int argc, char** argv);
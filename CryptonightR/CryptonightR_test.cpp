@@ -1,8 +1,33 @@
 #include "definitions.h"
+#include "CryptonightR_jit_buffer.h"
+#include "CryptonightR_kernel_cache.h"
+#include "CryptonightR_code_file.h"
+#include "CryptonightR_scheduler.h"
+#include "CryptonightR_avx512.h"
+#include "CryptonightR_nonce_search.h"
+#include "CryptonightR_numa.h"
+#include "CryptonightR_arena.h"
+#include "CryptonightR_explode.h"
+#include "CryptonightR_keccak.h"
+#include "CryptonightR_hash.h"
+#include "CryptonightR_verifier.h"
+#include "CryptonightR_benchmark.h"
+#include "CryptonightR_analyzer.h"
+#include "CryptonightR_interpreter.h"
+#include "CryptonightR_static.h"
+#include "CryptonightR_prefetch.h"
+#include "CryptonightR_height_check.h"
 #include <chrono>
 #include <iostream>
 #include <random>
 #include <atomic>
+#include <string>
+#include <thread>
+#include <algorithm>
+
+#ifndef _WIN32
+#include <unistd.h>
+#endif
 
 // CryptonightR reference implementation
 // It's basically CryptonightV2 with random math instead of div+sqrt
@@ -660,6 +685,148 @@ void CryptonightR_double_SSE(cryptonight_ctx* ctx0, cryptonight_ctx* ctx1)
 	}
 }
 
+#include "random_math_quad.inl"
+
+#ifdef __GNUC__
+#define TARGET_XSAVE __attribute__((target("xsave")))
+#else
+#define TARGET_XSAVE
+#endif
+
+// CPU must support AVX2 and OS must save YMM state, same checks as in CryptonightR_avx512_supported
+TARGET_XSAVE bool CryptonightR_quad_AVX2_supported()
+{
+	int data[4];
+	__cpuidex(data, 0, 0);
+	if (data[0] < 7)
+	{
+		return false;
+	}
+
+	__cpuidex(data, 1, 0);
+	if (!(data[2] & (1 << 27)))
+	{
+		return false;
+	}
+	if ((_xgetbv(0) & 0x6) != 0x6)
+	{
+		return false;
+	}
+
+	__cpuidex(data, 7, 0);
+	return (data[1] & (1 << 5)) != 0;
+}
+
+// Four hashes with scalar main loops, random math for all of them runs in AVX2 registers (one 64-bit lane per hash)
+void CryptonightR_quad_AVX2(cryptonight_ctx** ctx)
+{
+	enum { N = 4 };
+
+	uint8_t* l[N];
+	uint64_t axl[N], axh[N];
+	__m128i bx0[N], bx1[N];
+	uint64_t idx0[N];
+	uint32_t idx1[N];
+	alignas(32) uint64_t data[4][N];
+
+	for (int k = 0; k < N; ++k)
+	{
+		l[k] = ctx[k]->long_state;
+		const uint64_t* h = (const uint64_t*)ctx[k]->hash_state;
+
+		axl[k] = h[0] ^ h[4];
+		axh[k] = h[1] ^ h[5];
+		bx0[k] = _mm_set_epi64x(h[3] ^ h[7], h[2] ^ h[6]);
+		bx1[k] = _mm_set_epi64x(h[9] ^ h[11], h[8] ^ h[10]);
+
+		idx0[k] = axl[k];
+		idx1[k] = idx0[k] & 0x1FFFF0;
+
+		const v4_reg* d = reinterpret_cast<const v4_reg*>(h + 12);
+		for (int j = 0; j < 4; ++j)
+		{
+			data[j][k] = d[j];
+		}
+	}
+
+	__m256i r0 = _mm256_load_si256((const __m256i*) data[0]);
+	__m256i r1 = _mm256_load_si256((const __m256i*) data[1]);
+	__m256i r2 = _mm256_load_si256((const __m256i*) data[2]);
+	__m256i r3 = _mm256_load_si256((const __m256i*) data[3]);
+
+	for (size_t i = 0; i < 524288; i++)
+	{
+		__m128i cx[N];
+		for (int k = 0; k < N; ++k)
+		{
+			uint8_t* lk = l[k];
+			const __m128i ax = _mm_set_epi64x(axh[k], axl[k]);
+			cx[k] = _mm_aesenc_si128(_mm_load_si128((__m128i *)&lk[idx1[k]]), ax);
+
+			{
+				uint32_t j = idx1[k] ^ 0x10;
+				const __m128i chunk1 = _mm_load_si128((__m128i *)&lk[j]); j ^= 0x30;
+				const __m128i chunk2 = _mm_load_si128((__m128i *)&lk[j]);
+				_mm_store_si128((__m128i *)&lk[j], _mm_add_epi64(chunk1, bx0[k])); j ^= 0x10;
+				const __m128i chunk3 = _mm_load_si128((__m128i *)&lk[j]);
+				_mm_store_si128((__m128i *)&lk[j], _mm_add_epi64(chunk2, ax)); j ^= 0x20;
+				_mm_store_si128((__m128i *)&lk[j], _mm_add_epi64(chunk3, bx1[k]));
+			}
+
+			_mm_store_si128((__m128i *)&lk[idx1[k]], _mm_xor_si128(bx0[k], cx[k]));
+
+			idx0[k] = _mm_cvtsi128_si64(cx[k]);
+			idx1[k] = idx0[k] & 0x1FFFF0;
+		}
+
+		alignas(32) uint64_t random_math_result[N];
+		_mm256_store_si256((__m256i*) random_math_result, _mm256_or_si256(_mm256_and_si256(_mm256_add_epi32(r0, r1), _mm256_set1_epi64x(0xFFFFFFFFLL)), _mm256_slli_epi64(_mm256_add_epi32(r2, r3), 32)));
+		{
+			const __m256i r4 = _mm256_set_epi64x(axl[3], axl[2], axl[1], axl[0]);
+			const __m256i r5 = _mm256_set_epi64x(axh[3], axh[2], axh[1], axh[0]);
+			const __m256i r6 = _mm256_set_epi64x(_mm_cvtsi128_si64(bx0[3]), _mm_cvtsi128_si64(bx0[2]), _mm_cvtsi128_si64(bx0[1]), _mm_cvtsi128_si64(bx0[0]));
+			const __m256i r7 = _mm256_set_epi64x(_mm_cvtsi128_si64(bx1[3]), _mm_cvtsi128_si64(bx1[2]), _mm_cvtsi128_si64(bx1[1]), _mm_cvtsi128_si64(bx1[0]));
+			random_math_quad(r0, r1, r2, r3, r4, r5, r6, r7);
+		}
+
+		for (int k = 0; k < N; ++k)
+		{
+			uint8_t* lk = l[k];
+			const __m128i ax = _mm_set_epi64x(axh[k], axl[k]);
+
+			uint64_t hi, lo, cl, ch;
+			cl = ((uint64_t*)&lk[idx1[k]])[0] ^ random_math_result[k];
+			ch = ((uint64_t*)&lk[idx1[k]])[1];
+
+			lo = _umul128(idx0[k], cl, &hi);
+
+			{
+				uint32_t j = idx1[k] ^ 0x10;
+				const __m128i chunk1 = _mm_xor_si128(_mm_load_si128((__m128i *)&lk[j]), _mm_set_epi64x(lo, hi)); j ^= 0x30;
+				const __m128i chunk2 = _mm_load_si128((__m128i *)&lk[j]);
+				hi ^= ((uint64_t*)&lk[j])[0];
+				lo ^= ((uint64_t*)&lk[j])[1];
+				_mm_store_si128((__m128i *)&lk[j], _mm_add_epi64(chunk1, bx0[k])); j ^= 0x10;
+				const __m128i chunk3 = _mm_load_si128((__m128i *)&lk[j]);
+				_mm_store_si128((__m128i *)&lk[j], _mm_add_epi64(chunk2, ax)); j ^= 0x20;
+				_mm_store_si128((__m128i *)&lk[j], _mm_add_epi64(chunk3, bx1[k]));
+			}
+
+			axl[k] += hi;
+			axh[k] += lo;
+			((uint64_t*)&lk[idx1[k]])[0] = axl[k];
+			((uint64_t*)&lk[idx1[k]])[1] = axh[k];
+			axh[k] ^= ch;
+			axl[k] ^= cl;
+			idx0[k] = axl[k];
+			idx1[k] = idx0[k] & 0x1FFFF0;
+
+			bx1[k] = bx0[k];
+			bx0[k] = cx[k];
+		}
+	}
+}
+
 #define NOMINMAX
 #define WIN32_LEAN_AND_MEAN
 #include <Windows.h>
@@ -687,18 +854,15 @@ BOOL AddPrivilege(const TCHAR* pszPrivilege)
 	return TRUE;
 }
 
+// Test thread is pinned before contexts are allocated, so scratchpads go to its node
 cryptonight_ctx* cryptonight_alloc_ctx()
 {
-	cryptonight_ctx* ptr = (cryptonight_ctx*)_mm_malloc(sizeof(cryptonight_ctx), 4096);
-
-	SIZE_T iLargePageMin = GetLargePageMinimum();
-	if (MEMORY > iLargePageMin)
+	cryptonight_ctx* ptr = numa_alloc_ctx(numa_get_current_node());
+	if (!ptr)
 	{
-		iLargePageMin *= 2;
+		std::cerr << "Failed to allocate memory for scratchpad" << std::endl;
+		exit(1);
 	}
-
-	ptr->long_state = (uint8_t*) VirtualAlloc(NULL, iLargePageMin, MEM_COMMIT | MEM_RESERVE | MEM_LARGE_PAGES, PAGE_READWRITE);
-
 	return ptr;
 }
 
@@ -718,16 +882,14 @@ void init_ctx(cryptonight_ctx* ptr, uint64_t seed)
 	ptr->ctx_info[0] = 1;
 }
 
-typedef void(*mainloop_func)(cryptonight_ctx*);
-typedef void(*mainloop_double_func)(cryptonight_ctx*, cryptonight_ctx*);
-
-extern "C" void CryptonightR_asm(cryptonight_ctx* ctx0);
-extern "C" void CryptonightR_double_asm(cryptonight_ctx* ctx0, cryptonight_ctx* ctx1);
-extern "C" void cnv2_mainloop_ivybridge_asm(cryptonight_ctx* ctx0);
-extern "C" void cnv2_mainloop_ryzen_asm(cryptonight_ctx* ctx0);
-extern "C" void cnv2_double_mainloop_sandybridge_asm(cryptonight_ctx* ctx0, cryptonight_ctx* ctx1);
+extern "C" void ASM_ABI CryptonightR_asm(cryptonight_ctx* ctx0);
+extern "C" void ASM_ABI CryptonightR_double_asm(cryptonight_ctx* ctx0, cryptonight_ctx* ctx1);
+extern "C" void ASM_ABI cnv2_mainloop_ivybridge_asm(cryptonight_ctx* ctx0);
+extern "C" void ASM_ABI cnv2_mainloop_ryzen_asm(cryptonight_ctx* ctx0);
+extern "C" void ASM_ABI cnv2_double_mainloop_sandybridge_asm(cryptonight_ctx* ctx0, cryptonight_ctx* ctx1);
 extern int compile_code(const V4_Instruction* code, std::vector<uint8_t>& machine_code);
 extern void compile_code_double(const V4_Instruction* code, std::vector<uint8_t>& machine_code);
+extern void compile_code_multi(const V4_Instruction* code, uint32_t ways, std::vector<uint8_t>& machine_code);
 
 static double get_rdtsc_speed()
 {
@@ -747,100 +909,144 @@ static double get_rdtsc_speed()
 
 static double rdtsc_speed = get_rdtsc_speed();
 
+// Results of all benchmarks in this run
+static benchmark_registry* bench;
+
 template<typename T, typename ...Us>
-static void benchmark(T f, const char* name, Us... args)
+static void benchmark(T f, const char* name, uint32_t hashes_per_call, Us... args)
 {
-	int64_t min_dt = std::numeric_limits<int64_t>::max();
+	benchmark_run(bench, name, hashes_per_call, [&]() { f(args...); });
+}
+
+// Same with hardware counters, for kernels which are compared with each other when tuning
+template<typename T, typename ...Us>
+static void benchmark_counters(T f, const char* name, uint32_t hashes_per_call, Us... args)
+{
+	benchmark_run(bench, name, hashes_per_call, [&]() { f(args...); }, true);
+}
 
-	for (uint32_t i = 0; i < BENCHMARK_DURATION; ++i)
+// Runs multi-way code with ctx[1..ways] and checks every lane against reference code (ctx[0] is used for reference)
+template<typename T>
+static bool check_multi(T func, uint32_t ways, const V4_Instruction* code, cryptonight_ctx** ctx, uint64_t seed)
+{
+	for (uint32_t i = 0; i < ways; ++i)
 	{
-		const int64_t end_time = std::chrono::high_resolution_clock::now().time_since_epoch().count() + 1000000000;
+		init_ctx(ctx[i + 1], seed + i);
+	}
+	func(ctx + 1);
 
-		do
+	for (uint32_t i = 0; i < ways; ++i)
+	{
+		init_ctx(ctx[0], seed + i);
+		CryptonightR_ref(ctx[0], code);
+		if (memcmp(ctx[0]->long_state, ctx[i + 1]->long_state, MEMORY) != 0)
 		{
-			const uint64_t t1 = __rdtsc();
-			std::atomic_thread_fence(std::memory_order_seq_cst);
-
-			f(args...);
-
-			std::atomic_thread_fence(std::memory_order_seq_cst);
-			const uint64_t t2 = __rdtsc();
-
-			const int64_t dt = t2 - t1;
-			if (dt < min_dt)
-			{
-				min_dt = dt;
-			}
-		} while (std::chrono::high_resolution_clock::now().time_since_epoch().count() < end_time);
-
-		const char progress[] = "|/-\\";
-		std::cout << name << ": " << min_dt / (rdtsc_speed * 524288.0) << " ns/iteration\t" << progress[i % (sizeof(progress) - 1)] << '\r';
+			return false;
+		}
 	}
-	std::cout << name << ": " << min_dt / (rdtsc_speed * 524288.0) << " ns/iteration\t\t\t" << std::endl;
+	return true;
 }
 
-int CryptonightR_test()
+int CryptonightR_test(const benchmark_options& options)
 {
-	SetThreadAffinityMask(GetCurrentThread(), 1 << 3);
+	// Benchmarks pin themselves, other threads can use all CPUs
+	bench = benchmark_registry_create(options);
 	SetPriorityClass(GetCurrentProcess(), HIGH_PRIORITY_CLASS);
 	SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_HIGHEST);
 
 	AddPrivilege(TEXT("SeLockMemoryPrivilege"));
 
-	cryptonight_ctx* ctx[5];
-	for (int i = 0; i < 5; ++i)
+	// Reference + up to 8 ways
+	cryptonight_ctx* ctx[1 + AVX512_WAYS];
+	for (int i = 0; i < 1 + AVX512_WAYS; ++i)
 	{
 		ctx[i] = cryptonight_alloc_ctx();
 		init_ctx(ctx[i], i % 2);
 	}
 
 	V4_Instruction code[1024];
+	v4_threaded_code threaded_code;
 
-	//int max_code_size = 0;
-	//int max_height = 0;
-	//uint64_t inst_count[V4_INSTRUCTION_COUNT] = {};
-	//int prog_count[128] = {};
-	//uint64_t total_inst_count = 0;
-	//for (int i = 0; i < 10000000; ++i)
-	//{
-	//	int code_size = v4_random_math_init(code, i);
-	//	++prog_count[code_size];
-	//	if (code_size > max_code_size)
-	//	{
-	//		max_code_size = code_size;
-	//		max_height = i;
-	//	}
-	//	for (int j = 0; code[j].opcode != RET; ++j)
-	//	{
-	//		++inst_count[code[j].opcode];
-	//		++total_inst_count;
-	//	}
-	//}
-	//printf("max code size = %d for height %d\n", max_code_size, max_height);
-	//printf("MUL %.2f%%\n", static_cast<double>(inst_count[MUL]) * 100.0 / total_inst_count);
-	//printf("ADD %.2f%%\n", static_cast<double>(inst_count[ADD]) * 100.0 / total_inst_count);
-	//printf("SUB %.2f%%\n", static_cast<double>(inst_count[SUB]) * 100.0 / total_inst_count);
-	//printf("ROR %.2f%%\n", static_cast<double>(inst_count[ROR]) * 100.0 / total_inst_count);
-	//printf("ROL %.2f%%\n", static_cast<double>(inst_count[ROL]) * 100.0 / total_inst_count);
-	//printf("XOR %.2f%%\n", static_cast<double>(inst_count[XOR]) * 100.0 / total_inst_count);
-	//for (int i = 0; i < 128; ++i)
-	//{
-	//	if (prog_count[i] > 0)
-	//	{
-	//		printf("%d\t%d\n", i, prog_count[i]);
-	//	}
-	//}
-	//printf("Average length: %.6f\n", total_inst_count / 1e7);
+	// Instruction mix, program length and latency statistics over many heights: --analyze (CryptonightR_analyzer.h)
 
 	v4_random_math_init(code, RND_SEED);
-	std::vector<uint8_t> machine_code, machine_code_double;
+	std::vector<uint8_t> machine_code, machine_code_double, machine_code_unscheduled;
 	compile_code(code, machine_code);
     compile_code_double(code, machine_code_double);
+	v4_threaded_compile(code, threaded_code);
+
+	// Same program in generator order to compare with scheduled code
+	const v4_uarch uarch = v4_get_scheduler_uarch();
+	v4_set_scheduler_uarch(V4_UARCH_NONE);
+	compile_code(code, machine_code_unscheduled);
+	v4_set_scheduler_uarch(uarch);
+
+	// Same program with prefetch instructions inserted, to compare with the current kernels
+	static const v4_prefetch prefetch_variants[] = {
+		{ V4_PREFETCH_LINE, V4_PREFETCH_T0 },
+		{ V4_PREFETCH_NEXT, V4_PREFETCH_T0 },
+		{ V4_PREFETCH_BOTH, V4_PREFETCH_T0 },
+		{ V4_PREFETCH_BOTH, V4_PREFETCH_NTA },
+		{ V4_PREFETCH_BOTH, V4_PREFETCH_W },
+	};
+	enum { NUM_PREFETCH_VARIANTS = sizeof(prefetch_variants) / sizeof(prefetch_variants[0]) };
+
+	const v4_prefetch prefetch = v4_get_prefetch();
+	std::vector<uint8_t> machine_code_prefetch[NUM_PREFETCH_VARIANTS];
+	for (int i = 0; i < NUM_PREFETCH_VARIANTS; ++i)
+	{
+		v4_set_prefetch(prefetch_variants[i]);
+		compile_code(code, machine_code_prefetch[i]);
+	}
+	v4_set_prefetch(prefetch);
+
+	// Emitted random math must do the same as the program with the same latencies
+	v4_program_analysis analysis;
+	v4_analyze(code, analysis);
+	std::string analyzer_error;
+	if (!v4_check_compiled_code(code, analysis, &analyzer_error))
+	{
+		std::cerr << "Generated random math doesn't match the program: " << analyzer_error << std::endl;
+		return 18;
+	}
 
-	mainloop_func CryptonightR_generated = (mainloop_func) VirtualAlloc(0, 65536, MEM_RESERVE | MEM_COMMIT, PAGE_EXECUTE_READWRITE);
-    mainloop_double_func CryptonightR_double_generated = (mainloop_double_func)VirtualAlloc(0, 65536, MEM_RESERVE | MEM_COMMIT, PAGE_EXECUTE_READWRITE);
-    memcpy(CryptonightR_generated, machine_code.data(), machine_code.size());
-    memcpy(CryptonightR_double_generated, machine_code_double.data(), machine_code_double.size());
+	// 3, 4 and 5 hashes per thread
+	const char* multi_names[6] = { nullptr, nullptr, nullptr, "CryptonightR_triple", "CryptonightR_quad", "CryptonightR_penta" };
+	std::vector<uint8_t> machine_code_multi[6];
+	for (uint32_t ways = 3; ways <= 5; ++ways)
+	{
+		compile_code_multi(code, ways, machine_code_multi[ways]);
+	}
+
+	// Single and double code go to separate pages, so they can be rewritten independently
+	jit_buffer code_buf;
+	if (!jit_buffer_alloc(&code_buf, 65536 * (6 + NUM_PREFETCH_VARIANTS)))
+	{
+		std::cerr << "Failed to allocate memory for generated code" << std::endl;
+		return 1;
+	}
+
+	mainloop_func CryptonightR_generated = (mainloop_func) jit_buffer_write(&code_buf, 0, machine_code.data(), machine_code.size());
+	mainloop_double_func CryptonightR_double_generated = (mainloop_double_func) jit_buffer_write(&code_buf, 65536, machine_code_double.data(), machine_code_double.size());
+	mainloop_func CryptonightR_generated_unscheduled = (mainloop_func) jit_buffer_write(&code_buf, 65536 * 2, machine_code_unscheduled.data(), machine_code_unscheduled.size());
+	mainloop_multi_func CryptonightR_multi_generated[6] = {};
+	for (uint32_t ways = 3; ways <= 5; ++ways)
+	{
+		CryptonightR_multi_generated[ways] = (mainloop_multi_func) jit_buffer_write(&code_buf, 65536 * ways, machine_code_multi[ways].data(), machine_code_multi[ways].size());
+	}
+	mainloop_func CryptonightR_generated_prefetch[NUM_PREFETCH_VARIANTS];
+	bool prefetch_written = true;
+	for (int i = 0; i < NUM_PREFETCH_VARIANTS; ++i)
+	{
+		CryptonightR_generated_prefetch[i] = (mainloop_func) jit_buffer_write(&code_buf, 65536 * (6 + i), machine_code_prefetch[i].data(), machine_code_prefetch[i].size());
+		prefetch_written = prefetch_written && CryptonightR_generated_prefetch[i];
+	}
+
+	if (!CryptonightR_generated || !CryptonightR_double_generated || !CryptonightR_generated_unscheduled || !CryptonightR_multi_generated[3] || !CryptonightR_multi_generated[4] || !CryptonightR_multi_generated[5] || !prefetch_written)
+	{
+		std::cerr << "Failed to make generated code executable" << std::endl;
+		return 1;
+	}
 
 	// Do initial integrity check
 	CryptonightR_double_ref(ctx[0], ctx[1], code);
@@ -889,6 +1095,7 @@ int CryptonightR_test()
     CryptonightR(ctx[2]);
 	CryptonightR_asm(ctx[3]);
 	CryptonightR_generated(ctx[4]);
+	CryptonightR_generated_unscheduled(ctx[1]);
 
     if (memcmp(ctx[0]->long_state, ctx[2]->long_state, MEMORY) != 0)
 	{
@@ -908,23 +1115,179 @@ int CryptonightR_test()
 		return 8;
 	}
 
+	if (memcmp(ctx[0]->long_state, ctx[1]->long_state, MEMORY) != 0)
+	{
+		std::cerr << "Generated machine code (generator order) doesn't match reference code" << std::endl;
+		return 8;
+	}
+
+	init_ctx(ctx[1], 5489);
+	CryptonightR_interpreter(ctx[1], threaded_code);
+	if (memcmp(ctx[0]->long_state, ctx[1]->long_state, MEMORY) != 0)
+	{
+		std::cerr << "Threaded interpreter doesn't match reference code" << std::endl;
+		return 20;
+	}
+
+	const v4_static_kernel static_kernel = v4_get_static_kernel(RND_SEED);
+	if (!static_kernel)
+	{
+		std::cerr << "Compile-time program doesn't match random math program" << std::endl;
+		return 21;
+	}
+	init_ctx(ctx[1], 5489);
+	static_kernel(ctx[1]);
+	if (memcmp(ctx[0]->long_state, ctx[1]->long_state, MEMORY) != 0)
+	{
+		std::cerr << "C++ code (compile-time program) doesn't match reference code" << std::endl;
+		return 21;
+	}
+
+	for (int i = 0; i < NUM_PREFETCH_VARIANTS; ++i)
+	{
+		init_ctx(ctx[1], 5489);
+		CryptonightR_generated_prefetch[i](ctx[1]);
+		if (memcmp(ctx[0]->long_state, ctx[1]->long_state, MEMORY) != 0)
+		{
+			std::cerr << "Generated machine code (prefetch " << v4_prefetch_points_name(prefetch_variants[i].points) << ":" << v4_prefetch_hint_name(prefetch_variants[i].hint) << ") doesn't match reference code" << std::endl;
+			return 22;
+		}
+	}
+
+	init_ctx(ctx[1], 5489);
+	CryptonightR_static<v4_static_program_for<RND_SEED>, V4_PREFETCH_BOTH>(ctx[1]);
+	if (memcmp(ctx[0]->long_state, ctx[1]->long_state, MEMORY) != 0)
+	{
+		std::cerr << "C++ code (compile-time program, prefetch) doesn't match reference code" << std::endl;
+		return 22;
+	}
+
+	for (uint32_t ways = 3; ways <= 5; ++ways)
+	{
+		if (!check_multi(CryptonightR_multi_generated[ways], ways, code, ctx, 5489))
+		{
+			std::cerr << "Generated machine code (" << ways << " ways) doesn't match reference code" << std::endl;
+			return 9;
+		}
+	}
+
+	const bool avx2 = CryptonightR_quad_AVX2_supported();
+	if (avx2 && !check_multi(CryptonightR_quad_AVX2, 4, code, ctx, 5489))
+	{
+		std::cerr << "C++ AVX2 code (quad) doesn't match reference code" << std::endl;
+		return 2;
+	}
+
+	const bool avx512 = CryptonightR_avx512_supported();
+	auto CryptonightR_avx512_code = [&code](cryptonight_ctx** c) { CryptonightR_avx512(c, code); };
+	if (avx512 && !check_multi(CryptonightR_avx512_code, AVX512_WAYS, code, ctx, 5489))
+	{
+		std::cerr << "AVX-512 code doesn't match reference code" << std::endl;
+		return 10;
+	}
+
+	// Keccak-256 of an empty string
+	{
+		static const uint8_t keccak_empty[32] = {
+			0xc5, 0xd2, 0x46, 0x01, 0x86, 0xf7, 0x23, 0x3c, 0x92, 0x7e, 0x7d, 0xb2, 0xdc, 0xc7, 0x03, 0xc0,
+			0xe5, 0x00, 0xb6, 0x53, 0xca, 0x82, 0x27, 0x3b, 0x7b, 0xfa, 0xd8, 0x04, 0x5d, 0x85, 0xa4, 0x70,
+		};
+		uint8_t state[KECCAK_STATE_SIZE];
+		keccak1600((const uint8_t*) "", 0, state);
+		if (memcmp(state, keccak_empty, sizeof(keccak_empty)) != 0)
+		{
+			std::cerr << "Keccak doesn't match test vector" << std::endl;
+			return 15;
+		}
+	}
+
+	// All explode and implode implementations must give the same results
+	init_ctx(ctx[0], 0);
+	init_ctx(ctx[1], 0);
+	cn_explode_scratchpad(ctx[0]->hash_state, ctx[0]->long_state, EXPLODE_AESNI);
+	for (int impl = EXPLODE_VAES256; impl <= EXPLODE_VAES512; ++impl)
+	{
+		if (cn_explode_impl_supported(static_cast<explode_impl>(impl)))
+		{
+			cn_explode_scratchpad(ctx[1]->hash_state, ctx[1]->long_state, static_cast<explode_impl>(impl));
+			if (memcmp(ctx[0]->long_state, ctx[1]->long_state, MEMORY) != 0)
+			{
+				std::cerr << cn_explode_impl_name(static_cast<explode_impl>(impl)) << " explode doesn't match AES-NI explode" << std::endl;
+				return 13;
+			}
+
+			uint8_t hash_state[sizeof(ctx[0]->hash_state)];
+			memcpy(hash_state, ctx[0]->hash_state, sizeof(hash_state));
+			cn_implode_scratchpad(ctx[0]->long_state, hash_state, EXPLODE_AESNI);
+			cn_implode_scratchpad(ctx[1]->long_state, ctx[1]->hash_state, static_cast<explode_impl>(impl));
+			if (memcmp(hash_state, ctx[1]->hash_state, sizeof(hash_state)) != 0)
+			{
+				std::cerr << cn_explode_impl_name(static_cast<explode_impl>(impl)) << " implode doesn't match AES-NI implode" << std::endl;
+				return 14;
+			}
+			memcpy(ctx[1]->hash_state, ctx[0]->hash_state, sizeof(hash_state));
+		}
+	}
+	init_ctx(ctx[0], 0);
+	init_ctx(ctx[1], 1);
+
 	// Run benchmarks if the integrity check passed
 	std::cout << "rdtsc speed: " << rdtsc_speed << " GHz" << std::endl;
-	std::cout << "Running " << BENCHMARK_DURATION << " second benchmarks..." << std::endl;
+	std::cout << "Generated code memory: " << jit_buffer_mode_name(code_buf.mode) << std::endl;
+	std::cout << "Scratchpad memory: " << large_pages_kind_name(numa_get_ctx_page_kind(ctx[0])) << std::endl;
+	std::cout << "Generated code scheduled for: " << v4_get_uarch_info(uarch)->name << std::endl;
+	std::cout << "Generated code prefetch: " << v4_prefetch_points_name(prefetch.points) << ":" << v4_prefetch_hint_name(prefetch.hint) << std::endl;
+	std::cout << "Hardware counters: " << (benchmark_counters_available(bench) ? "perf events" : "not available") << std::endl;
+	std::cout << "Running " << options.duration_ms / 1000.0 << " second benchmarks..." << std::endl;
+
+	benchmark_set_info(bench, "generated_code_memory", jit_buffer_mode_name(code_buf.mode));
+	benchmark_set_info(bench, "scratchpad_memory", large_pages_kind_name(numa_get_ctx_page_kind(ctx[0])));
+	benchmark_set_info(bench, "generated_code_scheduled_for", v4_get_uarch_info(uarch)->name);
+	benchmark_set_info(bench, "generated_code_prefetch", std::string(v4_prefetch_points_name(prefetch.points)) + ":" + v4_prefetch_hint_name(prefetch.hint));
+
+	benchmark(CryptonightR_double_ref, "CryptonightR_double (reference code)", 2, ctx[0], ctx[1], code);
+    benchmark(CryptonightR_double, "CryptonightR_double (C++ code)", 2, ctx[0], ctx[1]);
+	benchmark(CryptonightR_double_SSE, "CryptonightR_double (C++ SSE code)", 2, ctx[0], ctx[1]);
+	benchmark_counters(CryptonightR_double_asm, "CryptonightR_double (ASM code)", 2, ctx[0], ctx[1]);
+    benchmark_counters(CryptonightR_double_generated, "CryptonightR_double (generated machine code)", 2, ctx[0], ctx[1]);
+    benchmark_counters(cnv2_double_mainloop_sandybridge_asm, "CryptonightV2_double", 2, ctx[0], ctx[1]);
 
-	benchmark(CryptonightR_double_ref, "CryptonightR_double (reference code)", ctx[0], ctx[1], code);
-    benchmark(CryptonightR_double, "CryptonightR_double (C++ code)", ctx[0], ctx[1]);
-	benchmark(CryptonightR_double_SSE, "CryptonightR_double (C++ SSE code)", ctx[0], ctx[1]);
-	benchmark(CryptonightR_double_asm, "CryptonightR_double (ASM code)", ctx[0], ctx[1]);
-    benchmark(CryptonightR_double_generated, "CryptonightR_double (generated machine code)", ctx[0], ctx[1]);
-    benchmark(cnv2_double_mainloop_sandybridge_asm, "CryptonightV2_double", ctx[0], ctx[1]);
+	std::cout << std::endl;
+
+	if (avx2)
+	{
+		benchmark(CryptonightR_quad_AVX2, "CryptonightR_quad (C++ AVX2 code)", 4, ctx + 1);
+	}
+
+	for (uint32_t ways = 3; ways <= 5; ++ways)
+	{
+		const std::string name = std::string(multi_names[ways]) + " (generated machine code)";
+		benchmark_counters(CryptonightR_multi_generated[ways], name.c_str(), ways, ctx + 1);
+	}
+
+	if (avx512)
+	{
+		benchmark(CryptonightR_avx512, "CryptonightR_avx512 (8 hashes)", AVX512_WAYS, ctx + 1, code);
+	}
 
 	std::cout << std::endl;
 
-	benchmark(CryptonightR_ref, "CryptonightR (reference code)", ctx[0], code);
-    benchmark(CryptonightR, "CryptonightR (C++ code)", ctx[1]);
-	benchmark(CryptonightR_asm, "CryptonightR (ASM code)", ctx[2]);
-	benchmark(CryptonightR_generated, "CryptonightR (generated machine code)", ctx[3]);
+	benchmark(CryptonightR_ref, "CryptonightR (reference code)", 1, ctx[0], code);
+	auto CryptonightR_interpreted = [&threaded_code](cryptonight_ctx* c) { CryptonightR_interpreter(c, threaded_code); };
+	benchmark_counters(CryptonightR_interpreted, "CryptonightR (threaded interpreter)", 1, ctx[0]);
+    benchmark(CryptonightR, "CryptonightR (C++ code)", 1, ctx[1]);
+	benchmark(CryptonightR_static<v4_static_program_for<RND_SEED>>, "CryptonightR (C++ code, compile-time program)", 1, ctx[1]);
+	benchmark(CryptonightR_static<v4_static_program_for<RND_SEED>, V4_PREFETCH_LINE>, "CryptonightR (C++ code, compile-time program, prefetch line:t0)", 1, ctx[1]);
+	benchmark(CryptonightR_static<v4_static_program_for<RND_SEED>, V4_PREFETCH_NEXT>, "CryptonightR (C++ code, compile-time program, prefetch next:t0)", 1, ctx[1]);
+	benchmark(CryptonightR_static<v4_static_program_for<RND_SEED>, V4_PREFETCH_BOTH>, "CryptonightR (C++ code, compile-time program, prefetch both:t0)", 1, ctx[1]);
+	benchmark_counters(CryptonightR_asm, "CryptonightR (ASM code)", 1, ctx[2]);
+	benchmark_counters(CryptonightR_generated, "CryptonightR (generated machine code)", 1, ctx[3]);
+	benchmark_counters(CryptonightR_generated_unscheduled, "CryptonightR (generated machine code, generator order)", 1, ctx[3]);
+	for (int i = 0; i < NUM_PREFETCH_VARIANTS; ++i)
+	{
+		const std::string name = std::string("CryptonightR (generated machine code, prefetch ") + v4_prefetch_points_name(prefetch_variants[i].points) + ":" + v4_prefetch_hint_name(prefetch_variants[i].hint) + ")";
+		benchmark_counters(CryptonightR_generated_prefetch[i], name.c_str(), 1, ctx[3]);
+	}
 
 	// Show CryptonightV2 performance for comparison
 	{
@@ -936,29 +1299,152 @@ int CryptonightR_test()
 		((int*)vendor)[2] = data[2];
 
 		mainloop_func func = (strcmp(vendor, "GenuineIntel") == 0) ? cnv2_mainloop_ivybridge_asm : cnv2_mainloop_ryzen_asm;
-		benchmark(func, "CryptonightV2", ctx[1]);
+		benchmark_counters(func, "CryptonightV2", 1, ctx[1]);
+	}
+
+	std::cout << std::endl;
+
+	for (int impl = EXPLODE_AESNI; impl <= EXPLODE_VAES512; ++impl)
+	{
+		if (cn_explode_impl_supported(static_cast<explode_impl>(impl)))
+		{
+			auto explode = [impl](cryptonight_ctx* c) { cn_explode_scratchpad(c->hash_state, c->long_state, static_cast<explode_impl>(impl)); };
+			const std::string name = std::string("Explode (") + cn_explode_impl_name(static_cast<explode_impl>(impl)) + ")";
+			benchmark(explode, name.c_str(), 1, ctx[4]);
+		}
+	}
+	for (int impl = EXPLODE_AESNI; impl <= EXPLODE_VAES512; ++impl)
+	{
+		if (cn_explode_impl_supported(static_cast<explode_impl>(impl)))
+		{
+			auto implode = [impl](cryptonight_ctx* c) { cn_implode_scratchpad(c->long_state, c->hash_state, static_cast<explode_impl>(impl)); };
+			const std::string name = std::string("Implode (") + cn_explode_impl_name(static_cast<explode_impl>(impl)) + ")";
+			benchmark(implode, name.c_str(), 1, ctx[4]);
+		}
 	}
+	init_ctx(ctx[4], 0);
 
 	std::cout << std::endl;
 
+	// Same kernels with scratchpads from one arena, for every coloring policy
+	{
+		const uint32_t color_steps[] = { ARENA_COLOR_NONE, ARENA_COLOR_CACHE_LINE, ARENA_COLOR_KB, ARENA_COLOR_PAGE };
+		const char* color_names[] = { "no coloring", "64 bytes", "1 KB + 64 bytes", "4 KB + 64 bytes" };
+
+		for (uint32_t i = 0; i < sizeof(color_steps) / sizeof(color_steps[0]); ++i)
+		{
+			scratchpad_arena* arena = arena_create(5, numa_get_current_node(), color_steps[i]);
+			if (!arena)
+			{
+				std::cerr << "Failed to create scratchpad arena" << std::endl;
+				return 1;
+			}
+			cryptonight_ctx** arena_ctx = arena_get_ctxs(arena);
+
+			for (uint32_t j = 0; j < 5; ++j)
+			{
+				init_ctx(arena_ctx[j], j % 2);
+			}
+
+			if (i == 0)
+			{
+				std::cout << "Scratchpad arena memory: " << large_pages_kind_name(arena_get_page_kind(arena)) << std::endl;
+			}
+			std::cout << "Scratchpad coloring: " << color_names[i] << std::endl;
+
+			const std::string suffix = std::string(", coloring: ") + color_names[i];
+			benchmark(CryptonightR_double_generated, ("CryptonightR_double (generated machine code" + suffix + ")").c_str(), 2, arena_ctx[0], arena_ctx[1]);
+			benchmark(cnv2_double_mainloop_sandybridge_asm, ("CryptonightV2_double (" + suffix.substr(2) + ")").c_str(), 2, arena_ctx[0], arena_ctx[1]);
+			benchmark(CryptonightR_multi_generated[5], ("CryptonightR_penta (generated machine code" + suffix + ")").c_str(), 5, arena_ctx);
+
+			// Colored scratchpads aren't 2 MB aligned, check that results don't depend on it
+			init_ctx(ctx[0], 12345);
+			init_ctx(arena_ctx[1], 12345);
+			CryptonightR_ref(ctx[0], code);
+			CryptonightR_double_generated(arena_ctx[0], arena_ctx[1]);
+			const bool passed = (memcmp(ctx[0]->long_state, arena_ctx[1]->long_state, MEMORY) == 0);
+
+			arena_destroy(arena);
+
+			if (!passed)
+			{
+				std::cerr << "Generated machine code doesn't match reference code with colored scratchpads" << std::endl;
+				return 12;
+			}
+		}
+
+		std::cout << std::endl;
+	}
+
 	memcpy(ctx[0]->long_state, ctx[3]->long_state, MEMORY);
 
-	// Test 1000 random code sequences and compare them with reference code
+	// Test 1000 random code sequences and compare them with reference code, "--sweep" benchmarks them
+	// Kernels for the next heights are compiled in background while the current height is being tested
+	const uint32_t ways_mask = KERNEL_SINGLE | KERNEL_DOUBLE | KERNEL_TRIPLE | KERNEL_QUAD | KERNEL_PENTA;
+	kernel_cache* cache = kernel_cache_create(32, ways_mask, 2);
+	if (!cache)
+	{
+		std::cerr << "Failed to create kernel cache" << std::endl;
+		return 1;
+	}
+
+	// Precompiled code for all tested heights is built on the first run and memory-mapped after that
+	code_file* precompiled = code_file_open("CryptonightR_code.bin");
+	if (!precompiled && code_file_build("CryptonightR_code.bin", 0, 1000, ways_mask))
+	{
+		precompiled = code_file_open("CryptonightR_code.bin");
+	}
+	if (precompiled)
+	{
+		kernel_cache_attach_file(cache, precompiled);
+	}
+
 	for (int i = 0; i < 1000; ++i)
 	{
 		v4_random_math_init(code, i);
-		const int num_insts = compile_code(code, machine_code);
-        compile_code_double(code, machine_code_double);
-		memcpy(CryptonightR_generated, machine_code.data(), machine_code.size());
-        memcpy(CryptonightR_double_generated, machine_code_double.data(), machine_code_double.size());
-        FlushInstructionCache(GetCurrentProcess(), CryptonightR_generated, machine_code.size());
-        FlushInstructionCache(GetCurrentProcess(), CryptonightR_double_generated, machine_code_double.size());
+		kernel_cache_set_height(cache, i);
+
+		// Every program once through the interpreter, it's much faster than a main loop
+		{
+			v4_reg r1[8], r2[8];
+			for (int j = 0; j < 8; ++j)
+			{
+				r1[j] = r2[j] = static_cast<v4_reg>((i + 1) * 0x9E3779B97F4A7C15ULL * (j + 1));
+			}
+			v4_threaded_compile(code, threaded_code);
+			v4_random_math(code, r1);
+			v4_threaded_run(threaded_code, r2);
+			if (memcmp(r1, r2, sizeof(r1)) != 0)
+			{
+				std::cerr << "Threaded interpreter doesn't match random math for height " << i << std::endl;
+				return 20;
+			}
+		}
+
+		// Same function as for compiled-in kernels, but at run time
+		{
+			const v4_static_program program = v4_static_random_math_init(i);
+			if (!v4_static_program_equal(program, code))
+			{
+				std::cerr << "Compile-time program doesn't match random math for height " << i << std::endl;
+				return 21;
+			}
+		}
+
+		const kernel_cache_entry* single = kernel_cache_acquire(cache, i, 1);
+		const kernel_cache_entry* dbl = kernel_cache_acquire(cache, i, 2);
+		if (!single || !dbl)
+		{
+			std::cerr << "Failed to compile code for height " << i << std::endl;
+			return 1;
+		}
+		mainloop_func generated = (mainloop_func) single->func;
+		mainloop_double_func double_generated = (mainloop_double_func) dbl->func;
 
         init_ctx(ctx[0], i);
         init_ctx(ctx[1], i);
         CryptonightR_ref(ctx[0], code);
-		CryptonightR_generated(ctx[1]);
-		benchmark(CryptonightR_generated, "CryptonightR (generated machine code)", ctx[3]);
+		generated(ctx[1]);
 
 		if (memcmp(ctx[0]->long_state, ctx[1]->long_state, MEMORY) != 0)
 		{
@@ -971,7 +1457,7 @@ int CryptonightR_test()
         init_ctx(ctx[2], i * 2);
         init_ctx(ctx[3], i * 2 + 1);
         CryptonightR_double_ref(ctx[0], ctx[1], code);
-        CryptonightR_double_generated(ctx[2], ctx[3]);
+        double_generated(ctx[2], ctx[3]);
 
         if ((memcmp(ctx[0]->long_state, ctx[2]->long_state, MEMORY) != 0) || (memcmp(ctx[1]->long_state, ctx[3]->long_state, MEMORY) != 0))
         {
@@ -979,8 +1465,357 @@ int CryptonightR_test()
             return 7;
         }
 
-        std::cout << "Random code test " << i << " (" << num_insts << " instructions) passed\n\n";
+		for (uint32_t ways = 3; ways <= 5; ++ways)
+		{
+			const kernel_cache_entry* multi = kernel_cache_acquire(cache, i, ways);
+			if (!multi)
+			{
+				std::cerr << "Failed to compile code for height " << i << std::endl;
+				return 1;
+			}
+
+			const bool passed = check_multi((mainloop_multi_func) multi->func, ways, code, ctx, i * 8);
+			kernel_cache_release(cache, multi);
+
+			if (!passed)
+			{
+				std::cerr << "Generated machine code (" << ways << " ways) doesn't match reference code" << std::endl;
+				return 7;
+			}
+		}
+
+		if (avx512 && !check_multi(CryptonightR_avx512_code, AVX512_WAYS, code, ctx, i * 8))
+		{
+			std::cerr << "AVX-512 code doesn't match reference code" << std::endl;
+			return 7;
+		}
+
+        std::cout << "Random code test " << i << " (" << single->num_insts << " instructions) passed\n\n";
+
+		kernel_cache_release(cache, single);
+		kernel_cache_release(cache, dbl);
+	}
+
+	const kernel_cache_stats stats = kernel_cache_get_stats(cache);
+	std::cout << "Kernel cache: " << stats.hits << " hits, " << stats.misses << " misses, " << stats.precompiled << " compiled in background, " << stats.from_file << " loaded from file" << std::endl;
+	kernel_cache_destroy(cache);
+	code_file_close(precompiled);
+
+	// --check-heights compares digests instead of scratchpads, so one changed byte must change the digest
+	{
+		init_ctx(ctx[0], 1);
+		init_ctx(ctx[1], 1);
+		const height_check_digest d0 = height_check_get_digest(ctx[0]);
+		const height_check_digest d1 = height_check_get_digest(ctx[1]);
+		ctx[1]->long_state[MEMORY / 2] ^= 1;
+		const height_check_digest d2 = height_check_get_digest(ctx[1]);
+		if ((d0.lo != d1.lo) || (d0.hi != d1.hi) || ((d0.lo == d2.lo) && (d0.hi == d2.hi)))
+		{
+			std::cerr << "Scratchpad digest doesn't work" << std::endl;
+			return 19;
+		}
+	}
+
+	// Complete hash must match the known hash and all stages done one by one with reference code, then show where the time goes
+	{
+		const char input[] = "This is a test This is a test This is a test";
+		const uint64_t height = 1806260;
+
+#if RANDOM_MATH_64_BIT == 0
+		// cn_slow_hash output for this generator version (8 registers, height-only seed), final hash is Blake-256
+		static const uint8_t known_hash[32] = {
+			0x9d, 0x47, 0xbf, 0x4c, 0x41, 0xb7, 0xe8, 0xe7, 0x27, 0xe6, 0x81, 0x71, 0x5a, 0xcb, 0x47, 0xfa,
+			0x16, 0x77, 0xcd, 0xba, 0x9c, 0xa7, 0xbc, 0xb0, 0x5a, 0xd8, 0xcc, 0x8a, 0xbd, 0x5d, 0xaa, 0x66,
+		};
+#endif
+
+		uint8_t hash[32];
+		cn_r_hash_times times;
+		if (!cn_r_hash(input, sizeof(input) - 1, height, hash, &times))
+		{
+			std::cerr << "Failed to allocate memory for scratchpad" << std::endl;
+			return 1;
+		}
+#if RANDOM_MATH_64_BIT == 0
+		if (memcmp(hash, known_hash, sizeof(hash)) != 0)
+		{
+			std::cerr << "cn_r_hash doesn't match known hash" << std::endl;
+			return 15;
+		}
+#endif
+
+		uint8_t ref_hash[32];
+		v4_random_math_init(code, height);
+		cn_r_prepare(ctx[0], (const uint8_t*) input, sizeof(input) - 1);
+		CryptonightR_ref(ctx[0], code);
+		cn_r_finish(ctx[0], ref_hash);
+		if (memcmp(hash, ref_hash, sizeof(hash)) != 0)
+		{
+			std::cerr << "cn_r_hash doesn't match reference code" << std::endl;
+			return 15;
+		}
+
+		cn_r_hash_times min_times = times;
+		uint64_t min_total = ~0ULL;
+		const auto end_time = std::chrono::high_resolution_clock::now() + std::chrono::seconds(BENCHMARK_DURATION);
+		do
+		{
+			cn_r_hash(input, sizeof(input) - 1, height, hash, &times);
+			const uint64_t total = times.keccak + times.explode + times.main_loop + times.implode + times.final_hash;
+			if (total < min_total)
+			{
+				min_total = total;
+				min_times = times;
+			}
+		} while (std::chrono::high_resolution_clock::now() < end_time);
+
+		auto us = [](uint64_t t) { return t / (rdtsc_speed * 1e3); };
+		std::cout << "cn_r_hash latency (" << cn_r_mainloop_kind_name(min_times.mainloop_kind) << "): " << us(min_total) << " us" << std::endl;
+		std::cout << "  Keccak: " << us(min_times.keccak) << " us" << std::endl;
+		std::cout << "  Explode: " << us(min_times.explode) << " us" << std::endl;
+		std::cout << "  Main loop: " << us(min_times.main_loop) << " us" << std::endl;
+		std::cout << "  Implode: " << us(min_times.implode) << " us" << std::endl;
+		std::cout << "  Final hash: " << us(min_times.final_hash) << " us" << std::endl;
+	}
+
+	// Batch hashing must give the same hashes as single calls, heights are mixed to test grouping
+	{
+		enum { BATCH_SIZE = 11 };
+
+		uint8_t inputs[BATCH_SIZE][76];
+		const void* input_ptrs[BATCH_SIZE];
+		size_t lens[BATCH_SIZE];
+		uint64_t heights[BATCH_SIZE];
+		for (uint32_t i = 0; i < BATCH_SIZE; ++i)
+		{
+			for (uint32_t j = 0; j < sizeof(inputs[i]); ++j)
+			{
+				inputs[i][j] = static_cast<uint8_t>(i * 59 + j * 7);
+			}
+			input_ptrs[i] = inputs[i];
+			lens[i] = sizeof(inputs[i]) - (i % 3);
+			heights[i] = 1806260 + (i % 3);
+		}
+
+		uint8_t expected[BATCH_SIZE][32];
+		for (uint32_t i = 0; i < BATCH_SIZE; ++i)
+		{
+			cn_r_hash(input_ptrs[i], lens[i], heights[i], expected[i]);
+		}
+
+		for (uint32_t ways = 1; ways <= KERNEL_CACHE_MAX_WAYS; ++ways)
+		{
+			cn_r_batch* batch = cn_r_batch_create(ways, numa_get_current_node());
+			if (!batch)
+			{
+				std::cerr << "Failed to create hash batch" << std::endl;
+				return 1;
+			}
+
+			uint8_t outputs[BATCH_SIZE][32];
+			cn_r_hash_batch(batch, input_ptrs, lens, heights, outputs[0], BATCH_SIZE);
+			if (memcmp(outputs, expected, sizeof(expected)) != 0)
+			{
+				cn_r_batch_destroy(batch);
+				std::cerr << "cn_r_hash_batch (" << ways << " ways) doesn't match cn_r_hash" << std::endl;
+				return 16;
+			}
+
+			// Verification throughput for one height, like a pool checking shares of the current block
+			for (uint32_t i = 0; i < BATCH_SIZE; ++i)
+			{
+				heights[i] = 1806260;
+			}
+			const auto start_time = std::chrono::high_resolution_clock::now();
+			cn_r_hash_batch(batch, input_ptrs, lens, heights, outputs[0], BATCH_SIZE);
+			const double dt = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start_time).count();
+			for (uint32_t i = 0; i < BATCH_SIZE; ++i)
+			{
+				heights[i] = 1806260 + (i % 3);
+			}
+
+			std::cout << "cn_r_hash_batch (" << ways << " ways): " << BATCH_SIZE / dt << " H/s" << std::endl;
+			cn_r_batch_destroy(batch);
+		}
+
+		std::cout << "cn_r_hash_batch default: " << cn_r_batch_get_best_ways() << " ways" << std::endl;
+	}
+
+#ifndef _WIN32
+	// Verification service must return the same hashes through the socket and through the shared memory ring
+	{
+		enum { NUM_INPUTS = 8 };
+
+		const std::string socket_path = "/tmp/cnr_verifier_test_" + std::to_string(getpid()) + ".sock";
+		verifier_config config = {};
+		config.socket_path = socket_path.c_str();
+		config.num_threads = 2;
+		config.ways = 2;
+		config.max_queued = VERIFIER_DEFAULT_MAX_QUEUED;
+
+		verifier* v = verifier_start(config);
+		if (!v)
+		{
+			std::cerr << "Failed to start verifier" << std::endl;
+			return 1;
+		}
+
+		uint8_t inputs[NUM_INPUTS][76];
+		const void* input_ptrs[NUM_INPUTS];
+		size_t lens[NUM_INPUTS];
+		uint64_t heights[NUM_INPUTS];
+		uint8_t expected[NUM_INPUTS][32];
+		for (uint32_t i = 0; i < NUM_INPUTS; ++i)
+		{
+			for (uint32_t j = 0; j < sizeof(inputs[i]); ++j)
+			{
+				inputs[i][j] = static_cast<uint8_t>(i * 31 + j * 11);
+			}
+			input_ptrs[i] = inputs[i];
+			lens[i] = sizeof(inputs[i]) - (i % 2);
+			heights[i] = 1806260 + (i % 2);
+			cn_r_hash(input_ptrs[i], lens[i], heights[i], expected[i]);
+		}
+
+		uint8_t socket_hashes[NUM_INPUTS][32] = {};
+		uint8_t ring_hashes[NUM_INPUTS][32] = {};
+		verifier_client* client = verifier_client_connect(config.socket_path);
+		const verifier_status socket_status = client ? verifier_client_hash(client, input_ptrs, lens, heights, socket_hashes[0], NUM_INPUTS) : VERIFIER_ERROR;
+
+		// 2 calls with 5 slots, so the second one wraps around the ring
+		verifier_status ring_status = VERIFIER_ERROR;
+		if (client && verifier_client_attach_ring(client, 5))
+		{
+			ring_status = verifier_client_ring_hash(client, input_ptrs, lens, heights, ring_hashes[0], 4);
+			if (ring_status == VERIFIER_OK)
+			{
+				ring_status = verifier_client_ring_hash(client, input_ptrs + 4, lens + 4, heights + 4, ring_hashes[4], 4);
+			}
+		}
+		verifier_client_close(client);
+
+		const verifier_stats stats = verifier_get_stats(v);
+		verifier_stop(v);
+
+		if ((socket_status != VERIFIER_OK) || (memcmp(socket_hashes, expected, sizeof(expected)) != 0))
+		{
+			std::cerr << "Verifier socket hashes don't match cn_r_hash" << std::endl;
+			return 17;
+		}
+		if ((ring_status != VERIFIER_OK) || (memcmp(ring_hashes, expected, sizeof(expected)) != 0))
+		{
+			std::cerr << "Verifier shared memory ring hashes don't match cn_r_hash" << std::endl;
+			return 17;
+		}
+
+		std::cout << "Verifier: " << stats.hashes << " hashes in " << stats.requests << " jobs" << std::endl;
+	}
+#endif
+
+	// Nonce search must hash every nonce exactly once, with at least 2 threads to test stealing
+	{
+		const uint32_t num_threads = std::max(std::thread::hardware_concurrency(), 2U);
+		const nonce_search_hash_funcs funcs = { cn_r_prepare, cn_r_finish };
+		nonce_search* search = nonce_search_create(num_threads, nullptr, 1, funcs);
+		if (!search)
+		{
+			std::cerr << "Failed to create nonce search" << std::endl;
+			return 1;
+		}
+
+		nonce_search_job job = {};
+		for (uint32_t i = 0; i < 76; ++i)
+		{
+			job.blob[i] = static_cast<uint8_t>(i * 37);
+		}
+		job.blob_size = 76;
+		job.nonce_offset = 39;
+		job.height = 1000;
+		job.target = ~0ULL;
+		job.first_nonce = 100;
+		job.last_nonce = 100 + num_threads * 4;
+
+		const auto start_time = std::chrono::high_resolution_clock::now();
+		nonce_search_start(search, job);
+		nonce_search_wait(search);
+		const double dt = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start_time).count();
+
+		std::vector<nonce_search_result> results;
+		nonce_search_get_results(search, results);
+
+		// Per-node report: everything a worker touches in the main loop must be on its own node
+		uint64_t node_hashes[NUMA_MAX_NODES] = {};
+		uint64_t node_local_pages[NUMA_MAX_NODES] = {};
+		uint64_t node_remote_pages[NUMA_MAX_NODES] = {};
+		uint32_t node_remote_code[NUMA_MAX_NODES] = {};
+		large_page_kind page_kind = PAGES_HUGETLB_1GB;
+		bool placement_known = true;
+		for (uint32_t i = 0; i < nonce_search_get_num_threads(search); ++i)
+		{
+			nonce_search_worker_info info;
+			placement_known = nonce_search_get_worker_info(search, i, info) && placement_known;
+
+			const uint32_t node = (info.node >= 0) ? static_cast<uint32_t>(info.node) : 0;
+			node_hashes[node] += info.hashes;
+			node_local_pages[node] += info.local_pages;
+			node_remote_pages[node] += info.remote_pages;
+			if ((info.code_node >= 0) && (static_cast<uint32_t>(info.code_node) != node))
+			{
+				++node_remote_code[node];
+			}
+			if (info.page_kind < page_kind)
+			{
+				page_kind = info.page_kind;
+			}
+		}
+		nonce_search_destroy(search);
+
+		for (uint32_t node = 0; node < numa_get_node_count(); ++node)
+		{
+			std::cout << "NUMA node " << node << ": " << node_hashes[node] << " hashes, " << node_local_pages[node] << " local pages, " << node_remote_pages[node] << " remote pages, " << node_remote_code[node] << " workers with remote code" << std::endl;
+		}
+		if (!placement_known)
+		{
+			std::cout << "NUMA placement can't be queried on this system" << std::endl;
+		}
+		std::cout << "Nonce search scratchpads: " << large_pages_kind_name(page_kind) << std::endl;
+
+		std::vector<bool> found(job.last_nonce - job.first_nonce);
+		v4_random_math_init(code, job.height);
+		for (const nonce_search_result& result : results)
+		{
+			if ((result.nonce < job.first_nonce) || (result.nonce >= job.last_nonce) || found[result.nonce - job.first_nonce])
+			{
+				std::cerr << "Nonce search returned wrong nonce " << result.nonce << std::endl;
+				return 11;
+			}
+			found[result.nonce - job.first_nonce] = true;
+
+			uint8_t blob[NONCE_SEARCH_MAX_BLOB_SIZE];
+			memcpy(blob, job.blob, job.blob_size);
+			memcpy(blob + job.nonce_offset, &result.nonce, sizeof(uint32_t));
+			cn_r_prepare(ctx[0], blob, job.blob_size);
+			CryptonightR_ref(ctx[0], code);
+
+			uint8_t hash[32];
+			cn_r_finish(ctx[0], hash);
+			if (memcmp(hash, result.hash, sizeof(hash)) != 0)
+			{
+				std::cerr << "Nonce search hash doesn't match reference code for nonce " << result.nonce << std::endl;
+				return 11;
+			}
+		}
+
+		if (results.size() != found.size())
+		{
+			std::cerr << "Nonce search returned " << results.size() << " results instead of " << found.size() << std::endl;
+			return 11;
+		}
+
+		std::cout << "Nonce search: " << num_threads << " threads, " << results.size() / dt << " H/s" << std::endl;
 	}
 
-	return 0;
+	const bool json_written = benchmark_write_json(bench);
+	benchmark_registry_destroy(bench);
+	return json_written ? 0 : 1;
 }
@@ -0,0 +1,880 @@
+#include "CryptonightR_verifier.h"
+#include "CryptonightR_hash.h"
+#include "CryptonightR_numa.h"
+#include <string.h>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+#include <algorithm>
+#include <deque>
+#include <map>
+#include <memory>
+#include <vector>
+
+#ifndef _WIN32
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/eventfd.h>
+#include <poll.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#include <signal.h>
+#include <setjmp.h>
+#endif
+
+enum
+{
+	// Bytes read from a socket at once
+	VERIFIER_RECV_SIZE = 65536,
+
+	MAX_MESSAGE_SIZE = sizeof(verifier_msg_header) + VERIFIER_MAX_BATCH * (sizeof(verifier_entry_header) + VERIFIER_MAX_INPUT_SIZE),
+
+	// Unsent answers on one connection before the service stops reading its requests (client doesn't read answers)
+	MAX_PENDING_OUTPUT = 1 << 20,
+
+	// File descriptors received on one connection and not taken by VERIFIER_MSG_SHM_ATTACH yet
+	MAX_PENDING_FDS = 4,
+};
+
+#ifndef _WIN32
+
+struct verifier_conn
+{
+	int fd;
+
+	// Only used by the I/O thread
+	std::vector<uint8_t> in;
+	std::deque<int> in_fds;
+	bool closed;
+
+	// Filled by workers, sent by the I/O thread
+	std::mutex out_mutex;
+	std::vector<uint8_t> out;
+
+	// Shared memory ring, slots are taken in order starting from ring_next
+	// num_slots is copied when the ring is attached, the client can change the header at any time
+	verifier_ring_header* ring;
+	size_t ring_size;
+	uint32_t num_slots;
+	uint32_t ring_next;
+
+	// Set by workers when ring memory is gone (truncated by the client), the I/O thread closes the connection
+	std::atomic<bool> ring_failed;
+
+	verifier_conn() : fd(-1), closed(false), ring(nullptr), ring_size(0), num_slots(0), ring_next(0), ring_failed(false) {}
+
+	~verifier_conn()
+	{
+		if (ring)
+		{
+			munmap(ring, ring_size);
+		}
+		for (int ring_fd : in_fds)
+		{
+			close(ring_fd);
+		}
+		if (fd >= 0)
+		{
+			close(fd);
+		}
+	}
+
+	verifier_ring_slot* slot(uint32_t index) const
+	{
+		return reinterpret_cast<verifier_ring_slot*>(ring + 1) + index;
+	}
+};
+
+struct verifier_job
+{
+	std::shared_ptr<verifier_conn> conn;
+	uint64_t request_id;
+
+	// Socket jobs: inputs are copied from the message
+	std::vector<uint8_t> data;
+	std::vector<const void*> inputs;
+	std::vector<size_t> lens;
+	std::vector<uint64_t> heights;
+
+	// Ring jobs: slots [first_slot, first_slot + count) modulo num_slots, inputs are copied from the ring by the worker
+	bool ring;
+	uint32_t first_slot;
+};
+
+struct verifier
+{
+	verifier_config config;
+	int listen_fd;
+	int wake_fd;
+
+	// Socket path was bound by this service, verifier_stop removes it
+	bool bound;
+
+	std::thread io_thread;
+	std::vector<std::thread> workers;
+	std::atomic<bool> stop;
+
+	std::mutex jobs_mutex;
+	std::condition_variable jobs_cond;
+	std::deque<verifier_job> jobs;
+
+	std::atomic<uint32_t> queued;
+	std::atomic<uint64_t> hashes;
+	std::atomic<uint64_t> requests;
+	std::atomic<uint64_t> busy;
+	std::atomic<uint64_t> bad_requests;
+	std::atomic<uint32_t> connections;
+
+	// Workers which finished warming up
+	std::atomic<uint32_t> ready_workers;
+};
+
+// Client can truncate the shared memory object at any time, ring pages beyond the new size raise SIGBUS.
+// Ring memory is only accessed in ring_access, which returns false instead of crashing.
+static thread_local sigjmp_buf* ring_guard = nullptr;
+static struct sigaction prev_sigbus_action;
+
+static void sigbus_handler(int, siginfo_t*, void*)
+{
+	if (ring_guard)
+	{
+		siglongjmp(*ring_guard, 1);
+	}
+
+	// Not a ring access: the faulting instruction runs again with the previous handler
+	sigaction(SIGBUS, &prev_sigbus_action, nullptr);
+}
+
+static void install_sigbus_handler()
+{
+	static std::once_flag once;
+	std::call_once(once, []()
+	{
+		struct sigaction action = {};
+		action.sa_sigaction = sigbus_handler;
+		action.sa_flags = SA_SIGINFO | SA_NODEFER;
+		sigemptyset(&action.sa_mask);
+		sigaction(SIGBUS, &action, &prev_sigbus_action);
+	});
+}
+
+// f must not create objects with destructors, they are skipped when it's interrupted
+template<typename F>
+static bool ring_access(F&& f)
+{
+	sigjmp_buf env;
+	if (sigsetjmp(env, 0))
+	{
+		ring_guard = nullptr;
+		return false;
+	}
+
+	ring_guard = &env;
+	f();
+	ring_guard = nullptr;
+	return true;
+}
+
+static void wake_io_thread(verifier* v)
+{
+	const uint64_t one = 1;
+	if (write(v->wake_fd, &one, sizeof(one)) < 0)
+	{
+		// Counter is already non-zero, I/O thread will wake up anyway
+	}
+}
+
+static void append_message(verifier_conn* conn, uint32_t type, uint32_t count, uint32_t status, uint64_t request_id, const uint8_t* payload, size_t payload_size)
+{
+	const verifier_msg_header header = { VERIFIER_MAGIC, type, count, status, request_id };
+
+	std::lock_guard<std::mutex> lock(conn->out_mutex);
+	conn->out.insert(conn->out.end(), (const uint8_t*) &header, (const uint8_t*) (&header + 1));
+	conn->out.insert(conn->out.end(), payload, payload + payload_size);
+}
+
+static void worker_thread(verifier* v)
+{
+	cn_r_batch* batch = cn_r_batch_create(v->config.ways ? v->config.ways : cn_r_batch_get_best_ways(), numa_get_current_node());
+
+	if (batch && v->config.warm)
+	{
+		uint8_t input[76] = {};
+		const void* input_ptr = input;
+		const size_t len = sizeof(input);
+		uint8_t hash[32];
+		cn_r_hash_batch(batch, &input_ptr, &len, &v->config.warm_height, hash, 1);
+	}
+	v->ready_workers.fetch_add(1);
+
+	std::vector<uint8_t> outputs(VERIFIER_MAX_BATCH * 32);
+	std::vector<const void*> inputs(VERIFIER_MAX_BATCH);
+	std::vector<size_t> lens(VERIFIER_MAX_BATCH);
+	std::vector<uint64_t> heights(VERIFIER_MAX_BATCH);
+	std::vector<uint8_t> ring_inputs(VERIFIER_MAX_BATCH * VERIFIER_MAX_INPUT_SIZE);
+
+	for (;;)
+	{
+		verifier_job job;
+		{
+			std::unique_lock<std::mutex> lock(v->jobs_mutex);
+			v->jobs_cond.wait(lock, [v]() { return v->stop.load() || !v->jobs.empty(); });
+			if (v->jobs.empty())
+			{
+				break;
+			}
+			job = std::move(v->jobs.front());
+			v->jobs.pop_front();
+		}
+
+		const uint32_t count = job.ring ? static_cast<uint32_t>(job.heights.size()) : static_cast<uint32_t>(job.inputs.size());
+
+		if (job.ring)
+		{
+			const verifier_conn* conn = job.conn.get();
+			const uint32_t num_slots = conn->num_slots;
+
+			// Inputs are copied, so hashing never touches ring memory
+			bool ring_ok = ring_access([&]()
+			{
+				for (uint32_t i = 0; i < count; ++i)
+				{
+					const verifier_ring_slot* slot = conn->slot((job.first_slot + i) % num_slots);
+
+					// Client can't be trusted with sizes, it can still write to the slot
+					const uint32_t size = slot->size;
+					lens[i] = std::min<uint32_t>(size, VERIFIER_MAX_INPUT_SIZE);
+					memcpy(ring_inputs.data() + i * VERIFIER_MAX_INPUT_SIZE, slot->input, lens[i]);
+					inputs[i] = ring_inputs.data() + i * VERIFIER_MAX_INPUT_SIZE;
+					heights[i] = job.heights[i];
+				}
+			});
+
+			const bool ok = ring_ok && batch && cn_r_hash_batch(batch, inputs.data(), lens.data(), heights.data(), outputs.data(), count);
+
+			ring_ok = ring_ok && ring_access([&]()
+			{
+				for (uint32_t i = 0; i < count; ++i)
+				{
+					verifier_ring_slot* slot = conn->slot((job.first_slot + i) % num_slots);
+					memcpy(slot->hash, outputs.data() + i * 32, 32);
+					slot->status = ok ? VERIFIER_OK : VERIFIER_ERROR;
+					slot->state.store(VERIFIER_SLOT_DONE, std::memory_order_release);
+				}
+			});
+
+			if (ring_ok)
+			{
+				append_message(job.conn.get(), VERIFIER_MSG_SHM_DONE, count, VERIFIER_OK, job.request_id, nullptr, 0);
+			}
+			else
+			{
+				job.conn->ring_failed.store(true);
+			}
+		}
+		else
+		{
+			const bool ok = batch && cn_r_hash_batch(batch, job.inputs.data(), job.lens.data(), job.heights.data(), outputs.data(), count);
+			append_message(job.conn.get(), VERIFIER_MSG_RESULT, ok ? count : 0, ok ? VERIFIER_OK : VERIFIER_ERROR, job.request_id, outputs.data(), ok ? count * 32 : 0);
+		}
+
+		v->hashes.fetch_add(count);
+		v->queued.fetch_sub(count);
+		wake_io_thread(v);
+	}
+
+	cn_r_batch_destroy(batch);
+}
+
+static void push_job(verifier* v, verifier_job&& job, uint32_t count)
+{
+	v->queued.fetch_add(count);
+	v->requests.fetch_add(1);
+	{
+		std::lock_guard<std::mutex> lock(v->jobs_mutex);
+		v->jobs.emplace_back(std::move(job));
+	}
+	v->jobs_cond.notify_one();
+}
+
+// Takes ownership of fd, it's received from the client, so only the client's own ring can be attached
+static bool attach_ring(verifier_conn* conn, int fd)
+{
+	// Jobs in flight may still use the current mapping
+	if (conn->ring)
+	{
+		close(fd);
+		return false;
+	}
+
+	struct stat st;
+	if ((fstat(fd, &st) != 0) || (static_cast<size_t>(st.st_size) < sizeof(verifier_ring_header)))
+	{
+		close(fd);
+		return false;
+	}
+
+	void* p = mmap(nullptr, st.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	close(fd);
+	if (p == MAP_FAILED)
+	{
+		return false;
+	}
+
+	// Header is read once, the client can truncate the object or change num_slots later
+	const verifier_ring_header* ring = (const verifier_ring_header*) p;
+	uint32_t magic = 0;
+	uint32_t num_slots = 0;
+	const bool mapped = ring_access([&]()
+	{
+		magic = ring->magic;
+		num_slots = ring->num_slots;
+	});
+
+	if (!mapped || (magic != VERIFIER_MAGIC) || (num_slots == 0) || (sizeof(verifier_ring_header) + static_cast<size_t>(num_slots) * sizeof(verifier_ring_slot) > static_cast<size_t>(st.st_size)))
+	{
+		munmap(p, st.st_size);
+		return false;
+	}
+
+	conn->ring = (verifier_ring_header*) p;
+	conn->ring_size = st.st_size;
+	conn->num_slots = num_slots;
+	conn->ring_next = 0;
+	return true;
+}
+
+// Takes submitted slots from the ring while there is room in the queue
+static void poll_ring(verifier* v, const std::shared_ptr<verifier_conn>& conn)
+{
+	if (!conn->ring)
+	{
+		return;
+	}
+
+	if (conn->ring_failed.load())
+	{
+		conn->closed = true;
+		return;
+	}
+
+	const uint32_t num_slots = conn->num_slots;
+	for (;;)
+	{
+		verifier_job job;
+		job.ring = true;
+		job.first_slot = conn->ring_next;
+		job.request_id = conn->ring_next;
+
+		const uint32_t queued = v->queued.load();
+		const uint32_t max_count = (queued < v->config.max_queued) ? std::min<uint32_t>(std::min<uint32_t>(VERIFIER_MAX_BATCH, num_slots), v->config.max_queued - queued) : 0;
+		job.heights.resize(max_count);
+
+		uint32_t count = 0;
+		const bool ring_ok = ring_access([&]()
+		{
+			while (count < max_count)
+			{
+				verifier_ring_slot* slot = conn->slot((conn->ring_next + count) % num_slots);
+				if (slot->state.load(std::memory_order_acquire) != VERIFIER_SLOT_SUBMITTED)
+				{
+					break;
+				}
+
+				slot->state.store(VERIFIER_SLOT_PROCESSING, std::memory_order_relaxed);
+				job.heights[count] = slot->height;
+				++count;
+			}
+		});
+
+		if (!ring_ok)
+		{
+			conn->closed = true;
+			return;
+		}
+
+		if (count == 0)
+		{
+			return;
+		}
+		job.heights.resize(count);
+
+		conn->ring_next = (conn->ring_next + count) % num_slots;
+		job.conn = conn;
+		push_job(v, std::move(job), count);
+	}
+}
+
+static bool output_full(verifier_conn* conn)
+{
+	std::lock_guard<std::mutex> lock(conn->out_mutex);
+	return conn->out.size() >= MAX_PENDING_OUTPUT;
+}
+
+// Returns false if the connection must be closed
+// Stops when too many answers are unsent, the rest of the input is processed after they're sent
+static bool process_input(verifier* v, const std::shared_ptr<verifier_conn>& conn)
+{
+	std::vector<uint8_t>& in = conn->in;
+	size_t pos = 0;
+	bool paused = false;
+
+	while (in.size() - pos >= sizeof(verifier_msg_header))
+	{
+		if (output_full(conn.get()))
+		{
+			paused = true;
+			break;
+		}
+
+		verifier_msg_header header;
+		memcpy(&header, in.data() + pos, sizeof(header));
+		if (header.magic != VERIFIER_MAGIC)
+		{
+			v->bad_requests.fetch_add(1);
+			return false;
+		}
+
+		const uint8_t* p = in.data() + pos + sizeof(header);
+		const uint8_t* e = in.data() + in.size();
+
+		if (header.type == VERIFIER_MSG_HASH)
+		{
+			if ((header.count == 0) || (header.count > VERIFIER_MAX_BATCH))
+			{
+				v->bad_requests.fetch_add(1);
+				append_message(conn.get(), VERIFIER_MSG_RESULT, 0, VERIFIER_BAD_REQUEST, header.request_id, nullptr, 0);
+				return false;
+			}
+
+			// Wait for the whole message
+			const uint8_t* q = p;
+			bool complete = true;
+			for (uint32_t i = 0; i < header.count; ++i)
+			{
+				verifier_entry_header entry;
+				if (e - q < static_cast<ptrdiff_t>(sizeof(entry)))
+				{
+					complete = false;
+					break;
+				}
+				memcpy(&entry, q, sizeof(entry));
+				if (entry.size > VERIFIER_MAX_INPUT_SIZE)
+				{
+					v->bad_requests.fetch_add(1);
+					append_message(conn.get(), VERIFIER_MSG_RESULT, 0, VERIFIER_BAD_REQUEST, header.request_id, nullptr, 0);
+					return false;
+				}
+				if (e - q < static_cast<ptrdiff_t>(sizeof(entry) + entry.size))
+				{
+					complete = false;
+					break;
+				}
+				q += sizeof(entry) + entry.size;
+			}
+			if (!complete)
+			{
+				break;
+			}
+
+			if (v->queued.load() + header.count > v->config.max_queued)
+			{
+				v->busy.fetch_add(1);
+				append_message(conn.get(), VERIFIER_MSG_RESULT, 0, VERIFIER_BUSY, header.request_id, nullptr, 0);
+			}
+			else
+			{
+				verifier_job job;
+				job.conn = conn;
+				job.request_id = header.request_id;
+				job.ring = false;
+				job.data.assign(p, q);
+				job.inputs.resize(header.count);
+				job.lens.resize(header.count);
+				job.heights.resize(header.count);
+
+				const uint8_t* r = job.data.data();
+				for (uint32_t i = 0; i < header.count; ++i)
+				{
+					verifier_entry_header entry;
+					memcpy(&entry, r, sizeof(entry));
+					job.heights[i] = entry.height;
+					job.lens[i] = entry.size;
+					job.inputs[i] = r + sizeof(entry);
+					r += sizeof(entry) + entry.size;
+				}
+				push_job(v, std::move(job), header.count);
+			}
+
+			pos = q - in.data();
+		}
+		else if (header.type == VERIFIER_MSG_SHM_ATTACH)
+		{
+			// Ring fd comes with the header, so it's already received
+			if ((header.count != 0) || conn->in_fds.empty())
+			{
+				v->bad_requests.fetch_add(1);
+				return false;
+			}
+
+			const int fd = conn->in_fds.front();
+			conn->in_fds.pop_front();
+
+			const bool ok = attach_ring(conn.get(), fd);
+			append_message(conn.get(), VERIFIER_MSG_RESULT, 0, ok ? VERIFIER_OK : VERIFIER_BAD_REQUEST, header.request_id, nullptr, 0);
+			pos += sizeof(header);
+		}
+		else if (header.type == VERIFIER_MSG_SHM_SUBMIT)
+		{
+			// Only a doorbell, slot states tell what's submitted
+			pos += sizeof(header);
+			poll_ring(v, conn);
+		}
+		else
+		{
+			v->bad_requests.fetch_add(1);
+			return false;
+		}
+	}
+
+	in.erase(in.begin(), in.begin() + pos);
+
+	// Incomplete message can't grow forever, nothing is received while processing is paused
+	return paused || (in.size() <= MAX_MESSAGE_SIZE);
+}
+
+// recv which also keeps file descriptors passed with SCM_RIGHTS, returns -1 with errno = EBADMSG if there are too many
+static ssize_t recv_with_fds(verifier_conn* conn, uint8_t* buf, size_t size)
+{
+	iovec iov = { buf, size };
+	alignas(cmsghdr) uint8_t control[CMSG_SPACE(sizeof(int) * MAX_PENDING_FDS)];
+
+	msghdr msg = {};
+	msg.msg_iov = &iov;
+	msg.msg_iovlen = 1;
+	msg.msg_control = control;
+	msg.msg_controllen = sizeof(control);
+
+	const ssize_t n = recvmsg(conn->fd, &msg, MSG_CMSG_CLOEXEC);
+	if (n < 0)
+	{
+		return n;
+	}
+
+	for (cmsghdr* c = CMSG_FIRSTHDR(&msg); c; c = CMSG_NXTHDR(&msg, c))
+	{
+		if ((c->cmsg_level == SOL_SOCKET) && (c->cmsg_type == SCM_RIGHTS))
+		{
+			const size_t count = (c->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+			for (size_t i = 0; i < count; ++i)
+			{
+				int fd;
+				memcpy(&fd, CMSG_DATA(c) + i * sizeof(int), sizeof(int));
+				conn->in_fds.push_back(fd);
+			}
+		}
+	}
+
+	if ((msg.msg_flags & MSG_CTRUNC) || (conn->in_fds.size() > MAX_PENDING_FDS))
+	{
+		errno = EBADMSG;
+		return -1;
+	}
+	return n;
+}
+
+static void io_thread(verifier* v)
+{
+	std::map<int, std::shared_ptr<verifier_conn>> conns;
+	std::vector<pollfd> fds;
+	std::vector<uint8_t> buf(VERIFIER_RECV_SIZE);
+
+	while (!v->stop.load())
+	{
+		fds.clear();
+		fds.push_back({ v->listen_fd, POLLIN, 0 });
+		fds.push_back({ v->wake_fd, POLLIN, 0 });
+		for (auto& c : conns)
+		{
+			// Requests are not read while too many answers are unsent
+			short events = 0;
+			{
+				std::lock_guard<std::mutex> lock(c.second->out_mutex);
+				if (c.second->out.size() < MAX_PENDING_OUTPUT)
+				{
+					events |= POLLIN;
+				}
+				if (!c.second->out.empty())
+				{
+					events |= POLLOUT;
+				}
+			}
+			fds.push_back({ c.first, events, 0 });
+		}
+
+		if (poll(fds.data(), fds.size(), 100) < 0)
+		{
+			if (errno == EINTR)
+			{
+				continue;
+			}
+			break;
+		}
+
+		if (fds[1].revents & POLLIN)
+		{
+			uint64_t value;
+			if (read(v->wake_fd, &value, sizeof(value)) < 0)
+			{
+				// Nothing to read, it's fine
+			}
+		}
+
+		if (fds[0].revents & POLLIN)
+		{
+			const int fd = accept4(v->listen_fd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+			if (fd >= 0)
+			{
+				std::shared_ptr<verifier_conn> conn = std::make_shared<verifier_conn>();
+				conn->fd = fd;
+				conns[fd] = conn;
+				v->connections.fetch_add(1);
+			}
+		}
+
+		for (size_t i = 2; i < fds.size(); ++i)
+		{
+			auto it = conns.find(fds[i].fd);
+			if (it == conns.end())
+			{
+				continue;
+			}
+			std::shared_ptr<verifier_conn>& conn = it->second;
+
+			if (fds[i].revents & (POLLIN | POLLHUP | POLLERR))
+			{
+				while (!output_full(conn.get()))
+				{
+					const ssize_t n = recv_with_fds(conn.get(), buf.data(), buf.size());
+					if (n > 0)
+					{
+						conn->in.insert(conn->in.end(), buf.data(), buf.data() + n);
+						if (!process_input(v, conn))
+						{
+							conn->closed = true;
+							break;
+						}
+					}
+					else
+					{
+						if ((n == 0) || ((errno != EAGAIN) && (errno != EWOULDBLOCK) && (errno != EINTR)))
+						{
+							conn->closed = true;
+						}
+						break;
+					}
+				}
+			}
+
+			// Also flushes the answer to a bad request before the connection is closed
+			{
+				std::lock_guard<std::mutex> lock(conn->out_mutex);
+				while (!conn->out.empty())
+				{
+					const ssize_t n = send(conn->fd, conn->out.data(), conn->out.size(), MSG_NOSIGNAL);
+					if (n > 0)
+					{
+						conn->out.erase(conn->out.begin(), conn->out.begin() + n);
+					}
+					else
+					{
+						if ((errno != EAGAIN) && (errno != EWOULDBLOCK) && (errno != EINTR))
+						{
+							conn->closed = true;
+						}
+						break;
+					}
+				}
+			}
+
+			// Requests left in the input buffer when processing was paused
+			if (!conn->closed && !conn->in.empty() && !output_full(conn.get()) && !process_input(v, conn))
+			{
+				conn->closed = true;
+			}
+
+			if (conn->closed)
+			{
+				// Jobs in flight keep the connection (and its ring mapping) alive until they are done
+				shutdown(conn->fd, SHUT_RDWR);
+				conns.erase(it);
+				v->connections.fetch_sub(1);
+			}
+		}
+
+		// Workers freed some room in the queue
+		for (auto& c : conns)
+		{
+			poll_ring(v, c.second);
+		}
+	}
+}
+
+// Removes a socket left by a service which didn't stop cleanly
+// Fails if a running service listens on the path or it's not a socket
+static bool remove_stale_socket(const sockaddr_un& addr)
+{
+	struct stat st;
+	if (lstat(addr.sun_path, &st) != 0)
+	{
+		return errno == ENOENT;
+	}
+	if (!S_ISSOCK(st.st_mode))
+	{
+		return false;
+	}
+
+	// Non-blocking, so a live service with a full backlog doesn't block here (EAGAIN counts as live)
+	const int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+	if (fd < 0)
+	{
+		return false;
+	}
+	const bool stale = (connect(fd, (const sockaddr*) &addr, sizeof(addr)) != 0) && (errno == ECONNREFUSED);
+	close(fd);
+
+	return stale && (unlink(addr.sun_path) == 0);
+}
+
+verifier* verifier_start(const verifier_config& config)
+{
+	if (!config.socket_path || (strlen(config.socket_path) >= sizeof(sockaddr_un::sun_path)) || (config.num_threads == 0))
+	{
+		return nullptr;
+	}
+
+	install_sigbus_handler();
+
+	verifier* v = new verifier();
+	v->config = config;
+	if (v->config.max_queued == 0)
+	{
+		v->config.max_queued = VERIFIER_DEFAULT_MAX_QUEUED;
+	}
+	v->bound = false;
+	v->stop = false;
+	v->queued = 0;
+	v->hashes = 0;
+	v->requests = 0;
+	v->busy = 0;
+	v->bad_requests = 0;
+	v->connections = 0;
+	v->ready_workers = 0;
+
+	v->listen_fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+	v->wake_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	if ((v->listen_fd < 0) || (v->wake_fd < 0))
+	{
+		verifier_stop(v);
+		return nullptr;
+	}
+
+	sockaddr_un addr = {};
+	addr.sun_family = AF_UNIX;
+	strcpy(addr.sun_path, config.socket_path);
+
+	if (!remove_stale_socket(addr) || (bind(v->listen_fd, (const sockaddr*) &addr, sizeof(addr)) != 0))
+	{
+		verifier_stop(v);
+		return nullptr;
+	}
+	v->bound = true;
+
+	if (listen(v->listen_fd, 64) != 0)
+	{
+		verifier_stop(v);
+		return nullptr;
+	}
+
+	// Clients are accepted only after contexts are allocated and kernels are warmed up
+	for (uint32_t i = 0; i < config.num_threads; ++i)
+	{
+		v->workers.emplace_back(worker_thread, v);
+	}
+	while (v->ready_workers.load() < config.num_threads)
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+
+	v->io_thread = std::thread(io_thread, v);
+	return v;
+}
+
+void verifier_stop(verifier* v)
+{
+	if (!v)
+	{
+		return;
+	}
+
+	v->stop = true;
+	if (v->io_thread.joinable())
+	{
+		v->io_thread.join();
+	}
+
+	// Workers finish queued jobs first
+	v->jobs_cond.notify_all();
+	for (std::thread& t : v->workers)
+	{
+		t.join();
+	}
+
+	if (v->listen_fd >= 0)
+	{
+		close(v->listen_fd);
+	}
+	if (v->bound)
+	{
+		unlink(v->config.socket_path);
+	}
+	if (v->wake_fd >= 0)
+	{
+		close(v->wake_fd);
+	}
+	delete v;
+}
+
+verifier_stats verifier_get_stats(verifier* v)
+{
+	verifier_stats stats;
+	stats.hashes = v->hashes.load();
+	stats.requests = v->requests.load();
+	stats.busy = v->busy.load();
+	stats.bad_requests = v->bad_requests.load();
+	stats.queued = v->queued.load();
+	stats.connections = v->connections.load();
+	return stats;
+}
+
+#else
+
+verifier* verifier_start(const verifier_config&)
+{
+	return nullptr;
+}
+
+void verifier_stop(verifier*)
+{
+}
+
+verifier_stats verifier_get_stats(verifier*)
+{
+	return verifier_stats();
+}
+
+#endif
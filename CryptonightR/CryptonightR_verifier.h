@@ -0,0 +1,155 @@
+#pragma once
+
+#include "definitions.h"
+#include <atomic>
+
+// Resident share verification service
+//
+// One process keeps warmed contexts (scratchpads from colored arenas) and kernel caches for recent heights,
+// clients send hash jobs to it over a Unix socket instead of hashing themselves.
+//
+// Socket messages start with verifier_msg_header:
+// - VERIFIER_MSG_HASH: count entries (verifier_entry_header + input) follow, answered with VERIFIER_MSG_RESULT
+//   and count 32-byte hashes in the order of entries. VERIFIER_BUSY is returned right away when too many hashes
+//   are already queued, the client should retry later.
+// - VERIFIER_MSG_SHM_ATTACH: count = 0, file descriptor of a shared memory ring created by the client is passed
+//   with SCM_RIGHTS on the header, only one ring per connection. Rings are never opened by name, so a client
+//   can't attach a ring of another client.
+//   After that the client writes inputs into ring slots, sends VERIFIER_MSG_SHM_SUBMIT as a doorbell and reads
+//   hashes from the same slots after VERIFIER_MSG_SHM_DONE. Inputs and hashes never go through the socket.
+//   When the service is saturated it just stops taking slots from the ring until workers catch up.
+//   Submitted slots can be split into several jobs, each one is answered with its own VERIFIER_MSG_SHM_DONE
+//   (request_id = first slot of the job, count = number of slots).
+//
+// Answers are sent when workers finish jobs, so requests on one connection can be answered out of order.
+// Answers to VERIFIER_MSG_HASH and VERIFIER_MSG_SHM_ATTACH carry the request_id of their request, the client must
+// match them by it. verifier_client_* functions have one request in flight at a time.
+//
+// Linux only, on other systems verifier_start and verifier_client_connect return nullptr.
+
+enum
+{
+	VERIFIER_MAGIC = 0x5256434E,
+	VERIFIER_MAX_INPUT_SIZE = 128,
+
+	// Entries in one VERIFIER_MSG_HASH message, hashes in one worker job
+	VERIFIER_MAX_BATCH = 256,
+
+	// Hashes queued for workers before new jobs get VERIFIER_BUSY
+	VERIFIER_DEFAULT_MAX_QUEUED = 1024,
+};
+
+enum verifier_msg_type
+{
+	VERIFIER_MSG_HASH = 1,
+	VERIFIER_MSG_RESULT,
+	VERIFIER_MSG_SHM_ATTACH,
+	VERIFIER_MSG_SHM_SUBMIT,
+	VERIFIER_MSG_SHM_DONE,
+};
+
+enum verifier_status
+{
+	VERIFIER_OK,
+	VERIFIER_BUSY,
+	VERIFIER_BAD_REQUEST,
+	VERIFIER_ERROR,
+};
+
+struct verifier_msg_header
+{
+	uint32_t magic;
+	uint32_t type;
+	uint32_t count;
+	uint32_t status;
+	uint64_t request_id;
+};
+
+struct verifier_entry_header
+{
+	uint64_t height;
+	uint32_t size;
+	uint32_t reserved;
+};
+
+// Shared memory ring: verifier_ring_header followed by num_slots slots
+// Client: FREE -> SUBMITTED, server: SUBMITTED -> PROCESSING -> DONE, client reads the hash: DONE -> FREE
+enum verifier_slot_state
+{
+	VERIFIER_SLOT_FREE,
+	VERIFIER_SLOT_SUBMITTED,
+	VERIFIER_SLOT_PROCESSING,
+	VERIFIER_SLOT_DONE,
+};
+
+struct verifier_ring_header
+{
+	uint32_t magic;
+	uint32_t num_slots;
+	uint64_t reserved[7];
+};
+
+struct verifier_ring_slot
+{
+	std::atomic<uint32_t> state;
+	uint32_t size;
+	uint64_t height;
+	uint8_t input[VERIFIER_MAX_INPUT_SIZE];
+	uint8_t hash[32];
+	uint32_t status;
+	uint8_t padding[12];
+};
+
+struct verifier_config
+{
+	const char* socket_path;
+
+	// Worker threads, every worker has its own batch (CryptonightR_hash.h) on its NUMA node
+	uint32_t num_threads;
+
+	// Hashes per main loop call, 0 = cn_r_batch_get_best_ways()
+	uint32_t ways;
+
+	uint32_t max_queued;
+
+	// Kernels for this height (and the next heights in background) are compiled before accepting clients
+	uint64_t warm_height;
+	bool warm;
+};
+
+struct verifier_stats
+{
+	uint64_t hashes;
+	uint64_t requests;
+	uint64_t busy;
+	uint64_t bad_requests;
+	uint32_t queued;
+	uint32_t connections;
+};
+
+struct verifier;
+
+// Returns nullptr if another service listens on socket_path or it exists and is not a socket, stale sockets are removed
+verifier* verifier_start(const verifier_config& config);
+void verifier_stop(verifier* v);
+verifier_stats verifier_get_stats(verifier* v);
+
+struct verifier_client;
+
+verifier_client* verifier_client_connect(const char* socket_path);
+void verifier_client_close(verifier_client* client);
+
+// Hashes count inputs through the socket, waits for the answer
+verifier_status verifier_client_hash(verifier_client* client, const void* const* inputs, const size_t* lens, const uint64_t* heights, uint8_t* hashes, uint32_t count);
+
+// Creates a shared memory ring and attaches it to the service
+bool verifier_client_attach_ring(verifier_client* client, uint32_t num_slots);
+
+// Same as verifier_client_hash, but inputs and hashes go through the ring
+verifier_status verifier_client_ring_hash(verifier_client* client, const void* const* inputs, const size_t* lens, const uint64_t* heights, uint8_t* hashes, uint32_t count);
+
+// Command line modes:
+// --verifier <socket path> [threads] [ways] [warm height]
+// --verifier-load <socket path> [clients] [seconds] [batch size] [ring]
+int verifier_main(int argc, char** argv);
+int verifier_load_main(int argc, char** argv);
@@ -0,0 +1,526 @@
+#include "CryptonightR_verifier.h"
+#include "CryptonightR_hash.h"
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <thread>
+#include <vector>
+
+#ifndef _WIN32
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <errno.h>
+#endif
+
+#ifndef _WIN32
+
+struct verifier_client
+{
+	int fd;
+	uint64_t next_request_id;
+
+	verifier_ring_header* ring;
+	size_t ring_size;
+
+	// Next slot to write, the service takes slots in the same order
+	uint32_t ring_head;
+};
+
+static bool send_all(int fd, const void* data, size_t size)
+{
+	const uint8_t* p = (const uint8_t*) data;
+	while (size > 0)
+	{
+		const ssize_t n = send(fd, p, size, MSG_NOSIGNAL);
+		if (n <= 0)
+		{
+			if ((n < 0) && (errno == EINTR))
+			{
+				continue;
+			}
+			return false;
+		}
+		p += n;
+		size -= n;
+	}
+	return true;
+}
+
+// First byte carries passed_fd (SCM_RIGHTS), the rest is sent like send_all
+static bool send_with_fd(int fd, const void* data, size_t size, int passed_fd)
+{
+	iovec iov = { const_cast<void*>(data), size };
+	alignas(cmsghdr) uint8_t control[CMSG_SPACE(sizeof(int))] = {};
+
+	msghdr msg = {};
+	msg.msg_iov = &iov;
+	msg.msg_iovlen = 1;
+	msg.msg_control = control;
+	msg.msg_controllen = sizeof(control);
+
+	cmsghdr* c = CMSG_FIRSTHDR(&msg);
+	c->cmsg_level = SOL_SOCKET;
+	c->cmsg_type = SCM_RIGHTS;
+	c->cmsg_len = CMSG_LEN(sizeof(int));
+	memcpy(CMSG_DATA(c), &passed_fd, sizeof(int));
+
+	ssize_t n;
+	do
+	{
+		n = sendmsg(fd, &msg, MSG_NOSIGNAL);
+	} while ((n < 0) && (errno == EINTR));
+
+	if (n <= 0)
+	{
+		return false;
+	}
+	return send_all(fd, (const uint8_t*) data + n, size - n);
+}
+
+static bool recv_all(int fd, void* data, size_t size)
+{
+	uint8_t* p = (uint8_t*) data;
+	while (size > 0)
+	{
+		const ssize_t n = recv(fd, p, size, 0);
+		if (n <= 0)
+		{
+			if ((n < 0) && (errno == EINTR))
+			{
+				continue;
+			}
+			return false;
+		}
+		p += n;
+		size -= n;
+	}
+	return true;
+}
+
+static bool recv_header(verifier_client* client, verifier_msg_header& header)
+{
+	return recv_all(client->fd, &header, sizeof(header)) && (header.magic == VERIFIER_MAGIC);
+}
+
+verifier_client* verifier_client_connect(const char* socket_path)
+{
+	if (!socket_path || (strlen(socket_path) >= sizeof(sockaddr_un::sun_path)))
+	{
+		return nullptr;
+	}
+
+	const int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+	if (fd < 0)
+	{
+		return nullptr;
+	}
+
+	sockaddr_un addr = {};
+	addr.sun_family = AF_UNIX;
+	strcpy(addr.sun_path, socket_path);
+	if (connect(fd, (const sockaddr*) &addr, sizeof(addr)) != 0)
+	{
+		close(fd);
+		return nullptr;
+	}
+
+	verifier_client* client = new verifier_client();
+	client->fd = fd;
+	client->next_request_id = 0;
+	client->ring = nullptr;
+	client->ring_size = 0;
+	client->ring_head = 0;
+	return client;
+}
+
+void verifier_client_close(verifier_client* client)
+{
+	if (!client)
+	{
+		return;
+	}
+
+	close(client->fd);
+	if (client->ring)
+	{
+		munmap(client->ring, client->ring_size);
+	}
+	delete client;
+}
+
+verifier_status verifier_client_hash(verifier_client* client, const void* const* inputs, const size_t* lens, const uint64_t* heights, uint8_t* hashes, uint32_t count)
+{
+	if ((count == 0) || (count > VERIFIER_MAX_BATCH))
+	{
+		return VERIFIER_BAD_REQUEST;
+	}
+
+	const uint64_t request_id = client->next_request_id++;
+	const verifier_msg_header header = { VERIFIER_MAGIC, VERIFIER_MSG_HASH, count, VERIFIER_OK, request_id };
+
+	std::vector<uint8_t> msg((const uint8_t*) &header, (const uint8_t*) (&header + 1));
+	for (uint32_t i = 0; i < count; ++i)
+	{
+		if (lens[i] > VERIFIER_MAX_INPUT_SIZE)
+		{
+			return VERIFIER_BAD_REQUEST;
+		}
+
+		const verifier_entry_header entry = { heights[i], static_cast<uint32_t>(lens[i]), 0 };
+		msg.insert(msg.end(), (const uint8_t*) &entry, (const uint8_t*) (&entry + 1));
+		msg.insert(msg.end(), (const uint8_t*) inputs[i], (const uint8_t*) inputs[i] + lens[i]);
+	}
+
+	if (!send_all(client->fd, msg.data(), msg.size()))
+	{
+		return VERIFIER_ERROR;
+	}
+
+	// Answers can come out of order and are matched by request_id, this is the only request in flight, so anything else is an error
+	verifier_msg_header result;
+	if (!recv_header(client, result) || (result.type != VERIFIER_MSG_RESULT) || (result.request_id != request_id))
+	{
+		return VERIFIER_ERROR;
+	}
+
+	if (result.status != VERIFIER_OK)
+	{
+		return static_cast<verifier_status>(result.status);
+	}
+
+	if ((result.count != count) || !recv_all(client->fd, hashes, count * 32))
+	{
+		return VERIFIER_ERROR;
+	}
+
+	return VERIFIER_OK;
+}
+
+bool verifier_client_attach_ring(verifier_client* client, uint32_t num_slots)
+{
+	if (client->ring || (num_slots == 0))
+	{
+		return false;
+	}
+
+	// Anonymous, only the service gets it through the socket
+	const int fd = memfd_create("cnr_verifier_ring", MFD_CLOEXEC);
+	if (fd < 0)
+	{
+		return false;
+	}
+
+	const size_t size = sizeof(verifier_ring_header) + static_cast<size_t>(num_slots) * sizeof(verifier_ring_slot);
+	void* p = MAP_FAILED;
+	if (ftruncate(fd, size) == 0)
+	{
+		p = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	}
+
+	if (p == MAP_FAILED)
+	{
+		close(fd);
+		return false;
+	}
+
+	// ftruncate fills it with zeroes, so all slots are already VERIFIER_SLOT_FREE
+	verifier_ring_header* ring = (verifier_ring_header*) p;
+	ring->magic = VERIFIER_MAGIC;
+	ring->num_slots = num_slots;
+
+	const uint64_t request_id = client->next_request_id++;
+	const verifier_msg_header header = { VERIFIER_MAGIC, VERIFIER_MSG_SHM_ATTACH, 0, VERIFIER_OK, request_id };
+
+	verifier_msg_header result;
+	const bool ok = send_with_fd(client->fd, &header, sizeof(header), fd) &&
+		recv_header(client, result) && (result.type == VERIFIER_MSG_RESULT) && (result.status == VERIFIER_OK);
+
+	// Both sides have it mapped now (or never will)
+	close(fd);
+
+	if (!ok)
+	{
+		munmap(p, size);
+		return false;
+	}
+
+	client->ring = ring;
+	client->ring_size = size;
+	client->ring_head = 0;
+	return true;
+}
+
+verifier_status verifier_client_ring_hash(verifier_client* client, const void* const* inputs, const size_t* lens, const uint64_t* heights, uint8_t* hashes, uint32_t count)
+{
+	if (!client->ring || (count == 0) || (count > client->ring->num_slots))
+	{
+		return VERIFIER_BAD_REQUEST;
+	}
+
+	const uint32_t num_slots = client->ring->num_slots;
+	verifier_ring_slot* slots = reinterpret_cast<verifier_ring_slot*>(client->ring + 1);
+	const uint32_t first_slot = client->ring_head;
+
+	for (uint32_t i = 0; i < count; ++i)
+	{
+		if (lens[i] > VERIFIER_MAX_INPUT_SIZE)
+		{
+			return VERIFIER_BAD_REQUEST;
+		}
+	}
+
+	for (uint32_t i = 0; i < count; ++i)
+	{
+		// All previous calls waited for their slots, so they're free
+		verifier_ring_slot& slot = slots[(first_slot + i) % num_slots];
+		slot.size = static_cast<uint32_t>(lens[i]);
+		slot.height = heights[i];
+		memcpy(slot.input, inputs[i], lens[i]);
+		slot.state.store(VERIFIER_SLOT_SUBMITTED, std::memory_order_release);
+	}
+	client->ring_head = (first_slot + count) % num_slots;
+
+	const verifier_msg_header doorbell = { VERIFIER_MAGIC, VERIFIER_MSG_SHM_SUBMIT, count, VERIFIER_OK, client->next_request_id++ };
+	if (!send_all(client->fd, &doorbell, sizeof(doorbell)))
+	{
+		return VERIFIER_ERROR;
+	}
+
+	// Service can split submitted slots into several jobs, every job sends its own VERIFIER_MSG_SHM_DONE in any order
+	uint32_t done = 0;
+	while (done < count)
+	{
+		verifier_msg_header result;
+		if (!recv_header(client, result) || (result.type != VERIFIER_MSG_SHM_DONE))
+		{
+			return VERIFIER_ERROR;
+		}
+		done += result.count;
+	}
+
+	verifier_status status = VERIFIER_OK;
+	for (uint32_t i = 0; i < count; ++i)
+	{
+		verifier_ring_slot& slot = slots[(first_slot + i) % num_slots];
+		if (slot.state.load(std::memory_order_acquire) != VERIFIER_SLOT_DONE)
+		{
+			return VERIFIER_ERROR;
+		}
+		if (slot.status != VERIFIER_OK)
+		{
+			status = static_cast<verifier_status>(slot.status);
+		}
+		memcpy(hashes + i * 32, slot.hash, 32);
+		slot.state.store(VERIFIER_SLOT_FREE, std::memory_order_relaxed);
+	}
+
+	return status;
+}
+
+int verifier_main(int argc, char** argv)
+{
+	if (argc < 3)
+	{
+		std::cerr << "Usage: " << argv[0] << " --verifier <socket path> [threads] [ways] [warm height]" << std::endl;
+		return 1;
+	}
+
+	verifier_config config = {};
+	config.socket_path = argv[2];
+	config.num_threads = (argc > 3) ? static_cast<uint32_t>(atoi(argv[3])) : std::max(std::thread::hardware_concurrency(), 1U);
+	config.ways = (argc > 4) ? static_cast<uint32_t>(atoi(argv[4])) : 0;
+	config.max_queued = VERIFIER_DEFAULT_MAX_QUEUED;
+	config.warm = (argc > 5);
+	config.warm_height = config.warm ? strtoull(argv[5], nullptr, 10) : 0;
+
+	// Signals are handled by sigwait below, all threads started from here inherit the mask
+	sigset_t signals;
+	sigemptyset(&signals);
+	sigaddset(&signals, SIGINT);
+	sigaddset(&signals, SIGTERM);
+	sigaddset(&signals, SIGALRM);
+	pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+
+	verifier* v = verifier_start(config);
+	if (!v)
+	{
+		std::cerr << "Failed to start verifier on " << config.socket_path << " (another verifier is running or the path is not a socket)" << std::endl;
+		return 1;
+	}
+
+	std::cout << "Verifier listening on " << config.socket_path << ", " << config.num_threads << " threads" << std::endl;
+
+	uint64_t prev_hashes = 0;
+	for (;;)
+	{
+		alarm(10);
+		int sig = 0;
+		sigwait(&signals, &sig);
+		if (sig != SIGALRM)
+		{
+			break;
+		}
+
+		const verifier_stats stats = verifier_get_stats(v);
+		std::cout << (stats.hashes - prev_hashes) / 10.0 << " H/s, " << stats.hashes << " hashes, " << stats.requests << " requests, " <<
+			stats.busy << " busy, " << stats.bad_requests << " bad, " << stats.queued << " queued, " << stats.connections << " connections" << std::endl;
+		prev_hashes = stats.hashes;
+	}
+
+	std::cout << "Stopping verifier" << std::endl;
+	verifier_stop(v);
+	return 0;
+}
+
+int verifier_load_main(int argc, char** argv)
+{
+	if (argc < 3)
+	{
+		std::cerr << "Usage: " << argv[0] << " --verifier-load <socket path> [clients] [seconds] [batch size] [ring]" << std::endl;
+		return 1;
+	}
+
+	const char* socket_path = argv[2];
+	const uint32_t num_clients = (argc > 3) ? static_cast<uint32_t>(atoi(argv[3])) : 4;
+	const double seconds = (argc > 4) ? atof(argv[4]) : 10.0;
+	const uint32_t batch_size = (argc > 5) ? std::min(std::max(atoi(argv[5]), 1), static_cast<int>(VERIFIER_MAX_BATCH)) : 16;
+	const bool use_ring = (argc > 6) && (atoi(argv[6]) != 0);
+
+	enum { HEIGHT = 1806260 };
+
+	std::atomic<uint64_t> total_hashes(0);
+	std::atomic<uint64_t> total_busy(0);
+	std::atomic<uint32_t> failed(0);
+	std::atomic<uint32_t> mismatches(0);
+
+	const auto start_time = std::chrono::steady_clock::now();
+	const auto end_time = start_time + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(seconds));
+
+	std::vector<std::thread> clients;
+	for (uint32_t t = 0; t < num_clients; ++t)
+	{
+		clients.emplace_back([&, t]()
+		{
+			verifier_client* client = verifier_client_connect(socket_path);
+			if (!client || (use_ring && !verifier_client_attach_ring(client, batch_size)))
+			{
+				verifier_client_close(client);
+				failed.fetch_add(1);
+				return;
+			}
+
+			// Share blobs are 76 bytes
+			std::mt19937_64 rnd(t);
+			std::vector<uint8_t> blobs(batch_size * 76);
+			std::vector<const void*> inputs(batch_size);
+			std::vector<size_t> lens(batch_size, 76);
+			std::vector<uint64_t> heights(batch_size, HEIGHT);
+			std::vector<uint8_t> hashes(batch_size * 32);
+			for (uint32_t i = 0; i < batch_size; ++i)
+			{
+				inputs[i] = blobs.data() + i * 76;
+			}
+
+			bool checked = false;
+			while (std::chrono::steady_clock::now() < end_time)
+			{
+				for (uint8_t& b : blobs)
+				{
+					b = static_cast<uint8_t>(rnd());
+				}
+
+				const verifier_status status = use_ring ?
+					verifier_client_ring_hash(client, inputs.data(), lens.data(), heights.data(), hashes.data(), batch_size) :
+					verifier_client_hash(client, inputs.data(), lens.data(), heights.data(), hashes.data(), batch_size);
+
+				if (status == VERIFIER_BUSY)
+				{
+					total_busy.fetch_add(1);
+					std::this_thread::sleep_for(std::chrono::milliseconds(1));
+					continue;
+				}
+				if (status != VERIFIER_OK)
+				{
+					failed.fetch_add(1);
+					break;
+				}
+				total_hashes.fetch_add(batch_size);
+
+				// One result per client is checked against local hashing
+				if (!checked)
+				{
+					uint8_t hash[32];
+					if (!cn_r_hash(inputs[0], lens[0], HEIGHT, hash) || (memcmp(hash, hashes.data(), 32) != 0))
+					{
+						mismatches.fetch_add(1);
+					}
+					checked = true;
+				}
+			}
+
+			verifier_client_close(client);
+		});
+	}
+
+	for (std::thread& t : clients)
+	{
+		t.join();
+	}
+
+	const double dt = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+	std::cout << num_clients << " clients, batch size " << batch_size << (use_ring ? ", shared memory ring" : ", socket") << ": " <<
+		total_hashes.load() / dt << " H/s, " << total_busy.load() << " busy replies, " << failed.load() << " failed clients, " <<
+		mismatches.load() << " mismatches" << std::endl;
+
+	return ((failed.load() == 0) && (mismatches.load() == 0)) ? 0 : 1;
+}
+
+#else
+
+verifier_client* verifier_client_connect(const char*)
+{
+	return nullptr;
+}
+
+void verifier_client_close(verifier_client*)
+{
+}
+
+verifier_status verifier_client_hash(verifier_client*, const void* const*, const size_t*, const uint64_t*, uint8_t*, uint32_t)
+{
+	return VERIFIER_ERROR;
+}
+
+bool verifier_client_attach_ring(verifier_client*, uint32_t)
+{
+	return false;
+}
+
+verifier_status verifier_client_ring_hash(verifier_client*, const void* const*, const size_t*, const uint64_t*, uint8_t*, uint32_t)
+{
+	return VERIFIER_ERROR;
+}
+
+int verifier_main(int, char**)
+{
+	std::cerr << "Verifier is not supported on this system" << std::endl;
+	return 1;
+}
+
+int verifier_load_main(int, char**)
+{
+	std::cerr << "Verifier is not supported on this system" << std::endl;
+	return 1;
+}
+
+#endif
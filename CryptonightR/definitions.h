@@ -4,6 +4,9 @@
 #include <memory.h>
 
 extern "C" void hash_extra_blake(const void *data, size_t length, char *hash);
+extern "C" void hash_extra_groestl(const void *data, size_t length, char *hash);
+extern "C" void hash_extra_jh(const void *data, size_t length, char *hash);
+extern "C" void hash_extra_skein(const void *data, size_t length, char *hash);
 
 #include "../slow_hash_test/variant4_random_math.h"
 
@@ -25,15 +28,23 @@ typedef struct {
 #define FORCEINLINE __attribute__((always_inline)) inline
 #define NOINLINE __attribute__ ((noinline))
 #define UNREACHABLE __builtin_unreachable()
+#define ASM_ABI __attribute__((ms_abi))
 #else
 #define FORCEINLINE __forceinline
 #define NOINLINE __declspec(noinline)
 #define UNREACHABLE __assume(false)
+#define ASM_ABI
 #endif
 
+// ASM and generated code use Windows x64 calling convention on all platforms
+typedef void(ASM_ABI *mainloop_func)(cryptonight_ctx*);
+typedef void(ASM_ABI *mainloop_double_func)(cryptonight_ctx*, cryptonight_ctx*);
+typedef void(ASM_ABI *mainloop_multi_func)(cryptonight_ctx**);
+
 #ifdef __GNUC__
 
 #include <x86intrin.h>
+#include <cpuid.h>
 
 static inline uint64_t __umul128(uint64_t a, uint64_t b, uint64_t* hi)
 {
@@ -42,6 +53,10 @@ static inline uint64_t __umul128(uint64_t a, uint64_t b, uint64_t* hi)
 	return (uint64_t)r;
 }
 
+// 64-bit random math
+#define _rotr64 __rorq
+#define _rotl64 __rolq
+
 #else
 
 #include <intrin.h>
@@ -49,5 +64,5 @@ static inline uint64_t __umul128(uint64_t a, uint64_t b, uint64_t* hi)
 
 #endif // __GNUC__
 
-// If you changed RND_SEED, set it to 1 to update random_math.inc, random_math.inl, random_math.bin
+// If you changed RND_SEED, set it to 1 to update random_math.inc, random_math.inl, random_math_double.inl, random_math_quad.inl, random_math.bin
 #define DUMP_SOURCE_CODE 0
@@ -0,0 +1,89 @@
+// Auto-generated file, do not edit
+
+FORCEINLINE void random_math_quad(__m256i& r0, __m256i& r1, __m256i& r2, __m256i& r3, const __m256i r4, const __m256i r5, const __m256i r6, const __m256i r7)
+{
+	{
+		const __m256i c = _mm256_and_si256(r0, _mm256_set1_epi32(31));
+		r0 = _mm256_or_si256(_mm256_sllv_epi32(r0, c), _mm256_srlv_epi32(r0, _mm256_sub_epi32(_mm256_set1_epi32(32), c)));
+	}
+	r1 = _mm256_sub_epi32(r1, r5);	
+	r0 = _mm256_xor_si256(r0, r2);	
+	{
+		const __m256i c = _mm256_and_si256(r6, _mm256_set1_epi32(31));
+		r1 = _mm256_or_si256(_mm256_srlv_epi32(r1, c), _mm256_sllv_epi32(r1, _mm256_sub_epi32(_mm256_set1_epi32(32), c)));
+	}
+	r3 = _mm256_sub_epi32(r3, r4);	
+	r0 = _mm256_mul_epu32(r0, r6);	
+	r1 = _mm256_xor_si256(r1, r3);	
+	{
+		const __m256i c = _mm256_and_si256(r3, _mm256_set1_epi32(31));
+		r1 = _mm256_or_si256(_mm256_srlv_epi32(r1, c), _mm256_sllv_epi32(r1, _mm256_sub_epi32(_mm256_set1_epi32(32), c)));
+	}
+	r2 = _mm256_add_epi32(_mm256_add_epi32(r2, r7), _mm256_set1_epi64x(3217595456U));	
+	r0 = _mm256_xor_si256(r0, r7);	
+	r1 = _mm256_mul_epu32(r1, r3);	
+	r0 = _mm256_xor_si256(r0, r1);	
+	r1 = _mm256_xor_si256(r1, r5);	
+	r1 = _mm256_sub_epi32(r1, r7);	
+	r0 = _mm256_mul_epu32(r0, r3);	
+	r1 = _mm256_xor_si256(r1, r5);	
+	r1 = _mm256_mul_epu32(r1, r2);	
+	r0 = _mm256_mul_epu32(r0, r6);	
+	{
+		const __m256i c = _mm256_and_si256(r2, _mm256_set1_epi32(31));
+		r3 = _mm256_or_si256(_mm256_srlv_epi32(r3, c), _mm256_sllv_epi32(r3, _mm256_sub_epi32(_mm256_set1_epi32(32), c)));
+	}
+	r0 = _mm256_mul_epu32(r0, r0);	
+	r1 = _mm256_mul_epu32(r1, r3);	
+	r3 = _mm256_sub_epi32(r3, r4);	
+	r3 = _mm256_add_epi32(_mm256_add_epi32(r3, r5), _mm256_set1_epi64x(2904803405U));	
+	r0 = _mm256_xor_si256(r0, r2);	
+	r2 = _mm256_mul_epu32(r2, r5);	
+	r3 = _mm256_sub_epi32(r3, r4);	
+	r2 = _mm256_add_epi32(_mm256_add_epi32(r2, r5), _mm256_set1_epi64x(739462159U));	
+	r0 = _mm256_xor_si256(r0, r2);	
+	r0 = _mm256_mul_epu32(r0, r7);	
+	r3 = _mm256_xor_si256(r3, r7);	
+	r2 = _mm256_mul_epu32(r2, r6);	
+	r2 = _mm256_add_epi32(_mm256_add_epi32(r2, r1), _mm256_set1_epi64x(4139483296U));	
+	r1 = _mm256_sub_epi32(r1, r2);	
+	r2 = _mm256_sub_epi32(r2, r6);	
+	r2 = _mm256_mul_epu32(r2, r6);	
+	r1 = _mm256_mul_epu32(r1, r6);	
+	r1 = _mm256_mul_epu32(r1, r2);	
+	r3 = _mm256_mul_epu32(r3, r4);	
+	r2 = _mm256_mul_epu32(r2, r0);	
+	r2 = _mm256_mul_epu32(r2, r4);	
+	r3 = _mm256_xor_si256(r3, r4);	
+	r2 = _mm256_add_epi32(_mm256_add_epi32(r2, r7), _mm256_set1_epi64x(2045579078U));	
+	r0 = _mm256_mul_epu32(r0, r7);	
+	r1 = _mm256_mul_epu32(r1, r7);	
+	r1 = _mm256_xor_si256(r1, r6);	
+	r1 = _mm256_sub_epi32(r1, r3);	
+	r0 = _mm256_mul_epu32(r0, r7);	
+	r1 = _mm256_mul_epu32(r1, r2);	
+	r0 = _mm256_mul_epu32(r0, r6);	
+	r0 = _mm256_mul_epu32(r0, r3);	
+	r3 = _mm256_mul_epu32(r3, r5);	
+	r2 = _mm256_mul_epu32(r2, r4);	
+	r0 = _mm256_xor_si256(r0, r7);	
+	r1 = _mm256_mul_epu32(r1, r2);	
+	r0 = _mm256_mul_epu32(r0, r1);	
+	r3 = _mm256_xor_si256(r3, r7);	
+	r2 = _mm256_xor_si256(r2, r6);	
+	r2 = _mm256_mul_epu32(r2, r6);	
+	{
+		const __m256i c = _mm256_and_si256(r4, _mm256_set1_epi32(31));
+		r2 = _mm256_or_si256(_mm256_sllv_epi32(r2, c), _mm256_srlv_epi32(r2, _mm256_sub_epi32(_mm256_set1_epi32(32), c)));
+	}
+	{
+		const __m256i c = _mm256_and_si256(r4, _mm256_set1_epi32(31));
+		r1 = _mm256_or_si256(_mm256_sllv_epi32(r1, c), _mm256_srlv_epi32(r1, _mm256_sub_epi32(_mm256_set1_epi32(32), c)));
+	}
+	{
+		const __m256i c = _mm256_and_si256(r0, _mm256_set1_epi32(31));
+		r3 = _mm256_or_si256(_mm256_srlv_epi32(r3, c), _mm256_sllv_epi32(r3, _mm256_sub_epi32(_mm256_set1_epi32(32), c)));
+	}
+	r1 = _mm256_mul_epu32(r1, r3);	
+	r2 = _mm256_mul_epu32(r2, r1);	
+}